@@ -19,6 +19,8 @@ function (get_base_command _command
     # Append command based on master type
     if (master MATCHES "Serial")
         string (APPEND command "${executable} serial ")
+    elseif (master MATCHES "Local")
+        string (APPEND command "${executable} local ")
     elseif (master MATCHES "MPI")
         string (APPEND command "${MPIEXEC_EXECUTABLE} \
         ${MPIEXEC_NUMPROC_FLAG} \
@@ -39,6 +41,8 @@ function (get_base_command _command
     # Append command based on simulator type
     if (simulator MATCHES "MPI")
         string (APPEND command "--mpi-simulator ")
+    elseif (simulator MATCHES "Persistent")
+        string (APPEND command "--persistent-simulator ")
     endif ()
 
     # Append command based on force_host_spawn
@@ -46,6 +50,41 @@ function (get_base_command _command
         string (APPEND command "--force-host-spawn ")
     endif ()
 
+    # Append command based on eager_spawn
+    if (eager_spawn)
+        string (APPEND command "--eager-spawn ")
+    endif ()
+
+    # Append command based on slots_per_rank
+    if (master MATCHES "MPI" AND slots_per_rank)
+        string (APPEND command "--slots-per-rank=${slots_per_rank} ")
+    endif ()
+
+    # Append command based on worker_procs
+    if (master MATCHES "MPI" AND worker_procs)
+        string (APPEND command "--worker-procs=${worker_procs} ")
+    endif ()
+
+    # Append command based on max_batch_size
+    if (master MATCHES "MPI" AND max_batch_size)
+        string (APPEND command "--max-batch-size=${max_batch_size} ")
+    endif ()
+
+    # Append command based on prefetch
+    if (master MATCHES "MPI" AND prefetch)
+        string (APPEND command "--prefetch=${prefetch} ")
+    endif ()
+
+    # Append command based on helper_jobs
+    if (controller MATCHES "SMC" AND helper_jobs)
+        string (APPEND command "--helper-jobs=${helper_jobs} ")
+    endif ()
+
+    # Append command based on batch_helpers
+    if (controller MATCHES "Rejection|SMC" AND batch_helpers)
+        string (APPEND command "--batch-helpers ")
+    endif ()
+
     # Append command with --verbosity off if test type is match
     string (APPEND command "--verbosity=off ")
 
@@ -119,6 +158,9 @@ function (get_sweep_options _options
             string (APPEND options
                 "${PROJECT_BINARY_DIR}/tests/mpi-simulator/mpi-simulator ")
         endif ()
+    elseif (simulator MATCHES "Persistent")
+        string (APPEND options
+            "${PROJECT_BINARY_DIR}/tests/persistent-simulator/persistent-simulator ")
     endif ()
 
     string (APPEND options "'' ${return_code}\"")
@@ -212,7 +254,11 @@ function (get_rejection_options _options
     string (APPEND options "--parameter-names=\"${parameter_names}\" ")
 
     # Append options with prior sampler
-    string (APPEND options "--prior-sampler=\"echo ${sampled_parameter}\" ")
+    if (batch_helpers)
+        string (APPEND options "--prior-sampler=\"bash -c 'read n && yes ${sampled_parameter} | head -n \$n'\" ")
+    else ()
+        string (APPEND options "--prior-sampler=\"echo ${sampled_parameter}\" ")
+    endif ()
 
     # Append options with number of parameters
     string (APPEND options "--number-accept=${number_of_parameters} ")
@@ -234,6 +280,9 @@ function (get_rejection_options _options
             string (APPEND options
                 "${PROJECT_BINARY_DIR}/tests/mpi-simulator/mpi-simulator ")
         endif ()
+    elseif (simulator MATCHES "Persistent")
+        string (APPEND options
+            "${PROJECT_BINARY_DIR}/tests/persistent-simulator/persistent-simulator ")
     endif ()
 
     string (APPEND options "1 ${return_code}\"")
@@ -340,16 +389,27 @@ function (get_smc_options _options
     string (APPEND options "--parameter-names=\"${parameter_names}\" ")
 
     # Append options with prior sampler
-    string (APPEND options "--prior-sampler=\"echo ${sampled_parameter}\" ")
-
-    # Append options with perturber
-    string (APPEND options "--perturber=\"bash -c 'cat > /dev/null && echo 1'\" ")
+    if (batch_helpers)
+        string (APPEND options "--prior-sampler=\"bash -c 'read n && yes ${sampled_parameter} | head -n \$n'\" ")
+    else ()
+        string (APPEND options "--prior-sampler=\"echo ${sampled_parameter}\" ")
+    endif ()
 
-    # Append options with prior pdf
-    string (APPEND options "--prior-pdf=\"bash -c 'cat > /dev/null && echo 1'\" ")
+    # Append options with perturber and prior pdf
+    if (batch_helpers)
+        string (APPEND options "--perturber=\"bash -c 'read t && sed s/.*/1/'\" ")
+        string (APPEND options "--prior-pdf=\"sed s/.*/1/\" ")
+    else ()
+        string (APPEND options "--perturber=\"bash -c 'cat > /dev/null && echo 1'\" ")
+        string (APPEND options "--prior-pdf=\"bash -c 'cat > /dev/null && echo 1'\" ")
+    endif ()
 
     # Append options with perturbation pdf
-    string (APPEND options "--perturbation-pdf=\"bash -c 'read t && read new_p && cat'\" ")
+    if (batch_helpers)
+        string (APPEND options "--perturbation-pdf=\"${PROJECT_BINARY_DIR}/tests/standard-simulator/batch-perturbation-pdf.sh\" ")
+    else ()
+        string (APPEND options "--perturbation-pdf=\"bash -c 'read t && read new_p && cat'\" ")
+    endif ()
 
     # Append options with number of parameters
     string (APPEND options "--population-size=${number_of_parameters} ")
@@ -371,6 +431,9 @@ function (get_smc_options _options
             string (APPEND options
                 "${PROJECT_BINARY_DIR}/tests/mpi-simulator/mpi-simulator ")
         endif ()
+    elseif (simulator MATCHES "Persistent")
+        string (APPEND options
+            "${PROJECT_BINARY_DIR}/tests/persistent-simulator/persistent-simulator ")
     endif ()
 
     string (APPEND options "1 ${return_code}\"")
@@ -21,6 +21,18 @@
  * communicate with Pakman and execute the simulator function to perform the
  * received simulation tasks.
  *
+ * If Pakman spawns the MPI Worker as a group of several MPI processes (see
+ * the option `--worker-procs` of the MPI master), run() must be called by
+ * all processes of the group.  The process with rank 0 then communicates
+ * with Pakman and broadcasts every input string to the other processes, so
+ * that the simulator function is called collectively by all processes.  Only
+ * the output string of the process with rank 0 is sent to Pakman, along with
+ * the largest error code returned by any of the processes.
+ *
+ * Long simulations can call shouldCancel() at regular intervals to find out
+ * whether Pakman has cancelled the simulation, in which case the simulation
+ * can return early.
+ *
  * Note that `MPI_Init()` should be called before calling run().  Also, after
  * run() returns, `MPI_Finalize()` should be called.
  *
@@ -60,6 +72,24 @@ class PakmanMPIWorker
          */
         int run(int argc, char*argv[]);
 
+        /** Check whether Pakman has cancelled the ongoing simulation.
+         *
+         * Pakman cancels simulations whose results are no longer needed, for
+         * example when an ABC SMC generation has finished.  Since MPI Workers
+         * cannot be terminated with system signals, long simulations should
+         * call this function at regular intervals from within the simulator
+         * function, and return as soon as it returns true.  The output string
+         * and error code of a cancelled simulation are discarded by Pakman.
+         *
+         * Calling this function is optional; if it is never called, cancelled
+         * simulations simply run to completion.  If the MPI Worker consists
+         * of several MPI processes, this function must be called
+         * collectively by all of them.
+         *
+         * @return whether the ongoing simulation has been cancelled.
+         */
+        static bool shouldCancel();
+
         /** Exit code indicating Worker ran successfully. */
         static constexpr int PAKMAN_EXIT_SUCCESS = 0;
 
@@ -75,7 +105,7 @@ class PakmanMPIWorker
         std::string receiveMessage();
 
         // Receive signal from Pakman Manager
-        int receiveSignal();
+        static int receiveSignal(MPI_Comm parent_comm);
 
         // Send message to Pakman Manager
         void sendMessage(const std::string& message_string);
@@ -83,9 +113,21 @@ class PakmanMPIWorker
         // Send error code to Pakman Manager
         void sendErrorCode(int error_code);
 
+        // Broadcast string from root to the processes of this MPI Worker
+        static void broadcastString(std::string& str);
+
         // Parent communicator
         MPI_Comm m_parent_comm = MPI_COMM_NULL;
 
+        // Communicator of the processes of this MPI Worker, and rank and
+        // size within this communicator
+        static MPI_Comm s_peer_comm;
+        static int s_peer_rank;
+        static int s_peer_size;
+
+        // Flag indicating that the ongoing simulation has been cancelled
+        static bool s_cancel_requested;
+
         // Simulator function
         std::function<int(int argc, char** argv, const std::string&
                 input_string, std::string& output_string)> m_simulator;
@@ -98,8 +140,17 @@ class PakmanMPIWorker
         static constexpr int PAKMAN_WORKER_ERROR_CODE_TAG   = 6;
 
         static constexpr int PAKMAN_TERMINATE_WORKER_SIGNAL = 0;
+        static constexpr int PAKMAN_CANCEL_WORKER_SIGNAL    = 1;
 };
 
+// Initialize cancellation flag
+bool PakmanMPIWorker::s_cancel_requested = false;
+
+// Initialize peer communicator to a single process
+MPI_Comm PakmanMPIWorker::s_peer_comm = MPI_COMM_NULL;
+int PakmanMPIWorker::s_peer_rank = 0;
+int PakmanMPIWorker::s_peer_size = 1;
+
 // Constructor
 PakmanMPIWorker::PakmanMPIWorker(
     std::function<int(int argc, char** argv, const std::string& input_string,
@@ -121,40 +172,75 @@ int PakmanMPIWorker::run(int argc, char*argv[])
         return PAKMAN_EXIT_FAILURE;
     }
 
+    // Duplicate communicator of the processes of this MPI Worker, so that
+    // the broadcasts below do not interfere with the simulator
+    MPI_Comm_dup(MPI_COMM_WORLD, &s_peer_comm);
+    MPI_Comm_rank(s_peer_comm, &s_peer_rank);
+    MPI_Comm_size(s_peer_comm, &s_peer_size);
+
     // Start loop
     bool continue_loop = true;
     while (continue_loop)
     {
-        // Probe for message
-        MPI_Status status;
-        MPI_Probe(PAKMAN_ROOT, MPI_ANY_TAG, m_parent_comm, &status);
+        // Only the root process communicates with Pakman
+        int tag = 0;
+        int signal = 0;
+        std::string input_string;
+        if (s_peer_rank == PAKMAN_ROOT)
+        {
+            // Probe for message
+            MPI_Status status;
+            MPI_Probe(PAKMAN_ROOT, MPI_ANY_TAG, m_parent_comm, &status);
+            tag = status.MPI_TAG;
+
+            // Receive message or signal
+            if (tag == PAKMAN_MANAGER_MSG_TAG)
+                input_string = receiveMessage();
+            else if (tag == PAKMAN_MANAGER_SIGNAL_TAG)
+                signal = receiveSignal(m_parent_comm);
+        }
+
+        // Broadcast tag, signal and input string to the other processes
+        if (s_peer_size > 1)
+        {
+            MPI_Bcast(&tag, 1, MPI_INT, PAKMAN_ROOT, s_peer_comm);
+            MPI_Bcast(&signal, 1, MPI_INT, PAKMAN_ROOT, s_peer_comm);
+            broadcastString(input_string);
+        }
 
         // Check tag
-        switch (status.MPI_TAG)
+        switch (tag)
         {
             case PAKMAN_MANAGER_MSG_TAG:
                 {
-                // Receive message
-                std::string input_string = receiveMessage();
+                // Reset cancellation flag
+                s_cancel_requested = false;
 
                 // Run simulation
                 std::string output_string;
                 int error_code = m_simulator(argc, argv, input_string,
                         output_string);
 
-                // Send output
-                sendMessage(output_string);
+                // Collect largest error code
+                if (s_peer_size > 1)
+                {
+                    int max_error_code = error_code;
+                    MPI_Reduce(&error_code, &max_error_code, 1, MPI_INT,
+                            MPI_MAX, PAKMAN_ROOT, s_peer_comm);
+                    error_code = max_error_code;
+                }
 
-                // Send error code
-                sendErrorCode(error_code);
+                // Send output and error code
+                if (s_peer_rank == PAKMAN_ROOT)
+                {
+                    sendMessage(output_string);
+                    sendErrorCode(error_code);
+                }
 
                 break;
                 }
             case PAKMAN_MANAGER_SIGNAL_TAG:
                 {
-                // Receive signal
-                int signal = receiveSignal();
-
                 // Check signal
                 switch (signal)
                 {
@@ -164,6 +250,12 @@ int PakmanMPIWorker::run(int argc, char*argv[])
                         continue_loop = false;
                         break;
                         }
+                    case PAKMAN_CANCEL_WORKER_SIGNAL:
+                        {
+                        // The simulation that was cancelled had already
+                        // finished, so there is nothing to do
+                        break;
+                        }
                     default:
                         {
                         std::cerr << "Pakman Worker error: signal not recognised, "
@@ -182,6 +274,9 @@ int PakmanMPIWorker::run(int argc, char*argv[])
         }
     }
 
+    // Free peer communicator
+    MPI_Comm_free(&s_peer_comm);
+
     // Disconnect parent communicator
     MPI_Comm_disconnect(&m_parent_comm);
 
@@ -189,6 +284,36 @@ int PakmanMPIWorker::run(int argc, char*argv[])
     return PAKMAN_EXIT_SUCCESS;
 }
 
+// Check whether ongoing simulation has been cancelled
+bool PakmanMPIWorker::shouldCancel()
+{
+    // If simulation was not yet cancelled, check for cancellation signal on
+    // root process
+    if (!s_cancel_requested && s_peer_rank == PAKMAN_ROOT)
+    {
+        // Probe for signal
+        int flag = 0;
+        MPI_Comm parent_comm = getParentComm();
+        MPI_Iprobe(PAKMAN_ROOT, PAKMAN_MANAGER_SIGNAL_TAG, parent_comm, &flag,
+                MPI_STATUS_IGNORE);
+
+        // During a simulation, the only signal that Pakman can send is the
+        // cancellation signal
+        if (flag && receiveSignal(parent_comm) == PAKMAN_CANCEL_WORKER_SIGNAL)
+            s_cancel_requested = true;
+    }
+
+    // Broadcast cancellation flag to the other processes
+    if (s_peer_size > 1)
+    {
+        int flag = s_cancel_requested;
+        MPI_Bcast(&flag, 1, MPI_INT, PAKMAN_ROOT, s_peer_comm);
+        s_cancel_requested = flag;
+    }
+
+    return s_cancel_requested;
+}
+
 // Get parent communicator
 MPI_Comm PakmanMPIWorker::getParentComm()
 {
@@ -219,12 +344,12 @@ std::string PakmanMPIWorker::receiveMessage()
 }
 
 // Receive signal from Pakman Manager
-int PakmanMPIWorker::receiveSignal()
+int PakmanMPIWorker::receiveSignal(MPI_Comm parent_comm)
 {
     // Receive signal
     int signal;
     MPI_Recv(&signal, 1, MPI_INT, PAKMAN_ROOT, PAKMAN_MANAGER_SIGNAL_TAG,
-            m_parent_comm, MPI_STATUS_IGNORE);
+            parent_comm, MPI_STATUS_IGNORE);
 
     // Return signal
     return signal;
@@ -246,4 +371,16 @@ void PakmanMPIWorker::sendErrorCode(int error_code)
             PAKMAN_WORKER_ERROR_CODE_TAG, m_parent_comm);
 }
 
+// Broadcast string from root to the processes of this MPI Worker
+void PakmanMPIWorker::broadcastString(std::string& str)
+{
+    // Broadcast length of string
+    int count = str.size();
+    MPI_Bcast(&count, 1, MPI_INT, PAKMAN_ROOT, s_peer_comm);
+
+    // Broadcast contents of string
+    str.resize(count);
+    MPI_Bcast(&str[0], count, MPI_CHAR, PAKMAN_ROOT, s_peer_comm);
+}
+
 #endif // PAKMANMPIWORKER_HPP
@@ -22,6 +22,19 @@
  * Pakman and execute the given simulator function to perform the received
  * simulation tasks.
  *
+ * If Pakman spawns the MPI Worker as a group of several MPI processes (see
+ * the option `--worker-procs` of the MPI master), pakman_run_mpi_worker()
+ * must be called by all processes of the group.  The process with rank 0 then
+ * communicates with Pakman and broadcasts every input string to the other
+ * processes, so that the simulator function is called collectively by all
+ * processes.  Only the output string of the process with rank 0 is sent to
+ * Pakman, along with the largest error code returned by any of the
+ * processes.
+ *
+ * Long simulations can call pakman_should_cancel() at regular intervals to
+ * find out whether Pakman has cancelled the simulation, in which case the
+ * simulation can return early.
+ *
  * Note that `MPI_Init()` should be called before calling
  * pakman_run_mpi_worker().  Also, after pakman_run_mpi_worker() returns,
  * `MPI_Finalize()` should be called.
@@ -45,6 +58,13 @@
 #define PAKMAN_WORKER_ERROR_CODE_TAG    6
 
 #define PAKMAN_TERMINATE_WORKER_SIGNAL  0
+#define PAKMAN_CANCEL_WORKER_SIGNAL     1
+
+static int pakman_cancel_requested = 0;
+
+static MPI_Comm pakman_peer_comm = MPI_COMM_NULL;
+static int pakman_peer_rank = 0;
+static int pakman_peer_size = 1;
 
 MPI_Comm pakman_get_parent_comm();
 
@@ -54,8 +74,29 @@ int pakman_receive_signal(MPI_Comm comm);
 void pakman_send_message(MPI_Comm comm, const char *message);
 void pakman_send_error_code(MPI_Comm comm, int error_code);
 
+char* pakman_broadcast_message(char *message);
+
 #endif /* DOXYGEN_SHOULD_SKIP_THIS */
 
+/** Check whether Pakman has cancelled the ongoing simulation.
+ *
+ * Pakman cancels simulations whose results are no longer needed, for example
+ * when an ABC SMC generation has finished.  Since MPI Workers cannot be
+ * terminated with system signals, long simulations should call this function
+ * at regular intervals from within the simulator function, and return as
+ * soon as it returns a nonzero value.  The output string and error code of a
+ * cancelled simulation are discarded by Pakman.
+ *
+ * Calling this function is optional; if it is never called, cancelled
+ * simulations simply run to completion.  If the MPI Worker consists of
+ * several MPI processes, this function must be called collectively by all of
+ * them.
+ *
+ * @return nonzero if the ongoing simulation has been cancelled, zero
+ * otherwise.
+ */
+int pakman_should_cancel();
+
 /** Run the Pakman MPI Worker with the given simulator function.
  *
  * The simulator function must accept four arguments;
@@ -81,6 +122,33 @@ int pakman_run_mpi_worker(
         int (*simulator)(int argc, char *argv[],
             const char *input_string, char **p_output_string));
 
+int pakman_should_cancel()
+{
+    /* If simulation was not yet cancelled, check for cancellation signal on
+     * root process */
+    if (!pakman_cancel_requested && pakman_peer_rank == PAKMAN_ROOT)
+    {
+        /* Probe for signal */
+        int flag = 0;
+        MPI_Comm parent_comm = pakman_get_parent_comm();
+        MPI_Iprobe(PAKMAN_ROOT, PAKMAN_MANAGER_SIGNAL_TAG, parent_comm, &flag,
+                MPI_STATUS_IGNORE);
+
+        /* During a simulation, the only signal that Pakman can send is the
+         * cancellation signal */
+        if (flag && pakman_receive_signal(parent_comm) ==
+                PAKMAN_CANCEL_WORKER_SIGNAL)
+            pakman_cancel_requested = 1;
+    }
+
+    /* Broadcast cancellation flag to the other processes */
+    if (pakman_peer_size > 1)
+        MPI_Bcast(&pakman_cancel_requested, 1, MPI_INT, PAKMAN_ROOT,
+                pakman_peer_comm);
+
+    return pakman_cancel_requested;
+}
+
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
 MPI_Comm pakman_get_parent_comm()
@@ -138,6 +206,24 @@ void pakman_send_error_code(MPI_Comm comm, int error_code)
             PAKMAN_WORKER_ERROR_CODE_TAG, comm);
 }
 
+char* pakman_broadcast_message(char *message)
+{
+    /* Broadcast length of message, including null-terminating character */
+    int count = 0;
+    if (pakman_peer_rank == PAKMAN_ROOT)
+        count = strlen(message) + 1;
+    MPI_Bcast(&count, 1, MPI_INT, PAKMAN_ROOT, pakman_peer_comm);
+
+    /* Allocate buffer on other processes */
+    if (pakman_peer_rank != PAKMAN_ROOT)
+        message = (char *) malloc(count * sizeof(char));
+
+    /* Broadcast message */
+    MPI_Bcast(message, count, MPI_CHAR, PAKMAN_ROOT, pakman_peer_comm);
+
+    return message;
+}
+
 #endif /* DOXYGEN_SHOULD_SKIP_THIS */
 
 int pakman_run_mpi_worker(
@@ -156,32 +242,71 @@ int pakman_run_mpi_worker(
         return PAKMAN_EXIT_FAILURE;
     }
 
+    /* Duplicate communicator of the processes of this MPI Worker, so that
+     * the broadcasts below do not interfere with the simulator */
+    MPI_Comm_dup(MPI_COMM_WORLD, &pakman_peer_comm);
+    MPI_Comm_rank(pakman_peer_comm, &pakman_peer_rank);
+    MPI_Comm_size(pakman_peer_comm, &pakman_peer_size);
+
     /* Start loop */
     int continue_loop = 1;
     while (continue_loop)
     {
-        /* Probe for message */
-        MPI_Status status;
-        MPI_Probe(PAKMAN_ROOT, MPI_ANY_TAG, parent_comm, &status);
+        /* Only the root process communicates with Pakman */
+        int tag = 0;
+        int signal = 0;
+        char *input_string = NULL;
+        if (pakman_peer_rank == PAKMAN_ROOT)
+        {
+            /* Probe for message */
+            MPI_Status status;
+            MPI_Probe(PAKMAN_ROOT, MPI_ANY_TAG, parent_comm, &status);
+            tag = status.MPI_TAG;
+
+            /* Receive message or signal */
+            if (tag == PAKMAN_MANAGER_MSG_TAG)
+                input_string = pakman_receive_message(parent_comm);
+            else if (tag == PAKMAN_MANAGER_SIGNAL_TAG)
+                signal = pakman_receive_signal(parent_comm);
+        }
+
+        /* Broadcast tag, signal and input string to the other processes */
+        if (pakman_peer_size > 1)
+        {
+            MPI_Bcast(&tag, 1, MPI_INT, PAKMAN_ROOT, pakman_peer_comm);
+            MPI_Bcast(&signal, 1, MPI_INT, PAKMAN_ROOT, pakman_peer_comm);
+            if (tag == PAKMAN_MANAGER_MSG_TAG)
+                input_string = pakman_broadcast_message(input_string);
+        }
 
         /* Check tag */
-        switch (status.MPI_TAG)
+        switch (tag)
         {
             case PAKMAN_MANAGER_MSG_TAG:
                 {
-                /* Receive message */
-                char* input_string = pakman_receive_message(parent_comm);
+                /* Reset cancellation flag */
+                pakman_cancel_requested = 0;
 
                 /* Run simulation */
                 char *output_string;
                 int error_code = (*simulator)(argc, argv,
                         input_string, &output_string);
 
-                /* Send output */
-                pakman_send_message(parent_comm, output_string);
+                /* Collect largest error code */
+                if (pakman_peer_size > 1)
+                {
+                    int max_error_code = error_code;
+                    MPI_Reduce(&error_code, &max_error_code, 1, MPI_INT,
+                            MPI_MAX, PAKMAN_ROOT, pakman_peer_comm);
+                    error_code = max_error_code;
+                }
 
-                /* Send error code */
-                pakman_send_error_code(parent_comm, error_code);
+                /* Send output and error code */
+                if (pakman_peer_rank == PAKMAN_ROOT)
+                {
+                    pakman_send_message(parent_comm, output_string);
+                    pakman_send_error_code(parent_comm, error_code);
+                }
 
                 /* Free input and output strings */
                 free(input_string);
@@ -191,9 +316,6 @@ int pakman_run_mpi_worker(
                 }
             case PAKMAN_MANAGER_SIGNAL_TAG:
                 {
-                /* Receive signal */
-                int signal = pakman_receive_signal(parent_comm);
-
                 /* Check signal */
                 switch (signal)
                 {
@@ -203,6 +325,12 @@ int pakman_run_mpi_worker(
                         continue_loop = 0;
                         break;
                         }
+                    case PAKMAN_CANCEL_WORKER_SIGNAL:
+                        {
+                        /* The simulation that was cancelled had already
+                         * finished, so there is nothing to do */
+                        break;
+                        }
                     default:
                         {
                         fputs("Pakman Worker error: signal not recognised, "
@@ -221,6 +349,9 @@ int pakman_run_mpi_worker(
         }
     }
 
+    /* Free peer communicator */
+    MPI_Comm_free(&pakman_peer_comm);
+
     /* Disconnect parent communicator */
     MPI_Comm_disconnect(&parent_comm);
 
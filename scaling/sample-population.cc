@@ -0,0 +1,98 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <functional>
+
+#include "controller/sample_population.h"
+
+// Draw index by linear scan, as a baseline
+static int sample_population_linear(
+        const std::vector<double>& norm_cumsum_array,
+        std::uniform_real_distribution<double>& distribution,
+        std::mt19937_64& generator)
+{
+    double u = distribution(generator);
+
+    for (int idx = 0; idx < norm_cumsum_array.size(); idx++)
+        if (u <= norm_cumsum_array[idx])
+            return idx;
+
+    return norm_cumsum_array.size() - 1;
+}
+
+// Returns number of seconds taken to run function
+static double time_function(const std::function<void()>& function)
+{
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    // Process arguments
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] <<
+            " N...\n"
+            "\n"
+            "Benchmark drawing N indices from a population of N parameters\n"
+            "with random weights, for every given population size N.\n"
+            "\n"
+            "The indices are drawn one at a time by linear scan (for\n"
+            "N <= 100000) and by binary search, and all at once by\n"
+            "systematic and stratified resampling.\n";
+
+        return 2;
+    }
+
+    std::cout << "N linear binary systematic stratified" << std::endl;
+
+    for (int arg = 1; arg < argc; arg++)
+    {
+        int N = std::stoi(argv[arg]);
+
+        // Generate normalized cumulative sum of random weights
+        std::mt19937_64 generator(0);
+        std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+        std::vector<double> weights(N);
+        for (double& weight : weights)
+            weight = distribution(generator);
+
+        std::vector<double> norm_cumsum(N);
+        normalize(weights);
+        cumsum(weights, norm_cumsum);
+
+        std::vector<int> indices(N);
+
+        double linear_time = -1.0;
+        if (N <= 100000)
+            linear_time = time_function([&]() {
+                    for (int k = 0; k < N; k++)
+                        indices[k] = sample_population_linear(norm_cumsum,
+                                distribution, generator); });
+
+        double binary_time = time_function([&]() {
+                for (int k = 0; k < N; k++)
+                    indices[k] = sample_population(norm_cumsum, distribution,
+                            generator); });
+
+        double systematic_time = time_function([&]() {
+                indices = resample_population(norm_cumsum, N,
+                        systematic_resampling, generator); });
+
+        double stratified_time = time_function([&]() {
+                indices = resample_population(norm_cumsum, N,
+                        stratified_resampling, generator); });
+
+        std::cout << N << " " << linear_time << " " << binary_time << " "
+            << systematic_time << " " << stratified_time << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+#include "interface/NumericPopulation.h"
+#include "controller/PerturbationKernel.h"
+
+// Returns number of seconds taken to compute weight denominators
+static double time_denominators(const PerturbationKernel& kernel,
+        const NumericPopulation& population_old,
+        const std::vector<double>& weights_old,
+        const NumericPopulation& perturbed,
+        int num_threads, std::vector<double>& denominators)
+{
+    auto start = std::chrono::steady_clock::now();
+    denominators = kernel.weightDenominators(population_old, weights_old,
+            perturbed, num_threads);
+    auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    // Process arguments
+    if (argc != 5)
+    {
+        std::cerr << "Usage: " << argv[0] <<
+            " N D KERNEL TOL\n"
+            "\n"
+            "Benchmark computation of SMC weight denominators.\n"
+            "\n"
+            "The previous generation consists of N parameters with D\n"
+            "components that are uniformly distributed on the unit cube, and\n"
+            "the current generation consists of N parameters perturbed from\n"
+            "the previous generation with the perturbation kernel KERNEL,\n"
+            "e.g. 'gaussian:sigma=0.01'.\n"
+            "\n"
+            "The weight denominators are computed exactly and with the\n"
+            "approximation with tolerance TOL, and the timings and the\n"
+            "maximum error relative to the maximum of the kernel are\n"
+            "printed.\n";
+
+        return 2;
+    }
+
+    int N = std::stoi(argv[1]);
+    int D = std::stoi(argv[2]);
+    std::string spec = argv[3];
+    double tolerance = std::stod(argv[4]);
+    int num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    PerturbationKernel exact_kernel(spec, D);
+    PerturbationKernel approx_kernel(spec, D, tolerance);
+
+    // Generate populations
+    std::mt19937_64 generator(0);
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+    NumericPopulation population_old(D);
+    std::vector<double> parameter(D);
+    for (int i = 0; i < N; i++)
+    {
+        for (double& value : parameter)
+            value = distribution(generator);
+        population_old.push_back(parameter);
+    }
+
+    std::vector<double> weights_old(N, 1.0 / N);
+
+    NumericPopulation perturbed(D);
+    for (int i = 0; i < N; i++)
+        perturbed.push_back(exact_kernel.perturb(population_old.row(i),
+                    generator));
+
+    // Compute denominators
+    std::vector<double> exact, approx;
+    double exact_time = time_denominators(exact_kernel, population_old,
+            weights_old, perturbed, num_threads, exact);
+    double approx_time = time_denominators(approx_kernel, population_old,
+            weights_old, perturbed, num_threads, approx);
+
+    // The maximum of the kernel is its probability density at zero
+    std::vector<double> zero(D, 0.0);
+    double kernel_max = exact_kernel.pdf(zero, zero);
+
+    double max_error = 0.0;
+    for (int j = 0; j < N; j++)
+        max_error = std::max(max_error, std::fabs(exact[j] - approx[j]));
+
+    std::cout << "threads: " << num_threads << std::endl;
+    std::cout << "exact time: " << exact_time << " s" << std::endl;
+    std::cout << "approximate time: " << approx_time << " s" << std::endl;
+    std::cout << "speedup: " << exact_time / approx_time << std::endl;
+    std::cout << "maximum error / kernel maximum: " << max_error / kernel_max
+        << std::endl;
+
+    return 0;
+}
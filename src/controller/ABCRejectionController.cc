@@ -1,7 +1,8 @@
 #include <string>
 #include <iostream>
-#include <sstream>
 #include <stdexcept>
+#include <sstream>
+#include <limits>
 
 #include <assert.h>
 
@@ -11,6 +12,8 @@
 #include "core/OutputStreamHandler.h"
 #include "interface/protocols.h"
 #include "interface/output.h"
+#include "interface/serialisation.h"
+#include "interface/deserialisation.h"
 #include "master/AbstractMaster.h"
 
 #include "ABCRejectionController.h"
@@ -21,8 +24,12 @@ ABCRejectionController::ABCRejectionController(const Input& input_obj) :
     m_epsilon(input_obj.epsilon),
     m_prior_sampler(input_obj.prior_sampler),
     m_parameter_names(input_obj.parameter_names),
-    m_simulator(input_obj.simulator)
+    m_simulator(input_obj.simulator),
+    m_batch_helpers(input_obj.batch_helpers),
+    m_checkpointer(input_obj.checkpoint)
 {
+    if (m_checkpointer.isResuming())
+        deserialiseState(m_checkpointer.readResumeFile());
 }
 
 // Iterate function
@@ -42,26 +49,19 @@ void ABCRejectionController::iterate()
         // Get reference to front finished task
         TaskHandler& task = m_p_master->frontFinishedTask();
 
+        // Look up parameter of finished task
+        auto pending_it = m_pending.find(task.getTaskId());
+        assert(pending_it != m_pending.end());
+
         // Check if error occured
         if (!task.didErrorOccur())
         {
             // Check if parameter was accepted
             if (parse_simulator_output(task.getOutputString()))
             {
-                // Declare raw parameter
-                std::string raw_parameter;
-
-                // Get input string
-                std::stringstream input_sstrm(task.getInputString());
-
-                // Discard epsilon
-                std::getline(input_sstrm, raw_parameter);
-
-                // Read accepted parameter
-                std::getline(input_sstrm, raw_parameter);
-
                 // Push accepted parameter
-                m_prmtr_accepted.push_back(std::move(raw_parameter));
+                m_prmtr_accepted.push_back(std::move(pending_it->second));
+                m_wall_times_accepted.push_back(task.getWallTime());
             }
         }
         // If error occurred, check if g_ignore_errors is set
@@ -73,10 +73,15 @@ void ABCRejectionController::iterate()
 
         // Pop finished task
         m_p_master->popFinishedTask();
+
+        // Erase parameter of finished task
+        m_pending.erase(pending_it);
     }
 
-    // If enough parameters have been accepted, print them and terminate Master
-    // and Managers.
+    // Print newly accepted parameters
+    writeAcceptedParameters();
+
+    // If enough parameters have been accepted, terminate Master and Managers.
     if (m_prmtr_accepted.size() == m_number_accept)
     {
         // Print message
@@ -84,9 +89,8 @@ void ABCRejectionController::iterate()
                 m_number_accept, m_number_simulated, (100.0 * m_number_accept /
                     (double) m_number_simulated));
 
-        // Print accepted parameters
-        write_parameters(OutputStreamHandler::instance()->getOutputStream(),
-                m_parameter_names, m_prmtr_accepted);
+        // Ensure that the last checkpoint has been written
+        m_checkpointer.wait();
 
         // Terminate Master
         m_p_master->terminate();
@@ -97,8 +101,31 @@ void ABCRejectionController::iterate()
     // There is still work to be done, so make sure there are as many tasks
     // queued as there are Managers
     while (m_p_master->needMorePendingTasks())
-        m_p_master->pushPendingTask(format_simulator_input(m_epsilon.str(),
-                    sample_from_prior(m_prior_sampler)));
+    {
+        // Sample candidate parameters if there are none left
+        if (m_candidates.empty())
+        {
+            if (m_batch_helpers)
+            {
+                for (Parameter& parameter : sample_from_prior(m_prior_sampler,
+                            m_p_master->numWorkers()))
+                    m_candidates.push(std::move(parameter));
+            }
+            else
+                m_candidates.push(sample_from_prior(m_prior_sampler));
+        }
+
+        // Push pending task and record its parameter, so that it does not
+        // need to be parsed from the input string of the task
+        task_id_t task_id = m_p_master->pushPendingTask(
+                format_simulator_input(m_epsilon.str(), m_candidates.front()));
+        m_pending[task_id] = std::move(m_candidates.front());
+        m_candidates.pop();
+    }
+
+    // Write periodic checkpoint
+    if (m_checkpointer.isDue())
+        m_checkpointer.write(serialiseState());
 
     m_entered = false;
 }
@@ -107,3 +134,95 @@ Command ABCRejectionController::getSimulator() const
 {
     return m_simulator;
 }
+
+// Write accepted parameters as they arrive, rather than all at once at the
+// end, and flush them once per iteration.  When resuming, the parameters
+// restored from the checkpoint that had not been written are written first
+void ABCRejectionController::writeAcceptedParameters()
+{
+    if (m_header_written && m_num_written == m_prmtr_accepted.size())
+        return;
+
+    std::ostream& ostrm = OutputStreamHandler::instance()->getOutputStream();
+
+    // In binary format, accepted parameters have unit weight and belong to
+    // generation 0
+    if (g_binary_output)
+    {
+        if (!m_p_binary_writer)
+            m_p_binary_writer.reset(new BinaryResultWriter(ostrm,
+                        m_parameter_names, !m_header_written));
+
+        for (; m_num_written < m_prmtr_accepted.size(); m_num_written++)
+            m_p_binary_writer->addRow(m_prmtr_accepted[m_num_written], 1.0,
+                    0, m_wall_times_accepted[m_num_written], 0);
+
+        m_p_binary_writer->flush();
+        m_header_written = true;
+        return;
+    }
+
+    // Print header before first parameter
+    if (!m_header_written)
+    {
+        write_parameter_names(ostrm, m_parameter_names);
+        m_header_written = true;
+    }
+
+    for (; m_num_written < m_prmtr_accepted.size(); m_num_written++)
+        write_parameter(ostrm, m_prmtr_accepted[m_num_written]);
+
+    ostrm.flush();
+}
+
+// Serialise state that is needed to resume.  Candidates and pending tasks are
+// not serialised, since they are sampled again when resuming
+std::string ABCRejectionController::serialiseState() const
+{
+    std::ostringstream out;
+
+    serialise_scalar_value("controller", std::string("rejection"), out);
+    serialise_scalar_value("m_number_simulated", m_number_simulated, out);
+    serialise_parameters("m_prmtr_accepted", m_prmtr_accepted, out);
+    serialise_scalar_value("m_num_written", m_num_written, out);
+    serialise_scalar_value("m_header_written", m_header_written, out);
+
+    return out.str();
+}
+
+// Restore state from checkpoint
+void ABCRejectionController::deserialiseState(const std::string& state)
+{
+    std::istringstream in(state);
+
+    if (deserialise_scalar_value<std::string>("controller", in)
+            != "rejection")
+    {
+        std::runtime_error e("Checkpoint was not written by rejection "
+                "controller");
+        throw e;
+    }
+
+    m_number_simulated = deserialise_scalar_value<int>("m_number_simulated",
+            in);
+    m_prmtr_accepted = deserialise_parameters("m_prmtr_accepted", in);
+    m_num_written = deserialise_scalar_value<std::size_t>("m_num_written",
+            in);
+    m_header_written = deserialise_scalar_value<bool>("m_header_written",
+            in);
+
+    // Wall times are not checkpointed
+    m_wall_times_accepted.assign(m_prmtr_accepted.size(),
+            std::numeric_limits<double>::quiet_NaN());
+
+    if (m_prmtr_accepted.size() > m_number_accept
+            || m_num_written > m_prmtr_accepted.size())
+    {
+        std::runtime_error e("Checkpoint has more accepted parameters than "
+                "--number-accept");
+        throw e;
+    }
+
+    spdlog::info("Resuming with {} accepted parameters",
+            m_prmtr_accepted.size());
+}
@@ -3,11 +3,17 @@
 
 #include <string>
 #include <vector>
+#include <queue>
+#include <map>
 #include <istream>
+#include <memory>
 
 #include "core/Command.h"
+#include "core/TaskHandler.h"
+#include "interface/BinaryResultWriter.h"
 
 #include "AbstractController.h"
+#include "Checkpointer.h"
 
 class LongOptions;
 class Arguments;
@@ -105,10 +111,26 @@ class ABCRejectionController : public AbstractController
 
             /** Command to run sample from prior. */
             Command prior_sampler;
+
+            /** Whether prior_sampler uses the batch protocol. */
+            bool batch_helpers = false;
+
+            /** Checkpoint options. */
+            Checkpointer::Input checkpoint;
         };
 
     private:
 
+        ///// Member functions /////
+        // Write accepted parameters that have not been written yet
+        void writeAcceptedParameters();
+
+        // Serialise state that is needed to resume
+        std::string serialiseState() const;
+
+        // Restore state from checkpoint
+        void deserialiseState(const std::string& state);
+
         ///// Member variables /////
         // Epsilon
         Epsilon m_epsilon;
@@ -122,6 +144,19 @@ class ABCRejectionController : public AbstractController
         // Vector of accepted parameters
         std::vector<Parameter> m_prmtr_accepted;
 
+        // Wall times of simulations of accepted parameters, which are NaN
+        // for parameters restored from a checkpoint
+        std::vector<double> m_wall_times_accepted;
+
+        // Writer of binary output, if output format is binary
+        std::unique_ptr<BinaryResultWriter> m_p_binary_writer;
+
+        // Number of accepted parameters that have been written
+        std::size_t m_num_written = 0;
+
+        // Whether header has been written
+        bool m_header_written = false;
+
         // Number of parameters simulated
         int m_number_simulated = 0;
 
@@ -131,6 +166,18 @@ class ABCRejectionController : public AbstractController
         // Prior_sampler command
         Command m_prior_sampler;
 
+        // Whether prior_sampler uses the batch protocol
+        const bool m_batch_helpers;
+
+        // Candidate parameters sampled from prior
+        std::queue<Parameter> m_candidates;
+
+        // Parameters of pending tasks by task identifier
+        std::map<task_id_t, Parameter> m_pending;
+
+        // Checkpointer
+        Checkpointer m_checkpointer;
+
         // Entered iterate()
         bool m_entered = false;
 };
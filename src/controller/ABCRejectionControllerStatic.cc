@@ -28,6 +28,17 @@ Description:
   Upon completion, the controller outputs the parameter names, followed by
   newline-separated list of accepted parameters.
 
+  If the flag --batch-helpers is given, 'prior_sampler' samples many
+  parameters per invocation, where the number of parameters is the number of
+  workers.  'prior_sampler' then accepts the number of parameters K on its
+  stdin and outputs K parameters, each on a separate line.
+
+  If the optional argument --checkpoint is given, the accepted parameters are
+  checkpointed periodically, and a run that resumes from a checkpoint with
+  --resume only needs to accept the remaining parameters.  If --output-file
+  is given, the output file is truncated to the output that was written
+  before the checkpoint, and the remaining parameters are appended to it.
+
 Required arguments:
   -N, --number-accept=NUM       NUM is number of parameters to accept
   -E, --epsilon=EPS             EPS is the tolerance passed to 'simulator'
@@ -35,6 +46,19 @@ Required arguments:
                                 parameter names
   -S, --simulator=CMD           CMD is simulator command
   -R, --prior-sampler=CMD       CMD is prior_sampler command
+
+ABC rejection controller options:
+  -K, --batch-helpers           prior_sampler uses the batch protocol
+
+Checkpoint options:
+  -C, --checkpoint=FILE         write checkpoints of the controller state to
+                                FILE
+  -J, --checkpoint-interval=SECONDS
+                                write a checkpoint every SECONDS seconds
+                                (default is 300)
+  -r, --resume=FILE             resume from checkpoint FILE and keep writing
+                                checkpoints to FILE, unless --checkpoint is
+                                given
 )";
 }
 
@@ -46,6 +70,8 @@ void ABCRejectionController::addLongOptions(
     lopts.add({"parameter-names", required_argument, nullptr, 'P'});
     lopts.add({"simulator", required_argument, nullptr, 'S'});
     lopts.add({"prior-sampler", required_argument, nullptr, 'R'});
+    lopts.add({"batch-helpers", no_argument, nullptr, 'K'});
+    Checkpointer::addLongOptions(lopts);
 }
 
 // Static function to make from positional arguments
@@ -68,6 +94,10 @@ ABCRejectionController::Input ABCRejectionController::Input::makeInput(
     // Initialize input
     Input input_obj;
 
+    // Process optional arguments
+    input_obj.batch_helpers = args.isOptionalArgumentSet("batch-helpers");
+    input_obj.checkpoint = Checkpointer::Input::makeInput(args);
+
     try
     {
         input_obj.number_accept =
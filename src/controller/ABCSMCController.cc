@@ -1,9 +1,12 @@
 #include <string>
 #include <vector>
 #include <stdexcept>
-#include <sstream>
 #include <iostream>
 #include <random>
+#include <thread>
+#include <algorithm>
+#include <sstream>
+#include <limits>
 
 #include <assert.h>
 
@@ -12,14 +15,32 @@
 #include "core/common.h"
 #include "core/OutputStreamHandler.h"
 #include "interface/protocols.h"
+#include "interface/numeric_parameter.h"
 #include "interface/output.h"
+#include "interface/serialisation.h"
+#include "interface/deserialisation.h"
 #include "master/AbstractMaster.h"
 
+#include "HelperPool.h"
+#include "PerturbationKernel.h"
+#include "Prior.h"
 #include "smc_weight.h"
 #include "sample_population.h"
 
 #include "ABCSMCController.h"
 
+// Format numeric values of all parameters in population
+static std::vector<Parameter> format_numeric_population(
+        const NumericPopulation& population)
+{
+    std::vector<Parameter> parameters;
+    parameters.reserve(population.size());
+    for (int i = 0; i < population.size(); i++)
+        parameters.push_back(format_numeric_parameter(population.row(i)));
+
+    return parameters;
+}
+
 // Constructor
 ABCSMCController::ABCSMCController(const Input &input_obj) :
     m_epsilons(input_obj.epsilons),
@@ -33,10 +54,34 @@ ABCSMCController::ABCSMCController(const Input &input_obj) :
     m_generator(input_obj.seed),
     m_distribution(0.0, 1.0),
     m_prmtr_accepted_old(input_obj.population_size),
-    m_weights_old(input_obj.population_size)
+    m_weights_old(input_obj.population_size),
+    m_p_helpers(new HelperPool(input_obj.helper_jobs)),
+    m_numeric(!input_obj.perturbation_kernel.empty()
+            || !input_obj.prior.empty()),
+    m_values_accepted_new(input_obj.parameter_names.size()),
+    m_values_accepted_old(input_obj.parameter_names.size()),
+    m_lookahead(2 * input_obj.helper_jobs),
+    m_batch_helpers(input_obj.batch_helpers),
+    m_resampling(input_obj.resampling),
+    m_checkpointer(input_obj.checkpoint)
 {
+    if (!input_obj.perturbation_kernel.empty())
+        m_p_kernel.reset(new PerturbationKernel(input_obj.perturbation_kernel,
+                    input_obj.parameter_names.size(),
+                    input_obj.kernel_tolerance));
+
+    if (!input_obj.prior.empty())
+        m_p_prior.reset(new Prior(input_obj.prior,
+                    input_obj.parameter_names.size()));
+
+    if (m_checkpointer.isResuming())
+        deserialiseState(m_checkpointer.readResumeFile());
 }
 
+// Default destructor in translation unit because HelperPool,
+// PerturbationKernel and Prior are incomplete in header
+ABCSMCController::~ABCSMCController() = default;
+
 // Iterate function
 void ABCSMCController::iterate()
 {
@@ -50,6 +95,10 @@ void ABCSMCController::iterate()
         spdlog::info("Computing generation {}, epsilon = {}", m_t,
                 m_epsilons[m_t].str());
         m_first = false;
+
+        // Weigh parameters that were accepted before the checkpoint
+        for (int i = 0; i < numAccepted(); i++)
+            weighParameter(i);
     }
 
     // If m_t is equal to the number of epsilons, something went wrong because
@@ -58,40 +107,39 @@ void ABCSMCController::iterate()
 
     // Check if there are any new accepted parameters
     while (!m_p_master->finishedTasksEmpty()
-            && m_prmtr_accepted_new.size() < m_population_size)
+            && numAccepted() < m_population_size)
     {
-        // m_prior_pdf_pending should not be empty
-        assert(!m_prior_pdf_pending.empty());
-
         // Increment counter
         m_number_simulated++;
 
         // Get reference to front finished task
         TaskHandler& task = m_p_master->frontFinishedTask();
 
+        // Look up parameter of finished task
+        auto pending_it = m_pending.find(task.getTaskId());
+        assert(pending_it != m_pending.end());
+
         // Check if error occured
         if (!task.didErrorOccur())
         {
             // Check if parameter was accepted
             if (parse_simulator_output(task.getOutputString()))
             {
-                // Declare raw parameter
-                std::string raw_parameter;
-
-                // Get input string
-                std::stringstream input_sstrm(task.getInputString());
-
-                // Discard epsilon
-                std::getline(input_sstrm, raw_parameter);
-
-                // Read accepted parameter
-                std::getline(input_sstrm, raw_parameter);
+                Pending& pending = pending_it->second;
 
                 // Push accepted parameter
-                m_prmtr_accepted_new.push_back(std::move(raw_parameter));
+                if (m_numeric)
+                    m_values_accepted_new.push_back(pending.values);
+                else
+                    m_prmtr_accepted_new.push_back(
+                            std::move(pending.parameter));
+                m_wall_times_new.push_back(task.getWallTime());
 
                 // Push prior_pdf of accepted parameter
-                m_prior_pdf_accepted.push_back(m_prior_pdf_pending.front());
+                m_prior_pdf_accepted.push_back(pending.prior_pdf);
+
+                // Compute weight of accepted parameter
+                weighParameter(numAccepted() - 1);
             }
         }
         // If error occurred, check if g_ignore_errors is set
@@ -104,25 +152,20 @@ void ABCSMCController::iterate()
         // Pop finished task
         m_p_master->popFinishedTask();
 
-        // Pop prior_pdf of finished task
-        m_prior_pdf_pending.pop();
+        // Erase parameter of finished task
+        m_pending.erase(pending_it);
     }
 
-    // Iterate over parameters whose weights have not yet been computed
-    for (int i = m_weights_new.size(); i < m_prmtr_accepted_new.size(); i++)
-        m_weights_new.push_back(smc_weight(
-                m_perturbation_pdf,
-                m_prior_pdf_accepted[i],
-                m_t,
-                m_prmtr_accepted_old,
-                m_weights_old,
-                m_prmtr_accepted_new[i]));
+    // Process output of finished helpers
+    processHelpers();
 
-    // If enough parameters have been accepted for this generation, check if we
-    // are in the last generation.  If we are in the last generation, then
-    // print the accepted parameters and terminate Master.  If we are not in
-    // the last generation, then swap the weights and populations
-    if (m_prmtr_accepted_new.size() == m_population_size)
+    // If enough parameters have been accepted and weighed for this
+    // generation, check if we are in the last generation.  If we are in the
+    // last generation, then print the accepted parameters and terminate
+    // Master.  If we are not in the last generation, then swap the weights and
+    // populations
+    if (numAccepted() == m_population_size
+            && m_number_weighed == m_population_size)
     {
         // Print message
         spdlog::info("Accepted/simulated: {}/{} ({:5.2f}%)",
@@ -130,15 +173,29 @@ void ABCSMCController::iterate()
                 (100.0 * m_population_size / (double) m_number_simulated));
         m_number_simulated = 0;
 
+        // In binary format, every generation is written
+        if (g_binary_output)
+            writeBinaryGeneration();
+
         // Increment generation counter
         m_t++;
 
         // Check if we are in the last generation
         if (m_t == m_epsilons.size())
         {
-            // Print accepted parameters
-            write_parameters(OutputStreamHandler::instance()->getOutputStream(),
-                    m_parameter_names, m_prmtr_accepted_new);
+            // Print accepted parameters, unless they have been written in
+            // binary format
+            if (!g_binary_output && m_numeric)
+                write_numeric_parameters(
+                        OutputStreamHandler::instance()->getOutputStream(),
+                        m_parameter_names, m_values_accepted_new);
+            else if (!g_binary_output)
+                write_parameters(
+                        OutputStreamHandler::instance()->getOutputStream(),
+                        m_parameter_names, m_prmtr_accepted_new);
+
+            // Ensure that the last checkpoint has been written
+            m_checkpointer.wait();
 
             // Terminate Master
             m_p_master->terminate();
@@ -146,9 +203,18 @@ void ABCSMCController::iterate()
             return;
         }
 
-        // Swap population and weights
+        // Swap population and weights.  In numeric mode, the population is
+        // only formatted if perturbation_pdf needs it
         std::swap(m_weights_old, m_weights_new);
-        std::swap(m_prmtr_accepted_old, m_prmtr_accepted_new);
+        if (!m_numeric)
+            std::swap(m_prmtr_accepted_old, m_prmtr_accepted_new);
+        else
+        {
+            std::swap(m_values_accepted_old, m_values_accepted_new);
+            if (!m_p_kernel)
+                m_prmtr_accepted_old =
+                    format_numeric_population(m_values_accepted_old);
+        }
 
         // Normalize and compute cumulative sum
         m_weights_cumsum.resize(m_weights_old.size());
@@ -158,15 +224,28 @@ void ABCSMCController::iterate()
         // Clear m_weights_new, m_prmtr_accepted_new and m_prior_pdf_accepted
         m_weights_new.clear();
         m_prmtr_accepted_new.clear();
+        m_wall_times_new.clear();
+        m_values_accepted_new.clear();
         m_prior_pdf_accepted.clear();
+        m_number_weighed = 0;
+
+        // Discard candidates and helpers of previous generation
+        m_p_helpers->flush();
+        m_helper_requests.clear();
+        m_candidates.clear();
+        m_resampled.clear();
+        m_next_resampled = 0;
 
         // Flush Master
         m_p_master->flush();
         m_entered = false;
 
-        // Clear m_prior_pdf_pending
-        while (!m_prior_pdf_pending.empty())
-            m_prior_pdf_pending.pop();
+        // Clear m_pending
+        m_pending.clear();
+
+        // Write checkpoint at generation boundary
+        if (m_checkpointer.isEnabled())
+            m_checkpointer.write(serialiseState());
 
         // Print message
         spdlog::info("Computing generation {}, epsilon = {}", m_t,
@@ -174,12 +253,57 @@ void ABCSMCController::iterate()
         return;
     }
 
+    // If all parameters have been accepted, wait for their weights
+    if (numAccepted() == m_population_size)
+    {
+        m_entered = false;
+        return;
+    }
+
     // There is still work to be done, so make sure there are as many tasks
-    // queued as there are Managers
+    // queued as there are Managers.  Candidates are pushed in the order in
+    // which they were started, so that the results do not depend on the
+    // order in which helpers finish
     while (m_p_master->needMorePendingTasks())
-        m_p_master->pushPendingTask(
-                format_simulator_input(
-                    m_epsilons[m_t].str(), sampleParameter()));
+    {
+        // If there are no candidates, start a batch of them.  When helpers
+        // are run synchronously, the candidates are ready immediately
+        if (m_candidates.empty())
+        {
+            startCandidates(batchSize());
+            processHelpers();
+        }
+
+        // Stop if front candidate is not yet ready
+        auto it = m_candidates.begin();
+        if (!it->second.ready)
+            break;
+
+        // Push pending task and record sampled parameter, so that it does
+        // not need to be parsed from the input string of the task.  Numeric
+        // parameters are only formatted for the input string
+        Candidate& candidate = it->second;
+        task_id_t task_id = m_p_master->pushPendingTask(m_numeric ?
+                format_simulator_input(m_epsilons[m_t].str(),
+                    format_numeric_parameter(candidate.values)) :
+                format_simulator_input(m_epsilons[m_t].str(),
+                    candidate.parameter));
+        m_pending[task_id] = {std::move(candidate.parameter),
+            std::move(candidate.values), candidate.prior_pdf};
+
+        m_candidates.erase(it);
+    }
+
+    // Keep lookahead buffer of candidates
+    while (static_cast<int>(m_candidates.size()) < m_lookahead * batchSize())
+        startCandidates(batchSize());
+
+    // Start queued helpers
+    m_p_helpers->poll();
+
+    // Write periodic checkpoint
+    if (m_checkpointer.isDue())
+        m_checkpointer.write(serialiseState());
 
     m_entered = false;
 }
@@ -189,39 +313,562 @@ Command ABCSMCController::getSimulator() const
     return m_simulator;
 }
 
-Parameter ABCSMCController::sampleParameter()
+// Register events
+void ABCSMCController::registerEvents(EventWaiter& waiter) const
+{
+    m_p_helpers->registerEvents(waiter);
+}
+
+// Returns number of candidates to request from helpers at once
+int ABCSMCController::batchSize() const
+{
+    return m_batch_helpers ? m_p_master->numWorkers() : 1;
+}
+
+// Start generating new candidate parameters
+void ABCSMCController::startCandidates(int number)
+{
+    // When helpers run in the background, each candidate has its own random
+    // number generator, so that the parameters it samples from the previous
+    // population do not depend on the order in which helpers finish
+    std::vector<int> candidate_ids;
+    for (int i = 0; i < number; i++)
+    {
+        int candidate_id = m_next_candidate_id++;
+        Candidate& candidate = m_candidates[candidate_id];
+        if (&candidateGenerator(candidate) != &m_generator)
+            candidate.generator.seed(m_generator());
+        candidate_ids.push_back(candidate_id);
+    }
+
+    // If in generation 0 and prior is built in, sample from prior directly
+    if (m_t == 0 && m_p_prior)
+    {
+        for (int candidate_id : candidate_ids)
+        {
+            Candidate& candidate = m_candidates.at(candidate_id);
+            candidate.values = m_p_prior->sample(
+                    candidateGenerator(candidate));
+            candidate.ready = true;
+        }
+    }
+
+    // Else if in generation 0, sample from prior with prior_sampler
+    else if (m_t == 0)
+        submitCandidates(prior_sampler, candidate_ids);
+
+    // Else, sample from previous population and perturb
+    else
+        perturbCandidates(candidate_ids);
+}
+
+// Returns random number generator of candidate.  When helpers run
+// synchronously, candidates are generated one after the other, so they all
+// draw from the controller's random number generator, which preserves the
+// sequence of random numbers, and hence the output for a given seed, of
+// earlier versions of pakman.
+std::mt19937_64& ABCSMCController::candidateGenerator(Candidate& candidate)
+{
+    return m_p_helpers->maxHelpers() == 0 ? m_generator : candidate.generator;
+}
+
+// Sample candidates from previous population and perturb them
+void ABCSMCController::perturbCandidates(const std::vector<int>& candidate_ids,
+        bool retry)
 {
-    // If in generation 0
+    // With built-in perturbation kernel and prior, candidates are perturbed
+    // again until their prior pdf is nonzero without involving any helpers
+    std::vector<int> ids = candidate_ids;
+    while (!ids.empty())
+    {
+        // Sample source parameters from parameter population.  Only the
+        // first attempt of a candidate takes its source parameter from the
+        // bulk-resampled indices, so that retries do not depend on the order
+        // in which helpers finish
+        for (int candidate_id : ids)
+        {
+            Candidate& candidate = m_candidates.at(candidate_id);
+            int idx = retry || m_resampling == multinomial_resampling ?
+                sample_population(m_weights_cumsum, m_distribution,
+                        candidateGenerator(candidate)) :
+                nextResampledIndex();
+
+            // In numeric mode, the source parameter is kept as numeric values
+            // and only formatted if it is sent to the perturber
+            if (m_numeric)
+                candidate.values = m_values_accepted_old.row(idx);
+            else
+                candidate.parameter = m_prmtr_accepted_old[idx];
+        }
+        retry = true;
+
+        // Perturb source parameters with perturber
+        if (!m_p_kernel)
+        {
+            submitCandidates(perturber, ids);
+            return;
+        }
+
+        // Else, perturb source parameters with built-in perturbation kernel
+        for (int candidate_id : ids)
+        {
+            Candidate& candidate = m_candidates.at(candidate_id);
+            candidate.values = m_p_kernel->perturb(candidate.values,
+                    candidateGenerator(candidate));
+        }
+
+        // Calculate prior_pdf with prior_pdf
+        if (!m_p_prior)
+        {
+            submitCandidates(prior_pdf, ids);
+            return;
+        }
+
+        // Else, calculate prior_pdf with built-in prior
+        ids = evaluatePrior(ids);
+    }
+}
+
+// Returns next index from bulk-resampled indices, resampling a whole
+// population of indices when they run out
+int ABCSMCController::nextResampledIndex()
+{
+    if (m_next_resampled == m_resampled.size())
+    {
+        // Shuffle indices, since resample_population returns them in
+        // increasing order
+        m_resampled = resample_population(m_weights_cumsum, m_population_size,
+                m_resampling, m_generator);
+        std::shuffle(m_resampled.begin(), m_resampled.end(), m_generator);
+        m_next_resampled = 0;
+    }
+
+    return m_resampled[m_next_resampled++];
+}
+
+// Submit helper requests for candidates, in one batch if helpers are batched
+void ABCSMCController::submitCandidates(helper_t type,
+        const std::vector<int>& candidate_ids)
+{
+    if (!m_batch_helpers)
+    {
+        for (int candidate_id : candidate_ids)
+        {
+            Parameter parameter = candidateParameter(candidate_id);
+            switch (type)
+            {
+                case prior_sampler:
+                    submitHelper(type, {candidate_id}, m_prior_sampler, "");
+                    break;
+                case perturber:
+                    submitHelper(type, {candidate_id}, m_perturber,
+                            format_perturber_input(m_t, parameter));
+                    break;
+                case prior_pdf:
+                    submitHelper(type, {candidate_id}, m_prior_pdf,
+                            format_prior_pdf_input(parameter));
+                    break;
+                default:
+                    assert(false);
+            }
+        }
+        return;
+    }
+
+    // Collect parameters of candidates
+    std::vector<Parameter> parameters;
+    for (int candidate_id : candidate_ids)
+        parameters.push_back(candidateParameter(candidate_id));
+
+    switch (type)
+    {
+        case prior_sampler:
+            submitHelper(type, candidate_ids, m_prior_sampler,
+                    format_prior_sampler_input(candidate_ids.size()));
+            break;
+        case perturber:
+            submitHelper(type, candidate_ids, m_perturber,
+                    format_perturber_input(m_t, parameters));
+            break;
+        case prior_pdf:
+            submitHelper(type, candidate_ids, m_prior_pdf,
+                    format_prior_pdf_input(parameters));
+            break;
+        default:
+            assert(false);
+    }
+}
+
+// Returns parameter of candidate as input to helpers, formatting its numeric
+// values in numeric mode
+Parameter ABCSMCController::candidateParameter(int candidate_id) const
+{
+    const Candidate& candidate = m_candidates.at(candidate_id);
+    return m_numeric ? format_numeric_parameter(candidate.values) :
+        candidate.parameter;
+}
+
+// Returns number of new accepted parameters
+int ABCSMCController::numAccepted() const
+{
+    return m_numeric ? m_values_accepted_new.size() :
+        m_prmtr_accepted_new.size();
+}
+
+// Evaluate built-in prior of candidates and return identifiers of candidates
+// with zero prior pdf
+std::vector<int> ABCSMCController::evaluatePrior(
+        const std::vector<int>& candidate_ids)
+{
+    std::vector<int> rejected_ids;
+    for (int candidate_id : candidate_ids)
+    {
+        Candidate& candidate = m_candidates.at(candidate_id);
+        candidate.prior_pdf = m_p_prior->pdf(candidate.values);
+        if (candidate.prior_pdf == 0.0)
+            rejected_ids.push_back(candidate_id);
+        else
+            candidate.ready = true;
+    }
+
+    return rejected_ids;
+}
+
+// Compute weight of accepted parameter
+void ABCSMCController::weighParameter(int idx)
+{
+    m_weights_new.resize(numAccepted());
+
+    // In generation 0, weights are uniform
     if (m_t == 0)
     {
-        // Push dummy prior_pdf to m_prior_pdf_pending
-        m_prior_pdf_pending.push(0.0);
+        m_weights_new[idx] = 1.0 / ((double) m_population_size);
+        m_number_weighed++;
+        return;
+    }
 
-        // Sample from prior
-        return sample_from_prior(m_prior_sampler);
+    // With built-in perturbation kernel, compute weights of all accepted
+    // parameters at once when the population is complete
+    if (m_p_kernel)
+    {
+        if (idx == m_population_size - 1)
+            weighPopulation();
+        return;
     }
 
-    // Else, sample from previous population and perturb until the prior pdf is
-    // nonzero
-    Parameter sampled_parameter;
-    double sampled_prior_pdf = 0.0;
-    do
+    // Unless helpers are batched, get perturbation pdf
+    if (!m_batch_helpers)
     {
-        // Sample parameter population
-        int idx = sample_population(m_weights_cumsum, m_distribution,
-                m_generator);
-        Parameter source_parameter = m_prmtr_accepted_old[idx];
+        submitHelper(perturbation_pdf, {idx}, m_perturbation_pdf,
+                format_perturbation_pdf_input(m_t, m_numeric ?
+                    format_numeric_parameter(m_values_accepted_new.row(idx)) :
+                    m_prmtr_accepted_new[idx],
+                    m_prmtr_accepted_old));
+        return;
+    }
 
-        // Perturb parameter
-        sampled_parameter = perturb_parameter(m_perturber, m_t,
-                source_parameter);
+    // Else, get perturbation pdf of all accepted parameters at once when the
+    // population is complete
+    if (idx < m_population_size - 1)
+        return;
 
-        // Calculate prior_pdf
-        sampled_prior_pdf = get_prior_pdf(m_prior_pdf, sampled_parameter);
-    } while (sampled_prior_pdf == 0.0);
+    std::vector<int> indices(m_population_size);
+    for (int i = 0; i < m_population_size; i++)
+        indices[i] = i;
 
-    // Push sampled_prior_pdf to m_prior_pdf_pending
-    m_prior_pdf_pending.push(sampled_prior_pdf);
+    submitHelper(perturbation_pdf, indices, m_perturbation_pdf,
+            format_perturbation_pdf_input(m_t, m_numeric ?
+                format_numeric_population(m_values_accepted_new) :
+                m_prmtr_accepted_new,
+                m_prmtr_accepted_old));
+}
+
+// Set parameter of candidate from helper output.  In numeric mode, the
+// parameter is parsed once and only its numeric values are kept
+void ABCSMCController::setCandidateParameter(Candidate& candidate,
+        Parameter&& parameter)
+{
+    if (!m_numeric)
+    {
+        candidate.parameter = std::move(parameter);
+        return;
+    }
+
+    candidate.values = parse_numeric_parameter(parameter);
+    check_numeric_parameter(candidate.values, m_parameter_names.size());
+}
+
+// Compute weights of all accepted parameters with built-in perturbation kernel
+void ABCSMCController::weighPopulation()
+{
+    // Compute denominators on as many threads as there are cores
+    std::vector<double> denominators = m_p_kernel->weightDenominators(
+            m_values_accepted_old, m_weights_old, m_values_accepted_new,
+            std::max(1u, std::thread::hardware_concurrency()));
+
+    for (int i = 0; i < m_population_size; i++)
+        m_weights_new[i] = m_prior_pdf_accepted[i] / denominators[i];
+
+    m_number_weighed = m_population_size;
+}
+
+// Submit helper request
+void ABCSMCController::submitHelper(helper_t type,
+        const std::vector<int>& indices, const Command& helper,
+        const std::string& input_string)
+{
+    // Synchronous helpers finish immediately, but their output is only
+    // processed by processHelpers()
+    int request_id = m_p_helpers->submit(helper, input_string);
+    m_helper_requests[request_id] = {type, indices};
+}
+
+// Process output of finished helpers
+void ABCSMCController::processHelpers()
+{
+    m_p_helpers->poll();
+
+    while (!m_p_helpers->finishedEmpty())
+    {
+        // Look up request
+        auto request_it = m_helper_requests.find(m_p_helpers->frontFinishedId());
+        assert(request_it != m_helper_requests.end());
+        HelperRequest request = request_it->second;
+        m_helper_requests.erase(request_it);
+
+        // Copy output, since processing it may submit new requests
+        std::string output = m_p_helpers->frontFinishedOutput();
+        m_p_helpers->popFinished();
+
+        // Number of outputs expected from helper
+        const int number = request.indices.size();
+
+        switch (request.type)
+        {
+            // Candidates sampled from prior are ready, with dummy prior_pdf
+            case prior_sampler:
+                {
+                    std::vector<Parameter> parameters = m_batch_helpers ?
+                        parse_prior_sampler_output(output, number) :
+                        std::vector<Parameter>{
+                            parse_prior_sampler_output(output)};
+
+                    for (int i = 0; i < number; i++)
+                    {
+                        Candidate& candidate =
+                            m_candidates.at(request.indices[i]);
+                        setCandidateParameter(candidate,
+                                std::move(parameters[i]));
+                        candidate.prior_pdf = 0.0;
+                        candidate.ready = true;
+                    }
+                    break;
+                }
+
+            // Calculate prior_pdf of perturbed candidates
+            case perturber:
+                {
+                    std::vector<Parameter> parameters = m_batch_helpers ?
+                        parse_perturber_output(output, number) :
+                        std::vector<Parameter>{
+                            parse_perturber_output(output)};
+
+                    for (int i = 0; i < number; i++)
+                    {
+                        Candidate& candidate =
+                            m_candidates.at(request.indices[i]);
+                        setCandidateParameter(candidate,
+                                std::move(parameters[i]));
+                    }
+
+                    // Calculate prior_pdf with prior_pdf
+                    if (!m_p_prior)
+                    {
+                        submitCandidates(prior_pdf, request.indices);
+                        break;
+                    }
+
+                    // Else, calculate prior_pdf with built-in prior and
+                    // perturb again until the prior pdf is nonzero
+                    std::vector<int> rejected_ids =
+                        evaluatePrior(request.indices);
+                    if (!rejected_ids.empty())
+                        perturbCandidates(rejected_ids, true);
+                    break;
+                }
+
+            // Perturb again until the prior pdf is nonzero
+            case prior_pdf:
+                {
+                    std::vector<double> prior_pdfs = m_batch_helpers ?
+                        parse_prior_pdf_output(output, number) :
+                        std::vector<double>{parse_prior_pdf_output(output)};
+
+                    std::vector<int> rejected_ids;
+                    for (int i = 0; i < number; i++)
+                    {
+                        Candidate& candidate =
+                            m_candidates.at(request.indices[i]);
+                        candidate.prior_pdf = prior_pdfs[i];
+                        if (candidate.prior_pdf == 0.0)
+                            rejected_ids.push_back(request.indices[i]);
+                        else
+                            candidate.ready = true;
+                    }
+
+                    if (!rejected_ids.empty())
+                        perturbCandidates(rejected_ids, true);
+                    break;
+                }
+
+            // Compute weights of accepted parameters
+            case perturbation_pdf:
+                {
+                    std::vector<std::vector<double>> perturbation_pdfs =
+                        m_batch_helpers ?
+                        parse_perturbation_pdf_output(output, number,
+                                m_population_size) :
+                        std::vector<std::vector<double>>{
+                            parse_perturbation_pdf_output(output)};
+
+                    for (int i = 0; i < number; i++)
+                    {
+                        const int idx = request.indices[i];
+                        m_weights_new[idx] = smc_weight(
+                                m_prior_pdf_accepted[idx],
+                                m_weights_old,
+                                perturbation_pdfs[i]);
+                        m_number_weighed++;
+                    }
+                    break;
+                }
+        }
+    }
+}
+
+// Serialise state that is needed to resume.  Candidates, helpers and pending
+// tasks are not serialised, since they are regenerated when resuming
+std::string ABCSMCController::serialiseState() const
+{
+    // Write doubles with enough precision to be parsed back exactly
+    std::ostringstream out;
+    out.precision(17);
+
+    serialise_scalar_value("controller", std::string("smc"), out);
+    serialise_scalar_value("m_population_size", m_population_size, out);
+    serialise_scalar_value("m_t", m_t, out);
+    serialise_scalar_value("m_number_simulated", m_number_simulated, out);
+    serialise_scalar_value("m_generator", m_generator, out);
+    serialise_parameters("m_prmtr_accepted_old", m_numeric && m_t > 0 ?
+            format_numeric_population(m_values_accepted_old) :
+            m_prmtr_accepted_old, out);
+    serialise_vector("m_weights_old", m_weights_old, out);
+    serialise_vector("m_resampled", m_resampled, out);
+    serialise_scalar_value("m_next_resampled", m_next_resampled, out);
+    serialise_parameters("m_prmtr_accepted_new", m_numeric ?
+            format_numeric_population(m_values_accepted_new) :
+            m_prmtr_accepted_new, out);
+    serialise_vector("m_prior_pdf_accepted", m_prior_pdf_accepted, out);
+
+    return out.str();
+}
+
+// Restore state from checkpoint
+void ABCSMCController::deserialiseState(const std::string& state)
+{
+    std::istringstream in(state);
+
+    if (deserialise_scalar_value<std::string>("controller", in) != "smc"
+            || deserialise_scalar_value<int>("m_population_size", in)
+                != m_population_size)
+    {
+        std::runtime_error e("Checkpoint was not written by smc controller "
+                "with the same population size");
+        throw e;
+    }
+
+    m_t = deserialise_scalar_value<int>("m_t", in);
+    m_t_resumed = m_t;
+    m_number_simulated = deserialise_scalar_value<int>("m_number_simulated",
+            in);
+    m_generator = deserialise_scalar_value<std::mt19937_64>("m_generator",
+            in);
+    m_prmtr_accepted_old = deserialise_parameters("m_prmtr_accepted_old", in);
+    m_weights_old = deserialise_vector<double>("m_weights_old", in);
+    m_resampled = deserialise_vector<int>("m_resampled", in);
+    m_next_resampled = deserialise_scalar_value<int>("m_next_resampled", in);
+    m_prmtr_accepted_new = deserialise_parameters("m_prmtr_accepted_new", in);
+    m_prior_pdf_accepted = deserialise_vector<double>("m_prior_pdf_accepted",
+            in);
+
+    // Wall times are not checkpointed
+    m_wall_times_new.assign(m_prmtr_accepted_new.size(),
+            std::numeric_limits<double>::quiet_NaN());
+
+    if (m_t >= m_epsilons.size()
+            || m_prmtr_accepted_old.size() != m_population_size
+            || m_weights_old.size() != m_population_size
+            || m_prmtr_accepted_new.size() >= m_population_size
+            || m_prior_pdf_accepted.size() != m_prmtr_accepted_new.size())
+    {
+        std::runtime_error e("Checkpoint does not match epsilons or "
+                "population size");
+        throw e;
+    }
+
+    // Weights of previous generation were normalized before checkpointing
+    if (m_t > 0)
+    {
+        m_weights_cumsum.resize(m_weights_old.size());
+        cumsum(m_weights_old, m_weights_cumsum);
+    }
+
+    spdlog::info("Resuming generation {} with {} accepted parameters", m_t,
+            m_prmtr_accepted_new.size());
+
+    // Numeric values were formatted exactly, so parsing them gives the same
+    // values as before the checkpoint.  Only the previous population is kept
+    // as string, and only if perturbation_pdf needs it
+    if (m_numeric)
+    {
+        if (m_t > 0)
+            for (const Parameter& parameter : m_prmtr_accepted_old)
+                m_values_accepted_old.push_back(
+                        parse_numeric_parameter(parameter));
+
+        for (const Parameter& parameter : m_prmtr_accepted_new)
+            m_values_accepted_new.push_back(
+                    parse_numeric_parameter(parameter));
+
+        if (m_t > 0 && m_p_kernel)
+            m_prmtr_accepted_old.clear();
+        m_prmtr_accepted_new.clear();
+    }
+}
+
+// Write new population in binary format, with normalized weights.  A
+// resumed run appends the generations from the checkpoint onwards to the
+// generations written before the checkpoint, whose header was written with
+// the first generation
+void ABCSMCController::writeBinaryGeneration()
+{
+    if (!m_p_binary_writer)
+        m_p_binary_writer.reset(new BinaryResultWriter(
+                    OutputStreamHandler::instance()->getOutputStream(),
+                    m_parameter_names, m_t_resumed == 0));
+
+    std::vector<double> weights(m_weights_new);
+    normalize(weights);
+
+    for (int i = 0; i < m_population_size; i++)
+    {
+        if (m_numeric)
+            m_p_binary_writer->addRow(m_values_accepted_new.row(i),
+                    weights[i], m_t, m_wall_times_new[i], 0);
+        else
+            m_p_binary_writer->addRow(m_prmtr_accepted_new[i], weights[i],
+                    m_t, m_wall_times_new[i], 0);
+    }
 
-    return sampled_parameter;
+    m_p_binary_writer->flush();
 }
@@ -3,17 +3,25 @@
 
 #include <string>
 #include <vector>
-#include <queue>
+#include <map>
 #include <memory>
 #include <random>
 #include <chrono>
 
 #include "core/Command.h"
+#include "core/TaskHandler.h"
+#include "interface/NumericPopulation.h"
+#include "interface/BinaryResultWriter.h"
 
 #include "AbstractController.h"
+#include "Checkpointer.h"
+#include "sample_population.h"
 
 class LongOptions;
 class Arguments;
+class HelperPool;
+class PerturbationKernel;
+class Prior;
 
 /** A Controller class implementing the ABC SMC algorithm.
  *
@@ -49,8 +57,8 @@ class ABCSMCController : public AbstractController
          */
         ABCSMCController(const Input &input_obj);
 
-        /** Default destructor does nothing. */
-        virtual ~ABCSMCController() override = default;
+        /** Destructor terminates any running helpers. */
+        virtual ~ABCSMCController() override;
 
         /** Iterates the ABCSMCController.  Should be called by a Master.  */
         virtual void iterate() override;
@@ -58,6 +66,12 @@ class ABCSMCController : public AbstractController
         /** @return simulator command. */
         virtual Command getSimulator() const override;
 
+        /** Register the read pipes of running helpers.
+         *
+         * @param waiter  EventWaiter to register events with.
+         */
+        virtual void registerEvents(EventWaiter& waiter) const override;
+
         /** @return help message string. */
         static std::string help();
 
@@ -114,6 +128,33 @@ class ABCSMCController : public AbstractController
              */
             Command perturbation_pdf;
 
+            /** Maximum number of helpers running at the same time, or zero
+             * to run helpers synchronously. */
+            int helper_jobs = 0;
+
+            /** Whether prior_sampler, perturber, prior_pdf and
+             * perturbation_pdf use the batch protocol. */
+            bool batch_helpers = false;
+
+            /** Specification of built-in perturbation kernel, or empty to
+             * use perturber and perturbation_pdf. */
+            std::string perturbation_kernel;
+
+            /** Tolerance for approximate SMC weights with built-in
+             * perturbation kernel, or zero to compute them exactly. */
+            double kernel_tolerance = 0.0;
+
+            /** Scheme for sampling source parameters from the previous
+             * generation. */
+            resampling_t resampling = multinomial_resampling;
+
+            /** Specification of built-in prior, or empty to use
+             * prior_sampler and prior_pdf. */
+            std::string prior;
+
+            /** Checkpoint options. */
+            Checkpointer::Input checkpoint;
+
             /** Seed for pseudo random number generator */
             unsigned long seed =
                 std::chrono::system_clock::now().time_since_epoch().count();
@@ -121,9 +162,97 @@ class ABCSMCController : public AbstractController
 
     private:
 
+        /** Enumerate type for helper commands. */
+        enum helper_t { prior_sampler, perturber, prior_pdf, perturbation_pdf };
+
+        // Helper request, where indices refer to candidates when the helper
+        // generates candidates, and to accepted parameters when the helper
+        // is perturbation_pdf
+        struct HelperRequest
+        {
+            helper_t type;
+            std::vector<int> indices;
+        };
+
+        // Parameter of pending task, where parameter is only set in string
+        // mode and values are only set in numeric mode
+        struct Pending
+        {
+            Parameter parameter;
+            std::vector<double> values;
+            double prior_pdf;
+        };
+
+        // Candidate parameter that is being generated by helpers, where
+        // parameter is only set in string mode and values are only set in
+        // numeric mode
+        struct Candidate
+        {
+            Parameter parameter;
+            std::vector<double> values;
+            double prior_pdf = 0.0;
+            bool ready = false;
+            std::mt19937_64 generator;
+        };
+
         ///// Member functions /////
-        // Sample parameter
-        Parameter sampleParameter();
+        // Number of candidates to request from helpers at once
+        int batchSize() const;
+
+        // Start generating new candidate parameters
+        void startCandidates(int number);
+
+        // Returns random number generator of candidate
+        std::mt19937_64& candidateGenerator(Candidate& candidate);
+
+        // Sample candidates from previous population and perturb them,
+        // where retry is set for candidates whose prior pdf was zero
+        void perturbCandidates(const std::vector<int>& candidate_ids,
+                bool retry = false);
+
+        // Returns next index from bulk-resampled indices
+        int nextResampledIndex();
+
+        // Submit helper requests for candidates
+        void submitCandidates(helper_t type,
+                const std::vector<int>& candidate_ids);
+
+        // Returns parameter of candidate as input to helpers
+        Parameter candidateParameter(int candidate_id) const;
+
+        // Set parameter of candidate from helper output
+        void setCandidateParameter(Candidate& candidate,
+                Parameter&& parameter);
+
+        // Returns number of new accepted parameters
+        int numAccepted() const;
+
+        // Evaluate built-in prior of candidates and return identifiers of
+        // candidates with zero prior pdf
+        std::vector<int> evaluatePrior(const std::vector<int>& candidate_ids);
+
+        // Compute weights of all accepted parameters with built-in
+        // perturbation kernel
+        void weighPopulation();
+
+        // Compute weight of accepted parameter
+        void weighParameter(int idx);
+
+        // Submit helper request
+        void submitHelper(helper_t type, const std::vector<int>& indices,
+                const Command& helper, const std::string& input_string);
+
+        // Process output of finished helpers
+        void processHelpers();
+
+        // Serialise state that is needed to resume
+        std::string serialiseState() const;
+
+        // Restore state from checkpoint
+        void deserialiseState(const std::string& state);
+
+        // Write new population in binary format
+        void writeBinaryGeneration();
 
         ///// Member variables /////
         // Epsilons
@@ -141,12 +270,22 @@ class ABCSMCController : public AbstractController
         // Population size
         int m_population_size;
 
-        // New accepted parameters
+        // New accepted parameters, which are only kept in string mode
         std::vector<Parameter> m_prmtr_accepted_new;
 
         // New weights
         std::vector<double> m_weights_new;
 
+        // Wall times of simulations of new accepted parameters, which are
+        // NaN for parameters restored from a checkpoint
+        std::vector<double> m_wall_times_new;
+
+        // Writer of binary output, if output format is binary
+        std::unique_ptr<BinaryResultWriter> m_p_binary_writer;
+
+        // Generation that was resumed from
+        int m_t_resumed = 0;
+
         // Number of parameters simulated
         int m_number_simulated = 0;
 
@@ -162,10 +301,11 @@ class ABCSMCController : public AbstractController
         // Random number generator
         std::mt19937_64 m_generator;
 
-        // Prior pdf values of pending parameters
-        std::queue<double> m_prior_pdf_pending;
+        // Pending parameters by task identifier
+        std::map<task_id_t, Pending> m_pending;
 
-        // Parameters accepted in previous generation
+        // Parameters accepted in previous generation.  In numeric mode, they
+        // are only formatted if perturbation_pdf needs them
         std::vector<Parameter> m_prmtr_accepted_old;
 
         // Weights of parameters accepted in previous generation
@@ -183,6 +323,54 @@ class ABCSMCController : public AbstractController
         // Prior_pdf command
         Command m_prior_pdf;
 
+        // Helpers for generating candidates and computing weights
+        std::unique_ptr<HelperPool> m_p_helpers;
+
+        // Built-in perturbation kernel, or nullptr to use helpers
+        std::unique_ptr<PerturbationKernel> m_p_kernel;
+
+        // Built-in prior, or nullptr to use helpers
+        std::unique_ptr<Prior> m_p_prior;
+
+        // Whether parameters are numeric, which is the case if the
+        // perturbation kernel or the prior is built in.  Numeric parameters
+        // are parsed once, when they are returned by a helper, and only
+        // formatted when they are sent to the simulator, a helper or the
+        // output
+        const bool m_numeric;
+
+        // Numeric values of new and previous accepted parameters
+        NumericPopulation m_values_accepted_new;
+        NumericPopulation m_values_accepted_old;
+
+        // Number of batches of candidates to generate ahead of time
+        const int m_lookahead;
+
+        // Whether helpers use the batch protocol
+        const bool m_batch_helpers;
+
+        // Scheme for sampling source parameters
+        const resampling_t m_resampling;
+
+        // Bulk-resampled indices of source parameters, and next index to use
+        std::vector<int> m_resampled;
+        int m_next_resampled = 0;
+
+        // Candidates by candidate identifier, in the order they were started
+        std::map<int, Candidate> m_candidates;
+
+        // Identifier of next candidate
+        int m_next_candidate_id = 0;
+
+        // Helper requests by request identifier
+        std::map<int, HelperRequest> m_helper_requests;
+
+        // Number of accepted parameters whose weights have been computed
+        int m_number_weighed = 0;
+
+        // Checkpointer
+        Checkpointer m_checkpointer;
+
         // First iteration
         bool m_first = true;
 
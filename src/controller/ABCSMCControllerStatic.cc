@@ -2,6 +2,7 @@
 #include <fstream>
 #include <string>
 #include <random>
+#include <stdexcept>
 
 #include "core/common.h"
 #include "core/utils.h"
@@ -56,7 +57,82 @@ Description:
   parameter was accepted.
 
   Upon completion, the controller outputs the parameter names, followed by
-  newline-separated list of accepted parameters.
+  newline-separated list of accepted parameters.  With --output-format=binary,
+  the accepted parameters of every generation are written at the end of the
+  generation, together with their normalized weights.
+
+  By default, 'prior_sampler', 'perturber', 'prior_pdf' and 'perturbation_pdf'
+  are run one at a time, and pakman waits for them to finish.  If the optional
+  argument --helper-jobs is given, up to NUM of them run at the same time in
+  the background, and pakman keeps a buffer of 2*NUM candidate parameters
+  ready to be simulated.  This is useful when there are many workers, which
+  would otherwise wait for pakman to generate candidate parameters.  Note that
+  helpers running at the same time must not share state, such as a seed file.
+  With --helper-jobs, every candidate parameter draws from its own random
+  number generator, so a given --seed gives different results than when
+  helpers run one at a time.
+
+  If the flag --batch-helpers is given, 'prior_sampler', 'perturber' and
+  'prior_pdf' handle many parameters per invocation, where the number of
+  parameters is the number of workers, and 'perturbation_pdf' is invoked
+  once per generation.  'prior_sampler' then accepts the
+  number of parameters K on its stdin and outputs K parameters, each on a
+  separate line.  'perturber' accepts the current generation 't' on the first
+  line, followed by K parameters to be perturbed, and outputs the K perturbed
+  parameters in the same order.  'prior_pdf' accepts K parameters and outputs
+  their K prior probability densities in the same order.  'perturbation_pdf'
+  accepts the current generation 't' on the first line and the number of
+  perturbed parameters M on the second line, followed by the M perturbed
+  parameters and then the N parameters of the previous generation.  It
+  outputs M lines, where line i contains N whitespace-separated probability
+  densities for reaching perturbed parameter i by perturbing each parameter
+  of the previous generation.
+
+  If the parameters are numeric, that is, lists of numbers separated by
+  whitespace or commas, the perturbation kernel and the prior can be computed
+  by pakman itself instead of by helpers.  This avoids starting a helper
+  process for every candidate parameter, and the weights are computed over
+  contiguous arrays on several threads.  If the optional argument
+  --perturbation-kernel is given, 'perturber' and 'perturbation_pdf' are not
+  needed.  SPEC is either 'gaussian:sigma=SIGMAS', which adds normally
+  distributed noise with standard deviation SIGMA to every parameter, or
+  'uniform:width=WIDTHS', which adds uniformly distributed noise on the
+  interval [-WIDTH, WIDTH] to every parameter.  SIGMAS and WIDTHS are
+  comma-separated lists with either one value for every parameter or a single
+  value for all parameters.
+
+  The weights require summing the perturbation kernel over the previous
+  generation for every parameter of the current generation, which takes time
+  proportional to the square of the population size.  If the optional argument
+  --kernel-tolerance is given, the previous generation is bucketed into a grid
+  and only nearby parameters are summed.  For the 'uniform' kernel this gives
+  the same weights up to rounding, and for the 'gaussian' kernel the error of
+  every weight denominator is at most TOL times the maximum of the kernel.  This is most
+  effective for large populations with few parameters.
+
+  If the optional argument --prior is given, 'prior_sampler' and 'prior_pdf'
+  are not needed.  SPEC is a semicolon-separated list with one distribution
+  for every parameter, where every distribution is either 'uniform:LOW,HIGH'
+  or 'normal:MEAN,STDEV'.  For example, a prior for the parameters 'k,m' could
+  be 'uniform:0,1;normal:5,2'.
+
+  By default, the parameter to be perturbed is sampled independently for every
+  candidate parameter (multinomial resampling).  If the optional argument
+  --resampling is given with 'systematic' or 'stratified', the parameters to
+  be perturbed are drawn a whole population at a time with systematic or
+  stratified resampling, which reduces the variance introduced by resampling.
+  Candidate parameters that are perturbed again because their prior
+  probability density is zero are always sampled independently.
+
+  If the optional argument --checkpoint is given, the state of the controller
+  is checkpointed at the start of every generation and periodically during a
+  generation.  The checkpoint contains the previous generation and its
+  weights, the parameters accepted so far in the current generation and the
+  state of the pseudo random number generator.  A run that resumes from a
+  checkpoint with --resume continues with the generation of the checkpoint,
+  and must be given the same arguments as the interrupted run.  Resuming from
+  a checkpoint at the start of a generation gives the same results as the
+  interrupted run if the helpers and the simulator are deterministic.
 
 Required arguments:
   -N, --population-size=NUM     NUM is the parameter population size
@@ -65,16 +141,47 @@ Required arguments:
   -P, --parameter-names=NAMES   NAMES is comma-separated list of
                                 parameter names
   -S, --simulator=CMD           CMD is simulator command
-  -R, --prior-sampler=CMD       CMD is prior_sampler command
-  -T, --perturber=CMD           CMD is perturber command
-  -I, --prior-pdf=CMD           CMD is prior_pdf command
-  -U, --perturbation-pdf=CMD    CMD is perturbation_pdf command
+  -R, --prior-sampler=CMD       CMD is prior_sampler command (unless --prior
+                                is given)
+  -T, --perturber=CMD           CMD is perturber command (unless
+                                --perturbation-kernel is given)
+  -I, --prior-pdf=CMD           CMD is prior_pdf command (unless --prior is
+                                given)
+  -U, --perturbation-pdf=CMD    CMD is perturbation_pdf command (unless
+                                --perturbation-kernel is given)
 
 ABC SMC controller options:
   -s, --seed=SEED               SEED is the seed for the pseudo random number
                                 generator that is used to sample from the
                                 parameter population (by default, the seed is
                                 derived from the system clock).
+  -H, --helper-jobs=NUM         run up to NUM helpers at the same time in the
+                                background (by default, helpers run one at a
+                                time in the foreground)
+  -K, --batch-helpers           prior_sampler, perturber, prior_pdf and
+                                perturbation_pdf use the batch protocol
+  -X, --perturbation-kernel=SPEC
+                                compute perturbation kernel SPEC in pakman
+                                instead of using perturber and
+                                perturbation_pdf
+  -Z, --kernel-tolerance=TOL    approximate weights of built-in perturbation
+                                kernel with tolerance TOL, where 0 < TOL < 1
+                                (by default, weights are computed exactly)
+  -A, --resampling=SCHEME       sample parameters to be perturbed with SCHEME,
+                                which is 'multinomial' (default), 'systematic'
+                                or 'stratified'
+  -Y, --prior=SPEC              compute prior SPEC in pakman instead of using
+                                prior_sampler and prior_pdf
+
+Checkpoint options:
+  -C, --checkpoint=FILE         write checkpoints of the controller state to
+                                FILE
+  -J, --checkpoint-interval=SECONDS
+                                write a checkpoint every SECONDS seconds
+                                (default is 300)
+  -r, --resume=FILE             resume from checkpoint FILE and keep writing
+                                checkpoints to FILE, unless --checkpoint is
+                                given
 )";
 }
 
@@ -90,6 +197,13 @@ void ABCSMCController::addLongOptions(
     lopts.add({"prior-pdf", required_argument, nullptr, 'I'});
     lopts.add({"perturbation-pdf", required_argument, nullptr, 'U'});
     lopts.add({"seed", required_argument, nullptr, 's'});
+    lopts.add({"helper-jobs", required_argument, nullptr, 'H'});
+    lopts.add({"batch-helpers", no_argument, nullptr, 'K'});
+    lopts.add({"perturbation-kernel", required_argument, nullptr, 'X'});
+    lopts.add({"kernel-tolerance", required_argument, nullptr, 'Z'});
+    lopts.add({"prior", required_argument, nullptr, 'Y'});
+    lopts.add({"resampling", required_argument, nullptr, 'A'});
+    Checkpointer::addLongOptions(lopts);
 }
 
 ABCSMCController* ABCSMCController::makeController(const Arguments& args)
@@ -117,6 +231,47 @@ ABCSMCController::Input ABCSMCController::Input::makeInput(
             parse_unsigned_long_integer(args.optionalArgument("seed"));
     }
 
+    if (args.isOptionalArgumentSet("helper-jobs"))
+    {
+        input_obj.helper_jobs =
+            parse_integer(args.optionalArgument("helper-jobs"));
+
+        if (input_obj.helper_jobs < 0)
+        {
+            std::runtime_error e("--helper-jobs must be nonnegative");
+            throw e;
+        }
+    }
+
+    input_obj.batch_helpers = args.isOptionalArgumentSet("batch-helpers");
+    input_obj.checkpoint = Checkpointer::Input::makeInput(args);
+
+    if (args.isOptionalArgumentSet("perturbation-kernel"))
+        input_obj.perturbation_kernel =
+            args.optionalArgument("perturbation-kernel");
+
+    if (args.isOptionalArgumentSet("prior"))
+        input_obj.prior = args.optionalArgument("prior");
+
+    if (args.isOptionalArgumentSet("resampling"))
+    {
+        std::string scheme = args.optionalArgument("resampling");
+
+        if (scheme == "multinomial")
+            input_obj.resampling = multinomial_resampling;
+        else if (scheme == "systematic")
+            input_obj.resampling = systematic_resampling;
+        else if (scheme == "stratified")
+            input_obj.resampling = stratified_resampling;
+        else
+        {
+            std::string error_msg;
+            error_msg += "Unknown resampling scheme: ";
+            error_msg += scheme;
+            throw std::runtime_error(error_msg);
+        }
+    }
+
     try
     {
         input_obj.population_size =
@@ -130,17 +285,29 @@ ABCSMCController::Input ABCSMCController::Input::makeInput(
         input_obj.simulator =
             parse_command(args.optionalArgument("simulator"));
 
-        input_obj.prior_sampler =
-            parse_command(args.optionalArgument("prior-sampler"));
+        // Helpers are not needed for built-in prior
+        if (input_obj.prior.empty())
+        {
+            input_obj.prior_sampler =
+                parse_command(args.optionalArgument("prior-sampler"));
+
+            input_obj.prior_pdf =
+                parse_command(args.optionalArgument("prior-pdf"));
+        }
 
-        input_obj.perturber =
-            parse_command(args.optionalArgument("perturber"));
+        // Helpers are not needed for built-in perturbation kernel
+        if (input_obj.perturbation_kernel.empty())
+        {
+            input_obj.perturber =
+                parse_command(args.optionalArgument("perturber"));
 
-        input_obj.prior_pdf =
-            parse_command(args.optionalArgument("prior-pdf"));
+            input_obj.perturbation_pdf =
+                parse_command(args.optionalArgument("perturbation-pdf"));
+        }
 
-        input_obj.perturbation_pdf =
-            parse_command(args.optionalArgument("perturbation-pdf"));
+        if (args.isOptionalArgumentSet("kernel-tolerance"))
+            input_obj.kernel_tolerance =
+                std::stod(args.optionalArgument("kernel-tolerance"));
     }
     catch (const std::out_of_range& e)
     {
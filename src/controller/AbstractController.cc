@@ -7,3 +7,8 @@ void AbstractController::assignMaster(std::shared_ptr<AbstractMaster> p_master)
 {
     m_p_master = p_master;
 }
+
+// Register events
+void AbstractController::registerEvents(EventWaiter&) const
+{
+}
@@ -11,6 +11,7 @@ class AbstractMaster;
 class LongOptions;
 class Arguments;
 class Command;
+class EventWaiter;
 
 /** An abstract class for submitting simulation tasks.
  *
@@ -64,6 +65,16 @@ class AbstractController
         /** @return simulator command. */
         virtual Command getSimulator() const = 0;
 
+        /** Register the events that the AbstractController is waiting for.
+         *
+         * Controllers that run helper processes in the background register
+         * them here, so that the event loop wakes up when they make
+         * progress.  By default, this function does nothing.
+         *
+         * @param waiter  EventWaiter to register events with.
+         */
+        virtual void registerEvents(EventWaiter& waiter) const;
+
         /** Interpret string as Controller type.
          *
          * The controller_t enumeration type is defined in common.h.
@@ -0,0 +1,244 @@
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <iterator>
+
+#include <fcntl.h>
+#include <libgen.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "spdlog/spdlog.h"
+
+#include "core/LongOptions.h"
+#include "core/Arguments.h"
+#include "core/OutputStreamHandler.h"
+#include "interface/input.h"
+#include "interface/serialisation.h"
+#include "interface/deserialisation.h"
+
+#include "Checkpointer.h"
+
+// Construct from Input object
+Checkpointer::Checkpointer(const Input& input_obj) :
+    m_checkpoint_file(input_obj.checkpoint_file),
+    m_checkpoint_interval(input_obj.checkpoint_interval),
+    m_resume_file(input_obj.resume_file),
+    m_last_write(std::chrono::steady_clock::now())
+{
+    // When resuming, keep writing checkpoints to the resumed file
+    if (m_checkpoint_file.empty())
+        m_checkpoint_file = m_resume_file;
+}
+
+// Wait for checkpoint that is being written.  The destructor must not throw,
+// so errors are only logged
+Checkpointer::~Checkpointer()
+{
+    if (m_thread.joinable())
+        m_thread.join();
+
+    if (!m_error.empty())
+        spdlog::warn("{}", m_error);
+}
+
+// Returns whether checkpoints are written
+bool Checkpointer::isEnabled() const
+{
+    return !m_checkpoint_file.empty();
+}
+
+// Returns whether a periodic checkpoint is due
+bool Checkpointer::isDue() const
+{
+    return isEnabled() && !m_writing
+        && std::chrono::steady_clock::now() - m_last_write
+            >= m_checkpoint_interval;
+}
+
+// Write checkpoint in the background
+void Checkpointer::write(std::string state)
+{
+    wait();
+
+    // Record offset of output, which must have been written before the
+    // checkpoint refers to it
+    OutputStreamHandler* p_handler = OutputStreamHandler::instance();
+    p_handler->sync();
+
+    std::ostringstream out;
+    serialise_scalar_value("output_offset", p_handler->getOffset(), out);
+    state.insert(0, out.str());
+
+    m_last_write = std::chrono::steady_clock::now();
+    m_writing = true;
+    m_thread = std::thread(&Checkpointer::writeFile, this, std::move(state));
+}
+
+// Wait for checkpoint that is being written
+void Checkpointer::wait()
+{
+    if (m_thread.joinable())
+        m_thread.join();
+
+    if (!m_error.empty())
+    {
+        std::runtime_error e(m_error);
+        m_error.clear();
+        throw e;
+    }
+}
+
+// Returns whether a checkpoint is resumed from
+bool Checkpointer::isResuming() const
+{
+    return !m_resume_file.empty();
+}
+
+// Read checkpoint that is resumed from and resume output
+std::string Checkpointer::readResumeFile() const
+{
+    std::ifstream in(m_resume_file);
+    std::ostringstream sstrm;
+    sstrm << in.rdbuf();
+
+    if (!in)
+    {
+        std::string error_msg;
+        error_msg += "Could not read checkpoint file: ";
+        error_msg += m_resume_file;
+        throw std::runtime_error(error_msg);
+    }
+
+    // Resume output and return Controller state
+    std::istringstream state(sstrm.str());
+    OutputStreamHandler::resume(
+            deserialise_scalar_value<std::uint64_t>("output_offset", state));
+
+    return std::string(std::istreambuf_iterator<char>(state), {});
+}
+
+// Write state to temporary file and rename it to checkpoint file
+void Checkpointer::writeFile(const std::string& state)
+{
+    std::string temp_file = m_checkpoint_file + ".tmp";
+    std::string error_msg;
+    int error_number = 0;
+
+    int fd = open(temp_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1)
+    {
+        error_msg = "open";
+        error_number = errno;
+    }
+
+    // Write whole state, allowing interrupts
+    std::size_t written = 0;
+    while (error_msg.empty() && written < state.size())
+    {
+        ssize_t count = ::write(fd, state.data() + written,
+                state.size() - written);
+
+        if (count == -1 && errno != EINTR)
+        {
+            error_msg = "write";
+            error_number = errno;
+        }
+        else if (count > 0)
+            written += count;
+    }
+
+    // Ensure that the temporary file is on disk before it replaces the
+    // previous checkpoint
+    if (error_msg.empty() && fsync(fd) == -1)
+    {
+        error_msg = "fsync";
+        error_number = errno;
+    }
+
+    if (fd != -1 && close(fd) == -1 && error_msg.empty())
+    {
+        error_msg = "close";
+        error_number = errno;
+    }
+
+    if (error_msg.empty()
+            && rename(temp_file.c_str(), m_checkpoint_file.c_str()) == -1)
+    {
+        error_msg = "rename";
+        error_number = errno;
+    }
+
+    // Ensure that the rename is on disk
+    if (error_msg.empty())
+    {
+        std::vector<char> path(m_checkpoint_file.begin(),
+                m_checkpoint_file.end());
+        path.push_back('\0');
+
+        int dir_fd = open(dirname(path.data()), O_RDONLY | O_DIRECTORY);
+        if (dir_fd == -1 || fsync(dir_fd) == -1)
+        {
+            error_msg = "fsync of directory";
+            error_number = errno;
+        }
+
+        if (dir_fd != -1)
+            close(dir_fd);
+    }
+
+    if (!error_msg.empty())
+    {
+        m_error = "Could not write checkpoint file ";
+        m_error += m_checkpoint_file;
+        m_error += ", ";
+        m_error += error_msg;
+        m_error += " failed: ";
+        m_error += strerror(error_number);
+    }
+
+    m_writing = false;
+}
+
+// Add long command-line options
+void Checkpointer::addLongOptions(LongOptions& lopts)
+{
+    lopts.add({"checkpoint", required_argument, nullptr, 'C'});
+    lopts.add({"checkpoint-interval", required_argument, nullptr, 'J'});
+    lopts.add({"resume", required_argument, nullptr, 'r'});
+}
+
+// Construct Input from Arguments object
+Checkpointer::Input Checkpointer::Input::makeInput(const Arguments& args)
+{
+    Input input_obj;
+
+    if (args.isOptionalArgumentSet("checkpoint"))
+        input_obj.checkpoint_file = args.optionalArgument("checkpoint");
+
+    if (args.isOptionalArgumentSet("checkpoint-interval"))
+    {
+        int seconds =
+            parse_integer(args.optionalArgument("checkpoint-interval"));
+
+        if (seconds < 0)
+        {
+            std::runtime_error e("--checkpoint-interval must be nonnegative");
+            throw e;
+        }
+
+        input_obj.checkpoint_interval = std::chrono::seconds(seconds);
+    }
+
+    if (args.isOptionalArgumentSet("resume"))
+        input_obj.resume_file = args.optionalArgument("resume");
+
+    return input_obj;
+}
@@ -0,0 +1,132 @@
+#ifndef CHECKPOINTER_H
+#define CHECKPOINTER_H
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+class LongOptions;
+class Arguments;
+
+/** A class for writing checkpoints of Controller state.
+ *
+ * Controllers serialise their state to a string (see serialisation.h) and
+ * hand it to the Checkpointer, which writes it to the checkpoint file on a
+ * background thread, so that the event loop does not wait for the disk.  The
+ * state is first written to a temporary file, which is synced and then
+ * renamed to the checkpoint file, so that the checkpoint file always
+ * contains a complete checkpoint, even if Pakman is killed while writing.
+ * The directory is synced after the rename, so that the new checkpoint also
+ * survives a crash of the system.
+ *
+ * Along with the Controller state, the Checkpointer records the offset of
+ * the end of the output, after waiting until the output has been written.
+ * When resuming, the output file is truncated to this offset, so that output
+ * written after the checkpoint is not duplicated (see OutputStreamHandler).
+ *
+ * At most one checkpoint is written at a time.  Periodic checkpoints are
+ * skipped while the previous checkpoint is still being written.  Errors that
+ * occur while writing are thrown by the next call to write() or wait().
+ */
+
+class Checkpointer
+{
+    public:
+
+        // Forward declaration of Input
+        struct Input;
+
+        /** Construct from Input object.
+         *
+         * @param input_obj  Input object.
+         */
+        Checkpointer(const Input& input_obj);
+
+        /** Destructor waits for checkpoint that is being written. */
+        ~Checkpointer();
+
+        /** @return whether checkpoints are written. */
+        bool isEnabled() const;
+
+        /** @return whether a periodic checkpoint is due. */
+        bool isDue() const;
+
+        /** Write checkpoint in the background.
+         *
+         * If a checkpoint is still being written, wait for it first.
+         *
+         * @param state  serialised Controller state.
+         */
+        void write(std::string state);
+
+        /** Wait for checkpoint that is being written, and throw if it could
+         * not be written. */
+        void wait();
+
+        /** @return whether a checkpoint is resumed from. */
+        bool isResuming() const;
+
+        /** Read checkpoint that is resumed from, and resume output at the
+         * offset recorded in the checkpoint.
+         *
+         * @return serialised Controller state.
+         */
+        std::string readResumeFile() const;
+
+        /** Add long command-line options.
+         *
+         * @param lopts  long command-line options that the Checkpointer
+         * needs.
+         */
+        static void addLongOptions(LongOptions& lopts);
+
+        /** Input struct that contains input to Checkpointer constructor. */
+        struct Input
+        {
+            /** Static function to make Input from command-line arguments.
+             *
+             * @param args  command-line arguments.
+             *
+             * @return Input struct made from command-line arguments.
+             */
+            static Input makeInput(const Arguments& args);
+
+            /** File to write checkpoints to, or empty to not write
+             * checkpoints. */
+            std::string checkpoint_file;
+
+            /** Time between periodic checkpoints. */
+            std::chrono::seconds checkpoint_interval{300};
+
+            /** File to resume from, or empty to start from scratch. */
+            std::string resume_file;
+        };
+
+    private:
+
+        // Write state to temporary file and rename it to checkpoint file,
+        // recording any error in m_error.  Runs on m_thread
+        void writeFile(const std::string& state);
+
+        // Checkpoint file
+        std::string m_checkpoint_file;
+
+        // Time between periodic checkpoints
+        std::chrono::seconds m_checkpoint_interval;
+
+        // File to resume from
+        std::string m_resume_file;
+
+        // Time at which last checkpoint was started
+        std::chrono::steady_clock::time_point m_last_write;
+
+        // Thread writing checkpoint, and whether it is still writing
+        std::thread m_thread;
+        std::atomic<bool> m_writing{false};
+
+        // Error that occurred while writing checkpoint
+        std::string m_error;
+};
+
+#endif // CHECKPOINTER_H
@@ -0,0 +1,137 @@
+#include <string>
+#include <memory>
+#include <stdexcept>
+
+#include <assert.h>
+
+#include "spdlog/spdlog.h"
+
+#include "core/Tracer.h"
+#include "system/system_call.h"
+#include "master/ForkedWorkerHandler.h"
+
+#include "HelperPool.h"
+
+// Construct from maximum number of helper processes
+HelperPool::HelperPool(int max_helpers) :
+    m_max_helpers(max_helpers)
+{
+    assert(m_max_helpers >= 0);
+}
+
+// Running helper processes are terminated by the destructor of
+// ForkedWorkerHandler
+HelperPool::~HelperPool() = default;
+
+// Submit request
+int HelperPool::submit(const Command& helper,
+        const std::string& input_string)
+{
+    int id = m_next_id++;
+
+    // If there are no helper processes, run helper command synchronously
+    if (m_max_helpers == 0)
+        m_finished.push({id, system_call(helper, input_string)});
+    else
+        m_queued.push({id, helper, input_string});
+
+    return id;
+}
+
+// Collect finished helper processes and start queued requests
+void HelperPool::poll()
+{
+    // Collect finished helper processes
+    for (auto it = m_running.begin(); it != m_running.end(); )
+    {
+        if (!it->p_handler->isDone())
+        {
+            it++;
+            continue;
+        }
+
+        // Check for nonzero exit status
+        if (it->p_handler->getErrorCode() != 0)
+        {
+            std::string error_msg(it->helper.str());
+            error_msg += " threw an error";
+            std::runtime_error e(error_msg);
+            throw e;
+        }
+
+        Tracer::record(Tracer::helper_event, 'e', it->id);
+        m_finished.push({it->id, it->p_handler->getOutput()});
+        it = m_running.erase(it);
+    }
+
+    // Start queued requests while there are free helper processes
+    while (!m_queued.empty()
+            && static_cast<int>(m_running.size()) < m_max_helpers)
+    {
+        Request& request = m_queued.front();
+
+        spdlog::debug("HelperPool::poll: starting helper {}",
+                request.helper.str());
+        Tracer::record(Tracer::helper_event, 'b', request.id);
+
+        m_running.push_back({request.id, request.helper,
+                std::unique_ptr<ForkedWorkerHandler>(
+                        new ForkedWorkerHandler(request.helper,
+                            request.input_string))});
+        m_queued.pop();
+    }
+}
+
+// Returns whether finished requests queue is empty
+bool HelperPool::finishedEmpty() const
+{
+    return m_finished.empty();
+}
+
+// Returns identifier of front finished request
+int HelperPool::frontFinishedId() const
+{
+    return m_finished.front().id;
+}
+
+// Returns output of front finished request
+const std::string& HelperPool::frontFinishedOutput() const
+{
+    return m_finished.front().output;
+}
+
+// Pop front finished request
+void HelperPool::popFinished()
+{
+    m_finished.pop();
+}
+
+// Returns number of queued and running requests
+int HelperPool::numActive() const
+{
+    return m_queued.size() + m_running.size();
+}
+
+// Returns maximum number of helper processes
+int HelperPool::maxHelpers() const
+{
+    return m_max_helpers;
+}
+
+// Terminate running helper processes and discard all requests
+void HelperPool::flush()
+{
+    while (!m_queued.empty()) m_queued.pop();
+
+    for (const Running& running : m_running)
+        Tracer::record(Tracer::helper_event, 'e', running.id);
+    m_running.clear();
+    while (!m_finished.empty()) m_finished.pop();
+}
+
+// Register read pipes of running helper processes
+void HelperPool::registerEvents(EventWaiter& waiter) const
+{
+    for (const Running& running : m_running)
+        running.p_handler->registerEvents(waiter);
+}
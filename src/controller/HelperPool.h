@@ -0,0 +1,127 @@
+#ifndef HELPERPOOL_H
+#define HELPERPOOL_H
+
+#include <string>
+#include <queue>
+#include <list>
+#include <memory>
+
+#include "core/Command.h"
+
+class ForkedWorkerHandler;
+class EventWaiter;
+
+/** A class for running helper commands without blocking the event loop.
+ *
+ * Controllers rely on helper commands, such as `prior_sampler` and
+ * `perturber`, to generate the input to simulation tasks.  The HelperPool
+ * class runs these helper commands as forked processes (see
+ * ForkedWorkerHandler), so that the Controller does not block the event loop
+ * while waiting for them.  At most a fixed number of helper processes are
+ * running at the same time; additional requests are queued until a helper
+ * process finishes.
+ *
+ * Requests are identified by the integer returned by submit().  Finished
+ * requests are stored in a queue in the order in which they finish, and
+ * should be retrieved with frontFinishedId() and frontFinishedOutput().
+ *
+ * If the maximum number of helper processes is zero, helper commands are run
+ * synchronously by submit(), which then blocks until the helper command has
+ * finished.
+ */
+
+class HelperPool
+{
+    public:
+
+        /** Construct from maximum number of helper processes.
+         *
+         * @param max_helpers  maximum number of helper processes running at
+         * the same time, or zero to run helper commands synchronously.
+         */
+        HelperPool(int max_helpers);
+
+        /** Destructor terminates any running helper processes. */
+        ~HelperPool();
+
+        /** Submit request to run helper command.
+         *
+         * @param helper  helper command.
+         * @param input_string  input string to helper command.
+         *
+         * @return identifier of the request.
+         */
+        int submit(const Command& helper, const std::string& input_string);
+
+        /** Collect finished helper processes and start queued requests. */
+        void poll();
+
+        /** @return whether finished requests queue is empty. */
+        bool finishedEmpty() const;
+
+        /** @return identifier of front finished request. */
+        int frontFinishedId() const;
+
+        /** @return output of front finished request. */
+        const std::string& frontFinishedOutput() const;
+
+        /** Pop front finished request. */
+        void popFinished();
+
+        /** @return number of queued and running requests. */
+        int numActive() const;
+
+        /** @return maximum number of helper processes. */
+        int maxHelpers() const;
+
+        /** Terminate running helper processes and discard all requests. */
+        void flush();
+
+        /** Register read pipes of running helper processes.
+         *
+         * @param waiter  EventWaiter to register events with.
+         */
+        void registerEvents(EventWaiter& waiter) const;
+
+    private:
+
+        // Request to run helper command
+        struct Request
+        {
+            int id;
+            Command helper;
+            std::string input_string;
+        };
+
+        // Running helper process
+        struct Running
+        {
+            int id;
+            Command helper;
+            std::unique_ptr<ForkedWorkerHandler> p_handler;
+        };
+
+        // Output of finished request
+        struct Result
+        {
+            int id;
+            std::string output;
+        };
+
+        // Maximum number of helper processes
+        const int m_max_helpers;
+
+        // Identifier of next request
+        int m_next_id = 0;
+
+        // Queued requests
+        std::queue<Request> m_queued;
+
+        // Running helper processes
+        std::list<Running> m_running;
+
+        // Finished requests
+        std::queue<Result> m_finished;
+};
+
+#endif // HELPERPOOL_H
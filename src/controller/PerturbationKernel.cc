@@ -0,0 +1,437 @@
+#include <string>
+#include <vector>
+#include <random>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+
+#include <assert.h>
+
+#include "core/utils.h"
+#include "interface/NumericPopulation.h"
+#include "interface/numeric_parameter.h"
+
+#include "PerturbationKernel.h"
+
+// Below this number of kernel evaluations, the weight denominators are
+// computed on the calling thread only
+static const long min_evaluations_per_thread = 1L << 16;
+
+// Parse comma-separated list of positive scales, broadcasting a single value
+// to all parameters
+static std::vector<double> parse_scales(const std::string& spec,
+        const std::string& values, int num_parameters)
+{
+    std::vector<double> scales;
+    for (const std::string& token : parse_tokens(values, ","))
+    {
+        double scale = 0.0;
+        try
+        {
+            scale = std::stod(token);
+        }
+        catch (const std::logic_error& e)
+        {
+        }
+
+        if (!(scale > 0.0))
+        {
+            std::string error_msg;
+            error_msg += "Perturbation kernel scales must be positive "
+                "numbers, given specification: ";
+            error_msg += spec;
+            throw std::runtime_error(error_msg);
+        }
+
+        scales.push_back(scale);
+    }
+
+    if (scales.size() == 1)
+        scales.resize(num_parameters, scales.front());
+
+    if (static_cast<int>(scales.size()) != num_parameters)
+    {
+        std::string error_msg;
+        error_msg += "Perturbation kernel must have one scale or one scale "
+            "for every parameter, given specification: ";
+        error_msg += spec;
+        throw std::runtime_error(error_msg);
+    }
+
+    return scales;
+}
+
+// Construct from specification string
+PerturbationKernel::PerturbationKernel(const std::string& spec,
+        int num_parameters, double tolerance) :
+    m_tolerance(tolerance)
+{
+    if (!(m_tolerance >= 0.0 && m_tolerance < 1.0))
+    {
+        std::runtime_error e("Perturbation kernel tolerance must lie in "
+                "[0, 1)");
+        throw e;
+    }
+
+    // Split specification into type, key and values
+    std::size_t colon = spec.find(':');
+    std::size_t equals = spec.find('=');
+    std::string type = spec.substr(0, colon);
+    std::string key = colon == std::string::npos ? "" :
+        spec.substr(colon + 1, equals - colon - 1);
+    std::string values = equals == std::string::npos ? "" :
+        spec.substr(equals + 1);
+
+    if (type == "gaussian" && key == "sigma")
+        m_type = gaussian;
+    else if (type == "uniform" && key == "width")
+        m_type = uniform;
+    else
+    {
+        std::string error_msg;
+        error_msg += "Unknown perturbation kernel specification: ";
+        error_msg += spec;
+        throw std::runtime_error(error_msg);
+    }
+
+    m_scales = parse_scales(spec, values, num_parameters);
+
+    // Compute normalization constant
+    m_normalization = 1.0;
+    for (double scale : m_scales)
+    {
+        switch (m_type)
+        {
+            case gaussian:
+                m_normalization /= std::sqrt(2.0 * M_PI) * scale;
+                break;
+            case uniform:
+                m_normalization /= 2.0 * scale;
+                break;
+        }
+    }
+
+    // Compute width of grid cells, which is the radius outside which the
+    // kernel is dropped
+    if (m_tolerance > 0.0)
+    {
+        switch (m_type)
+        {
+            case gaussian:
+                m_cell_width = std::sqrt(-2.0 * std::log(m_tolerance));
+                break;
+            case uniform:
+                m_cell_width = 1.0;
+                break;
+        }
+    }
+}
+
+// Perturb parameter
+std::vector<double> PerturbationKernel::perturb(
+        const std::vector<double>& source, std::mt19937_64& generator) const
+{
+    check_numeric_parameter(source, m_scales.size());
+
+    std::vector<double> perturbed(source.size());
+    for (int d = 0; d < source.size(); d++)
+    {
+        switch (m_type)
+        {
+            case gaussian:
+                {
+                    std::normal_distribution<double>
+                        distribution(source[d], m_scales[d]);
+                    perturbed[d] = distribution(generator);
+                    break;
+                }
+            case uniform:
+                {
+                    std::uniform_real_distribution<double>
+                        distribution(source[d] - m_scales[d],
+                                source[d] + m_scales[d]);
+                    perturbed[d] = distribution(generator);
+                    break;
+                }
+        }
+    }
+
+    return perturbed;
+}
+
+// Compute probability density of perturbation
+double PerturbationKernel::pdf(const std::vector<double>& source,
+        const std::vector<double>& perturbed) const
+{
+    check_numeric_parameter(source, m_scales.size());
+    check_numeric_parameter(perturbed, m_scales.size());
+
+    double distance = 0.0;
+    for (int d = 0; d < source.size(); d++)
+    {
+        double diff = (perturbed[d] - source[d]) / m_scales[d];
+        switch (m_type)
+        {
+            case gaussian:
+                distance += diff * diff;
+                break;
+            case uniform:
+                distance = std::max(distance, std::fabs(diff));
+                break;
+        }
+    }
+
+    switch (m_type)
+    {
+        case gaussian:
+            return m_normalization * std::exp(-0.5 * distance);
+        case uniform:
+            return distance <= 1.0 ? m_normalization : 0.0;
+    }
+
+    return 0.0;
+}
+
+// Compute denominators of SMC weights
+std::vector<double> PerturbationKernel::weightDenominators(
+        const NumericPopulation& population_old,
+        const std::vector<double>& weights_old,
+        const NumericPopulation& perturbed,
+        int num_threads) const
+{
+    assert(population_old.size() == weights_old.size());
+
+    if (population_old.numParameters() != m_scales.size()
+            || perturbed.numParameters() != m_scales.size())
+    {
+        std::runtime_error e("Numeric populations do not have one value "
+                "for every scale of perturbation kernel");
+        throw e;
+    }
+
+    const int num_old = population_old.size();
+    const int num_perturbed = perturbed.size();
+
+    Population population = makePopulation(population_old, weights_old);
+
+    // Determine number of threads
+    long num_evaluations = static_cast<long>(num_old) * num_perturbed;
+    num_threads = std::min<long>(num_threads,
+            num_evaluations / min_evaluations_per_thread);
+    num_threads = std::max(num_threads, 1);
+
+    // Divide perturbed parameters over threads, where the calling thread
+    // processes the first range
+    std::vector<double> denominators(num_perturbed);
+    std::vector<std::thread> threads;
+    const int chunk = (num_perturbed + num_threads - 1) / num_threads;
+    for (int t = 1; t < num_threads; t++)
+    {
+        int begin = std::min(t * chunk, num_perturbed);
+        int end = std::min(begin + chunk, num_perturbed);
+        threads.emplace_back(&PerturbationKernel::weightDenominatorsRange,
+                this, std::cref(population), std::cref(perturbed),
+                std::ref(denominators), begin, end);
+    }
+
+    weightDenominatorsRange(population, perturbed, denominators, 0,
+            std::min(chunk, num_perturbed));
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    return denominators;
+}
+
+// Build population from previous generation
+PerturbationKernel::Population PerturbationKernel::makePopulation(
+        const NumericPopulation& population_old,
+        const std::vector<double>& weights_old) const
+{
+    const int num_old = population_old.size();
+    const int num_parameters = m_scales.size();
+
+    // Use grid only if the 3^D neighbouring cells of a cell are fewer than the
+    // parameters in the previous population, since otherwise visiting the
+    // neighbouring cells costs more than comparing with every parameter
+    bool use_grid = m_tolerance > 0.0;
+    long num_neighbours = 1;
+    for (int d = 0; use_grid && d < num_parameters; d++)
+    {
+        num_neighbours *= 3;
+        use_grid = num_neighbours < num_old;
+    }
+
+    // Order parameters by grid cell, so that the parameters in every cell
+    // are contiguous
+    std::vector<int> order(num_old);
+    for (int i = 0; i < num_old; i++)
+        order[i] = i;
+
+    std::vector<std::vector<long>> cells;
+    if (use_grid)
+    {
+        std::vector<double> scaled(num_parameters);
+        for (int i = 0; i < num_old; i++)
+        {
+            for (int d = 0; d < num_parameters; d++)
+                scaled[d] = population_old.value(i, d) / m_scales[d];
+            cells.push_back(gridCell(scaled));
+        }
+
+        std::stable_sort(order.begin(), order.end(),
+                [&cells](int a, int b) { return cells[a] < cells[b]; });
+    }
+
+    // Store parameters by column, scaled by the kernel scales, so that the
+    // inner loops run over contiguous arrays
+    Population population;
+    population.columns.assign(num_parameters, std::vector<double>(num_old));
+    population.weights.resize(num_old);
+    for (int d = 0; d < num_parameters; d++)
+    {
+        const std::vector<double>& column = population_old.column(d);
+        for (int k = 0; k < num_old; k++)
+            population.columns[d][k] = column[order[k]] / m_scales[d];
+    }
+
+    for (int k = 0; k < num_old; k++)
+    {
+        population.weights[k] = weights_old[order[k]];
+
+        // Start new cell
+        if (use_grid && (k == 0
+                    || cells[order[k]] != population.cells.back()))
+        {
+            population.cells.push_back(cells[order[k]]);
+            population.offsets.push_back(k);
+        }
+    }
+
+    if (use_grid)
+        population.offsets.push_back(num_old);
+
+    return population;
+}
+
+// Returns grid cell of scaled parameter
+std::vector<long> PerturbationKernel::gridCell(
+        const std::vector<double>& scaled) const
+{
+    std::vector<long> cell(scaled.size());
+    for (int d = 0; d < scaled.size(); d++)
+        cell[d] = static_cast<long>(std::floor(scaled[d] / m_cell_width));
+
+    return cell;
+}
+
+// Compute denominators for perturbed parameters in range [begin, end)
+void PerturbationKernel::weightDenominatorsRange(const Population& population,
+        const NumericPopulation& perturbed,
+        std::vector<double>& denominators, int begin, int end) const
+{
+    const int num_old = population.weights.size();
+    const int num_parameters = m_scales.size();
+
+    std::vector<double> scaled(num_parameters);
+    std::vector<double> distances;
+
+    for (int j = begin; j < end; j++)
+    {
+        for (int d = 0; d < num_parameters; d++)
+            scaled[d] = perturbed.value(j, d) / m_scales[d];
+
+        // Without grid, sum over whole population
+        if (population.cells.empty())
+        {
+            denominators[j] = m_normalization *
+                sumRange(population, scaled, 0, num_old, distances);
+            continue;
+        }
+
+        // Else, sum over the 3^D cells neighbouring the cell of the
+        // perturbed parameter, where offset runs over {-1, 0, 1}^D
+        std::vector<long> cell = gridCell(scaled);
+        std::vector<long> neighbour(num_parameters);
+        std::vector<int> offset(num_parameters, -1);
+        double sum = 0.0;
+        while (true)
+        {
+            for (int d = 0; d < num_parameters; d++)
+                neighbour[d] = cell[d] + offset[d];
+
+            auto it = std::lower_bound(population.cells.begin(),
+                    population.cells.end(), neighbour);
+            if (it != population.cells.end() && *it == neighbour)
+            {
+                int c = it - population.cells.begin();
+                sum += sumRange(population, scaled, population.offsets[c],
+                        population.offsets[c + 1], distances);
+            }
+
+            // Increment offset
+            int d = 0;
+            while (d < num_parameters && offset[d] == 1)
+                offset[d++] = -1;
+            if (d == num_parameters)
+                break;
+            offset[d]++;
+        }
+
+        denominators[j] = m_normalization * sum;
+    }
+}
+
+// Sum weighted kernel densities of parameters in range [begin, end) of
+// population
+double PerturbationKernel::sumRange(const Population& population,
+        const std::vector<double>& scaled, int begin, int end,
+        std::vector<double>& distances) const
+{
+    const int num = end - begin;
+    const double *w = population.weights.data() + begin;
+
+    // Scaled distances between the parameters in range and the perturbed
+    // parameter
+    if (distances.size() < num)
+        distances.resize(num);
+    double *dist = distances.data();
+    std::fill(dist, dist + num, 0.0);
+
+    // Accumulate distances one parameter at a time.  The loops over the
+    // population have no branches, so that the compiler can vectorize them
+    for (int d = 0; d < m_scales.size(); d++)
+    {
+        const double x = scaled[d];
+        const double *col = population.columns[d].data() + begin;
+
+        switch (m_type)
+        {
+            case gaussian:
+                for (int i = 0; i < num; i++)
+                    dist[i] += (col[i] - x) * (col[i] - x);
+                break;
+            case uniform:
+                for (int i = 0; i < num; i++)
+                    dist[i] = std::max(dist[i], std::fabs(col[i] - x));
+                break;
+        }
+    }
+
+    // Sum weighted kernel densities
+    double sum = 0.0;
+    switch (m_type)
+    {
+        case gaussian:
+            for (int i = 0; i < num; i++)
+                sum += w[i] * std::exp(-0.5 * dist[i]);
+            break;
+        case uniform:
+            for (int i = 0; i < num; i++)
+                sum += dist[i] <= 1.0 ? w[i] : 0.0;
+            break;
+    }
+
+    return sum;
+}
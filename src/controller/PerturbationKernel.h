@@ -0,0 +1,147 @@
+#ifndef PERTURBATIONKERNEL_H
+#define PERTURBATIONKERNEL_H
+
+#include <string>
+#include <vector>
+#include <random>
+
+class NumericPopulation;
+
+/** A class for built-in perturbation kernels.
+ *
+ * The PerturbationKernel class implements perturbation kernels for numeric
+ * parameters in-process, so that the ABCSMCController does not need to call
+ * the `perturber` and `perturbation_pdf` executables.  The kernel is
+ * constructed from a specification string of the form `TYPE:KEY=VALUES`,
+ * where VALUES is a comma-separated list that contains either one value for
+ * every parameter, or a single value that applies to all parameters.  The
+ * following kernels are supported:
+ *
+ * - `gaussian:sigma=SIGMAS` perturbs every parameter independently by adding
+ *   normally distributed noise with standard deviation SIGMA.
+ * - `uniform:width=WIDTHS` perturbs every parameter independently by adding
+ *   uniformly distributed noise on the interval [-WIDTH, WIDTH].
+ *
+ * The denominators of the SMC weights, which sum the perturbation kernel over
+ * the whole previous generation for every new parameter, are computed over
+ * contiguous arrays of numeric parameters and spread over several threads.
+ *
+ * If a positive tolerance is given, the previous generation is bucketed into
+ * a grid whose cells are as wide as the effective support of the kernel, and
+ * only parameters in neighbouring cells are summed.  For the uniform kernel
+ * the support is exact, so that the result is unchanged up to rounding.  For
+ * the Gaussian kernel, contributions smaller than the tolerance times the
+ * maximum of the kernel are dropped, so that the absolute error of every
+ * denominator is at most the tolerance times the maximum of the kernel.
+ * Since the number of neighbouring cells grows as 3^D with the number of
+ * parameters D, the grid is only used when there are fewer neighbouring cells
+ * than parameters in the previous generation.
+ */
+
+class PerturbationKernel
+{
+    public:
+
+        /** Construct from specification string.
+         *
+         * @param spec  specification string.
+         * @param num_parameters  number of parameters.
+         * @param tolerance  tolerance for approximate weight denominators,
+         * or zero to compute them exactly.
+         */
+        PerturbationKernel(const std::string& spec, int num_parameters,
+                double tolerance = 0.0);
+
+        /** Perturb parameter.
+         *
+         * @param source  numeric values of source parameter.
+         * @param generator  random number generator.
+         *
+         * @return numeric values of perturbed parameter.
+         */
+        std::vector<double> perturb(const std::vector<double>& source,
+                std::mt19937_64& generator) const;
+
+        /** Compute probability density of perturbation.
+         *
+         * @param source  numeric values of source parameter.
+         * @param perturbed  numeric values of perturbed parameter.
+         *
+         * @return probability density of reaching perturbed parameter by
+         * perturbing source parameter.
+         */
+        double pdf(const std::vector<double>& source,
+                const std::vector<double>& perturbed) const;
+
+        /** Compute denominators of SMC weights.
+         *
+         * For every perturbed parameter j, compute the sum over i of
+         * `weights_old[i] * pdf(population_old.row(i), perturbed.row(j))`.
+         *
+         * @param population_old  numeric values of previous generation.
+         * @param weights_old  normalized weights of previous generation.
+         * @param perturbed  numeric values of perturbed parameters.
+         * @param num_threads  maximum number of threads to use.
+         *
+         * @return denominators of SMC weights of perturbed parameters.
+         */
+        std::vector<double> weightDenominators(
+                const NumericPopulation& population_old,
+                const std::vector<double>& weights_old,
+                const NumericPopulation& perturbed,
+                int num_threads) const;
+
+    private:
+
+        /** Enumerate type for perturbation kernels. */
+        enum kernel_t { gaussian, uniform };
+
+        // Previous generation stored by column and scaled by the kernel
+        // scales, optionally sorted into grid cells
+        struct Population
+        {
+            std::vector<std::vector<double>> columns;
+            std::vector<double> weights;
+
+            // Sorted grid cells, and the range [offsets[c], offsets[c + 1])
+            // of parameters in cell c.  If there are no cells, the grid is
+            // not used
+            std::vector<std::vector<long>> cells;
+            std::vector<int> offsets;
+        };
+
+        // Build population from previous generation
+        Population makePopulation(const NumericPopulation& population_old,
+                const std::vector<double>& weights_old) const;
+
+        // Returns grid cell of scaled parameter
+        std::vector<long> gridCell(const std::vector<double>& scaled) const;
+
+        // Compute denominators for perturbed parameters in range [begin, end)
+        void weightDenominatorsRange(const Population& population,
+                const NumericPopulation& perturbed,
+                std::vector<double>& denominators, int begin, int end) const;
+
+        // Sum weighted kernel densities of parameters in range [begin, end)
+        // of population, using distances as scratch space
+        double sumRange(const Population& population,
+                const std::vector<double>& scaled, int begin, int end,
+                std::vector<double>& distances) const;
+
+        // Kernel type
+        kernel_t m_type;
+
+        // Standard deviations or half-widths, one for every parameter
+        std::vector<double> m_scales;
+
+        // Normalization constant of probability density
+        double m_normalization;
+
+        // Tolerance for approximate weight denominators
+        double m_tolerance;
+
+        // Width of grid cells in scaled units
+        double m_cell_width = 0.0;
+};
+
+#endif // PERTURBATIONKERNEL_H
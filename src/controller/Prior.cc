@@ -0,0 +1,124 @@
+#include <string>
+#include <vector>
+#include <random>
+#include <stdexcept>
+#include <cmath>
+
+#include "core/utils.h"
+#include "interface/numeric_parameter.h"
+
+#include "Prior.h"
+
+// Construct from specification string
+Prior::Prior(const std::string& spec, int num_parameters)
+{
+    for (const std::string& entry : parse_tokens(spec, ";"))
+    {
+        // Split entry into type and arguments
+        std::size_t colon = entry.find(':');
+        std::string type = entry.substr(0, colon);
+        std::vector<std::string> args = colon == std::string::npos ?
+            std::vector<std::string>() :
+            parse_tokens(entry.substr(colon + 1), ",");
+
+        Distribution distribution;
+        bool valid = args.size() == 2;
+
+        if (type == "uniform")
+            distribution.type = uniform;
+        else if (type == "normal")
+            distribution.type = normal;
+        else
+            valid = false;
+
+        // Parse arguments
+        try
+        {
+            if (valid)
+            {
+                distribution.a = std::stod(args[0]);
+                distribution.b = std::stod(args[1]);
+            }
+        }
+        catch (const std::logic_error& e)
+        {
+            valid = false;
+        }
+
+        // Check arguments
+        if (valid && distribution.type == uniform)
+            valid = distribution.a < distribution.b;
+        if (valid && distribution.type == normal)
+            valid = distribution.b > 0.0;
+
+        if (!valid)
+        {
+            std::string error_msg;
+            error_msg += "Invalid prior specification: ";
+            error_msg += entry;
+            throw std::runtime_error(error_msg);
+        }
+
+        m_distributions.push_back(distribution);
+    }
+
+    if (static_cast<int>(m_distributions.size()) != num_parameters)
+    {
+        std::string error_msg;
+        error_msg += "Prior must have one distribution for every parameter, "
+            "given specification: ";
+        error_msg += spec;
+        throw std::runtime_error(error_msg);
+    }
+}
+
+// Sample from prior
+std::vector<double> Prior::sample(std::mt19937_64& generator) const
+{
+    std::vector<double> values;
+    for (const Distribution& distribution : m_distributions)
+    {
+        switch (distribution.type)
+        {
+            case uniform:
+                values.push_back(std::uniform_real_distribution<double>(
+                            distribution.a, distribution.b)(generator));
+                break;
+            case normal:
+                values.push_back(std::normal_distribution<double>(
+                            distribution.a, distribution.b)(generator));
+                break;
+        }
+    }
+
+    return values;
+}
+
+// Compute prior probability density
+double Prior::pdf(const std::vector<double>& values) const
+{
+    check_numeric_parameter(values, m_distributions.size());
+
+    double density = 1.0;
+    for (int d = 0; d < values.size(); d++)
+    {
+        const Distribution& distribution = m_distributions[d];
+        switch (distribution.type)
+        {
+            case uniform:
+                if (values[d] < distribution.a || values[d] > distribution.b)
+                    return 0.0;
+                density /= distribution.b - distribution.a;
+                break;
+            case normal:
+                {
+                    double z = (values[d] - distribution.a) / distribution.b;
+                    density *= std::exp(-0.5 * z * z) /
+                        (std::sqrt(2.0 * M_PI) * distribution.b);
+                    break;
+                }
+        }
+    }
+
+    return density;
+}
@@ -0,0 +1,67 @@
+#ifndef PRIOR_H
+#define PRIOR_H
+
+#include <string>
+#include <vector>
+#include <random>
+
+/** A class for built-in prior distributions.
+ *
+ * The Prior class implements prior distributions of numeric parameters
+ * in-process, so that the ABCSMCController does not need to call the
+ * `prior_sampler` and `prior_pdf` executables.  The parameters are
+ * independent, and the distribution of every parameter is given by a
+ * semicolon-separated specification string of the form
+ * `TYPE:A,B;TYPE:A,B;...`, with one entry for every parameter.  The following
+ * distributions are supported:
+ *
+ * - `uniform:LOW,HIGH` is the uniform distribution on [LOW, HIGH].
+ * - `normal:MEAN,STDEV` is the normal distribution with mean MEAN and
+ *   standard deviation STDEV.
+ */
+
+class Prior
+{
+    public:
+
+        /** Construct from specification string.
+         *
+         * @param spec  specification string.
+         * @param num_parameters  number of parameters.
+         */
+        Prior(const std::string& spec, int num_parameters);
+
+        /** Sample from prior.
+         *
+         * @param generator  random number generator.
+         *
+         * @return numeric values of sampled parameter.
+         */
+        std::vector<double> sample(std::mt19937_64& generator) const;
+
+        /** Compute prior probability density.
+         *
+         * @param values  numeric values of parameter.
+         *
+         * @return prior probability density of parameter.
+         */
+        double pdf(const std::vector<double>& values) const;
+
+    private:
+
+        /** Enumerate type for distributions. */
+        enum distribution_t { uniform, normal };
+
+        // Distribution of a single parameter
+        struct Distribution
+        {
+            distribution_t type;
+            double a;
+            double b;
+        };
+
+        // Distributions of parameters
+        std::vector<Distribution> m_distributions;
+};
+
+#endif // PRIOR_H
@@ -2,34 +2,58 @@
 #include <vector>
 #include <stdexcept>
 #include <iostream>
+#include <sstream>
 
 #include <assert.h>
 
+#include "spdlog/spdlog.h"
+
 #include "core/utils.h"
 #include "core/OutputStreamHandler.h"
 #include "system/system_call.h"
+#include "system/pipe_io.h"
 #include "interface/output.h"
+#include "interface/serialisation.h"
+#include "interface/deserialisation.h"
 #include "interface/protocols.h"
 #include "master/AbstractMaster.h"
+#include "master/EventWaiter.h"
 
 #include "SweepController.h"
 
+// Maximum number of bytes of generator output to read at a time
+static const std::size_t generator_chunk_size = 1 << 16;
+
+// Maximum number of submitted parameters that have not yet been written.  If
+// the parameter at the front takes long to simulate, no further parameters
+// are submitted once this many are waiting to be written
+static const std::size_t max_rows_in_flight = 1 << 16;
+
 SweepController::SweepController(const Input &input_obj) :
     m_parameter_names(input_obj.parameter_names),
-    m_simulator(input_obj.simulator)
+    m_generator(input_obj.generator),
+    m_simulator(input_obj.simulator),
+    m_checkpointer(input_obj.checkpoint)
 {
-    // Read output from generator
-    std::string generator_output = system_call(input_obj.generator);
+    if (m_checkpointer.isResuming())
+        deserialiseState(m_checkpointer.readResumeFile());
 
-    // Decompose into individual parameters
-    m_prmtr_list = parse_generator_output(generator_output);
+    // Start generator, which does not read from stdin
+    int write_fd;
+    std::tie(m_generator_pid, write_fd, m_generator_read_fd) =
+        system_call_non_blocking_read_write(m_generator);
+    close_check(write_fd);
+}
 
-    // Sanity check: at least one parameter should have been generated
-    if (m_prmtr_list.size() == 0)
-    {
-        std::runtime_error e("generator did not output any parameters");
-        throw e;
-    }
+SweepController::~SweepController()
+{
+    // Close pipe if not already closed
+    if (!m_generator_done) close_check(m_generator_read_fd);
+
+    // Terminate generator if it has not yet been waited for.  This function
+    // is called from the destructor, which must not throw.
+    if (m_generator_pid)
+        terminate_process_async(m_generator_pid, m_generator, ignore_error);
 }
 
 void SweepController::iterate()
@@ -38,31 +62,9 @@ void SweepController::iterate()
     assert(!m_entered);
     m_entered = true;
 
-    // If in the first iteration
-    if (m_first_iteration)
-    {
-        // Unset flag
-        m_first_iteration = false;
-
-        // Push all parameters
-        for (auto it = m_prmtr_list.begin(); it != m_prmtr_list.end(); it++)
-        {
-            std::string input(it->str());
-            input += '\n';
-            m_p_master->pushPendingTask(std::move(input));
-        }
-
-        // Return
-        m_entered = false;
-        return;
-    }
-
     // Check if there are any new finished parameters
     while (!m_p_master->finishedTasksEmpty())
     {
-        // Increment counter
-        m_num_finished++;
-
         // Get reference to front finished task
         TaskHandler& task = m_p_master->frontFinishedTask();
 
@@ -74,17 +76,47 @@ void SweepController::iterate()
             throw e;
         }
 
+        // Mark row as finished
+        auto it = m_row_of_task.find(task.getTaskId());
+        assert(it != m_row_of_task.end());
+        Row& row = m_rows[it->second - m_first_row];
+        row.finished = true;
+        row.wall_time = task.getWallTime();
+        row.error_code = task.getErrorCode();
+        m_row_of_task.erase(it);
+
         // Pop finished parameters
         m_p_master->popFinishedTask();
     }
 
-    // If all parameters have finished, then write parameters and terminate
-    // Master
-    if (m_num_finished == m_prmtr_list.size())
+    // Write parameters that have finished in order
+    writeFinishedRows();
+
+    // Submit parameters while the Master needs more pending tasks
+    Parameter parameter;
+    while (needMoreParameters() && nextParameter(parameter))
+    {
+        std::string input(parameter.str());
+        input += '\n';
+        task_id_t task_id = m_p_master->pushPendingTask(std::move(input));
+
+        m_row_of_task[task_id] = m_first_row + m_rows.size();
+        m_rows.push_back({std::move(parameter), false, 0.0, 0});
+    }
+
+    // If generator has finished and all parameters have been written, then
+    // terminate Master
+    if (m_generator_done && m_rows.empty())
     {
-        // Print finished parameters
-        write_parameters(OutputStreamHandler::instance()->getOutputStream(),
-                m_parameter_names, m_prmtr_list);
+        // Sanity check: at least one parameter should have been generated
+        if (m_first_row == 0)
+        {
+            std::runtime_error e("generator did not output any parameters");
+            throw e;
+        }
+
+        // Ensure that the last checkpoint has been written
+        m_checkpointer.wait();
 
         // Terminate Master
         m_p_master->terminate();
@@ -92,6 +124,10 @@ void SweepController::iterate()
         return;
     }
 
+    // Write periodic checkpoint
+    if (m_checkpointer.isDue())
+        m_checkpointer.write(serialiseState());
+
     m_entered = false;
 }
 
@@ -99,3 +135,176 @@ Command SweepController::getSimulator() const
 {
     return m_simulator;
 }
+
+void SweepController::registerEvents(EventWaiter& waiter) const
+{
+    // Wait for output of generator only if it is going to be read, so that
+    // the event loop does not spin while the sweep is throttled
+    if (!m_generator_done && needMoreParameters()
+            && m_generator_buffer.find('\n', m_buffer_pos) == std::string::npos)
+        waiter.addFileDescriptor(m_generator_read_fd);
+}
+
+// Returns true if more parameters should be submitted
+bool SweepController::needMoreParameters() const
+{
+    return m_p_master->needMorePendingTasks()
+        && m_rows.size() < max_rows_in_flight;
+}
+
+// Get next parameter from generator
+bool SweepController::nextParameter(Parameter& parameter)
+{
+    while (true)
+    {
+        // Parse next complete line
+        std::size_t newline = m_generator_buffer.find('\n', m_buffer_pos);
+        if (newline != std::string::npos)
+        {
+            parameter = m_generator_buffer.substr(m_buffer_pos,
+                    newline - m_buffer_pos);
+            m_buffer_pos = newline + 1;
+
+            // Skip parameters that were written before the checkpoint
+            if (m_num_skip > 0)
+            {
+                m_num_skip--;
+                continue;
+            }
+
+            return true;
+        }
+
+        // Discard parsed lines
+        m_generator_buffer.erase(0, m_buffer_pos);
+        m_buffer_pos = 0;
+
+        // Ensure that output ends with newline
+        if (m_generator_done)
+        {
+            if (!m_generator_buffer.empty())
+            {
+                std::string error_msg;
+                error_msg += "Generator output must end with newline, "
+                    "given output: ";
+                error_msg += m_generator_buffer;
+                throw std::runtime_error(error_msg);
+            }
+
+            if (m_num_skip > 0)
+            {
+                std::runtime_error e("generator output fewer parameters "
+                        "than were written before the checkpoint");
+                throw e;
+            }
+
+            return false;
+        }
+
+        // Read more output
+        if (!readGenerator())
+            return false;
+    }
+}
+
+// Read next chunk of generator output
+bool SweepController::readGenerator()
+{
+    std::size_t size = m_generator_buffer.size();
+
+    // If generator closed its stdout, wait on it and check its exit status
+    if (poll_read_from_pipe(m_generator_read_fd, m_generator_buffer,
+                generator_chunk_size))
+    {
+        close_check(m_generator_read_fd);
+        m_generator_done = true;
+
+        pid_t generator_pid = m_generator_pid;
+        m_generator_pid = 0;
+        waitpid_success(generator_pid, 0, m_generator);
+
+        return true;
+    }
+
+    return m_generator_buffer.size() > size;
+}
+
+// Write finished rows at front of queue
+void SweepController::writeFinishedRows()
+{
+    if (m_rows.empty() || !m_rows.front().finished)
+        return;
+
+    std::ostream& ostrm = OutputStreamHandler::instance()->getOutputStream();
+
+    // In binary format, parameters have unit weight and belong to generation
+    // 0.  As in CSV format, the header is omitted when resuming
+    if (g_binary_output)
+    {
+        if (!m_p_binary_writer)
+            m_p_binary_writer.reset(new BinaryResultWriter(ostrm,
+                        m_parameter_names, !m_header_written));
+
+        while (!m_rows.empty() && m_rows.front().finished)
+        {
+            const Row& row = m_rows.front();
+            m_p_binary_writer->addRow(row.parameter, 1.0, 0, row.wall_time,
+                    row.error_code);
+            m_rows.pop_front();
+            m_first_row++;
+        }
+
+        m_p_binary_writer->flush();
+        m_header_written = true;
+        return;
+    }
+
+    // Print header before first parameter
+    if (!m_header_written)
+    {
+        write_parameter_names(ostrm, m_parameter_names);
+        m_header_written = true;
+    }
+
+    // Print finished parameters
+    while (!m_rows.empty() && m_rows.front().finished)
+    {
+        write_parameter(ostrm, m_rows.front().parameter);
+        m_rows.pop_front();
+        m_first_row++;
+    }
+
+    ostrm.flush();
+}
+
+// Serialise state that is needed to resume.  Only the number of written
+// parameters is needed, since the generator is run again when resuming
+std::string SweepController::serialiseState() const
+{
+    std::ostringstream out;
+
+    serialise_scalar_value("controller", std::string("sweep"), out);
+    serialise_scalar_value("m_first_row", m_first_row, out);
+
+    return out.str();
+}
+
+// Restore state from checkpoint
+void SweepController::deserialiseState(const std::string& state)
+{
+    std::istringstream in(state);
+
+    if (deserialise_scalar_value<std::string>("controller", in) != "sweep")
+    {
+        std::runtime_error e("Checkpoint was not written by sweep "
+                "controller");
+        throw e;
+    }
+
+    // The header was written with the first parameter
+    m_first_row = deserialise_scalar_value<long>("m_first_row", in);
+    m_num_skip = m_first_row;
+    m_header_written = m_first_row > 0;
+
+    spdlog::info("Resuming after {} written parameters", m_first_row);
+}
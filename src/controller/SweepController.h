@@ -3,10 +3,18 @@
 
 #include <string>
 #include <vector>
+#include <deque>
+#include <map>
+#include <memory>
 
+#include <unistd.h>
+
+#include "core/TaskHandler.h"
 #include "interface/types.h"
+#include "interface/BinaryResultWriter.h"
 
 #include "AbstractController.h"
+#include "Checkpointer.h"
 
 /** A Controller class implementing a simple parameter sweep algorithm.
  *
@@ -15,6 +23,13 @@
  * The simulator is then called for each of these parameter sets, and the
  * output of the simulator is discarded.
  *
+ * The output of the generator is read incrementally while it runs, and new
+ * tasks are only submitted when the Master needs more pending tasks.
+ * Finished parameters are written as soon as all parameters before them have
+ * finished, so that the output is in the order of the generator.  Hence, the
+ * memory usage is bounded by the number of parameters in flight rather than
+ * by the size of the sweep.
+ *
  * For instructions on how to use Pakman with the sweep controller, execute the
  * following command
  * ```
@@ -35,8 +50,8 @@ class SweepController : public AbstractController
          */
         SweepController(const Input &input_obj);
 
-        /** Default destructor does nothing. */
-        virtual ~SweepController() override = default;
+        /** Destructor terminates generator if it is still running. */
+        virtual ~SweepController() override;
 
         /** Iterates the SweepController.  Should be called by a Master. */
         virtual void iterate() override;
@@ -44,6 +59,12 @@ class SweepController : public AbstractController
         /** @return simulator command. */
         virtual Command getSimulator() const override;
 
+        /** Register output of generator if more parameters are needed.
+         *
+         * @param waiter  EventWaiter to register events with.
+         */
+        virtual void registerEvents(EventWaiter& waiter) const override;
+
         /** @return help message string. */
         static std::string help();
 
@@ -83,28 +104,86 @@ class SweepController : public AbstractController
 
             /** Command to generate parameter sets to simulate. */
             Command generator;
+
+            /** Checkpoint options. */
+            Checkpointer::Input checkpoint;
         };
 
     private:
 
+        // Parameter that has been submitted but not yet written
+        struct Row
+        {
+            Parameter parameter;
+            bool finished;
+            double wall_time;
+            int error_code;
+        };
+
+        // Returns true if more parameters should be submitted
+        bool needMoreParameters() const;
+
+        // Get next parameter from generator.  Returns false if no complete
+        // parameter is available yet or the generator has finished
+        bool nextParameter(Parameter& parameter);
+
+        // Read next chunk of generator output.  Returns false if no data was
+        // available
+        bool readGenerator();
+
+        // Write finished rows at front of queue
+        void writeFinishedRows();
+
+        // Serialise state that is needed to resume
+        std::string serialiseState() const;
+
+        // Restore state from checkpoint
+        void deserialiseState(const std::string& state);
+
         ///// Member variables /////
         // Parameter names
         std::vector<ParameterName> m_parameter_names;
 
-        // Parameter list
-        std::vector<Parameter> m_prmtr_list;
+        // Generator command
+        Command m_generator;
+
+        // Process id and read end of stdout pipe of generator, where
+        // m_generator_pid is zero once the generator has been waited for
+        pid_t m_generator_pid = 0;
+        int m_generator_read_fd;
+
+        // Whether the generator has closed its stdout
+        bool m_generator_done = false;
 
-        // Counter for number of finished parameters
-        int m_num_finished = 0;
+        // Unparsed output of generator, of which the first m_buffer_pos
+        // characters have already been parsed
+        std::string m_generator_buffer;
+        std::size_t m_buffer_pos = 0;
 
-        // At first iteration, SweepController will push all parameters to the
-        // pending queue of the Master.  This flag tells iterate() that it is
-        // in the first iteration.
-        bool m_first_iteration = true;
+        // Submitted parameters in order of the generator, where the front
+        // row has index m_first_row
+        std::deque<Row> m_rows;
+        long m_first_row = 0;
+
+        // Map from task id to row index
+        std::map<task_id_t, long> m_row_of_task;
+
+        // Whether header has been written
+        bool m_header_written = false;
+
+        // Writer of binary output, if output format is binary
+        std::unique_ptr<BinaryResultWriter> m_p_binary_writer;
+
+        // Number of parameters of generator to skip, because they were
+        // written before the checkpoint that is resumed from
+        long m_num_skip = 0;
 
         // Simulator command
         Command m_simulator;
 
+        // Checkpointer
+        Checkpointer m_checkpointer;
+
         // Entered iterate()
         bool m_entered = false;
 };
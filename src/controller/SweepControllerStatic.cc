@@ -19,14 +19,40 @@ Description:
   The sweep method interprets the stdout of 'generator' as newline-separated
   list of parameters and runs 'simulator' on each of them.
 
-  Upon completion, the controller outputs the parameter names, followed by
-  newline-separated list of simulated parameters.
+  The output of 'generator' is read while it runs, and parameters are only
+  submitted as workers become available, so that the sweep starts before
+  'generator' finishes and memory usage does not grow with the size of the
+  sweep.
+
+  The controller outputs the parameter names, followed by newline-separated
+  list of simulated parameters.  Parameters are written as soon as they and
+  all parameters before them have been simulated, in the order in which
+  'generator' output them.
+
+  If the optional argument --checkpoint is given, the number of parameters
+  that have been written is checkpointed periodically.  A run that resumes
+  from a checkpoint with --resume runs 'generator' again, skips the
+  parameters that were written before the checkpoint, and outputs only the
+  remaining parameters, without parameter names.  Hence, 'generator' must
+  output the same parameters every time it is run.  If --output-file is
+  given, the output file is truncated to the output that was written before
+  the checkpoint, and the remaining parameters are appended to it.
 
 Required arguments:
   -P, --parameter-names=NAMES   NAMES is a comma-separated list of
                                 parameter names
   -S, --simulator=CMD           CMD is simulator command
   -G, --generator=CMD           CMD is generator command
+
+Checkpoint options:
+  -C, --checkpoint=FILE         write checkpoints of the controller state to
+                                FILE
+  -J, --checkpoint-interval=SECONDS
+                                write a checkpoint every SECONDS seconds
+                                (default is 300)
+  -r, --resume=FILE             resume from checkpoint FILE and keep writing
+                                checkpoints to FILE, unless --checkpoint is
+                                given
 )";
 }
 
@@ -35,6 +61,7 @@ void SweepController::addLongOptions(LongOptions& lopts)
     lopts.add({"parameter-names", required_argument, nullptr, 'P'});
     lopts.add({"simulator", required_argument, nullptr, 'S'});
     lopts.add({"generator", required_argument, nullptr, 'G'});
+    Checkpointer::addLongOptions(lopts);
 }
 
 SweepController* SweepController::makeController(const Arguments& args)
@@ -54,6 +81,9 @@ SweepController::Input SweepController::Input::makeInput(const Arguments& args)
     // Initialize input
     Input input_obj;
 
+    // Process optional arguments
+    input_obj.checkpoint = Checkpointer::Input::makeInput(args);
+
     try
     {
         input_obj.simulator =
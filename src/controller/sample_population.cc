@@ -1,6 +1,7 @@
 #include <vector>
 #include <random>
 #include <stdexcept>
+#include <algorithm>
 
 #include "sample_population.h"
 
@@ -33,11 +34,53 @@ int sample_population(const std::vector<double>& norm_cumsum_array,
 
     double u = distribution(generator);
 
-    for (int idx = 0; idx < norm_cumsum_array.size(); idx++)
-        if (u <= norm_cumsum_array[idx])
-            return idx;
+    // Binary search for first index with u <= norm_cumsum_array[idx]
+    auto it = std::lower_bound(norm_cumsum_array.begin(),
+            norm_cumsum_array.end(), u);
+
+    if (it != norm_cumsum_array.end())
+        return it - norm_cumsum_array.begin();
 
     // If execution reaches this, something must have gone wrong
     std::runtime_error e("could not sample population");
     throw e;
 }
+
+std::vector<int> resample_population(
+        const std::vector<double>& norm_cumsum_array, int number,
+        resampling_t scheme, std::mt19937_64& generator)
+{
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    std::vector<int> indices(number);
+
+    // Multinomial resampling draws every index independently
+    if (scheme == multinomial_resampling)
+    {
+        for (int k = 0; k < number; k++)
+            indices[k] = sample_population(norm_cumsum_array, distribution,
+                    generator);
+        return indices;
+    }
+
+    // Systematic and stratified resampling place one point in every interval
+    // [k / number, (k + 1) / number), at the same offset for systematic
+    // resampling and at independent offsets for stratified resampling.  Since
+    // the points are increasing, all indices are found in a single pass over
+    // norm_cumsum_array
+    const int last = norm_cumsum_array.size() - 1;
+    double offset = distribution(generator);
+    int idx = 0;
+    for (int k = 0; k < number; k++)
+    {
+        if (scheme == stratified_resampling && k > 0)
+            offset = distribution(generator);
+
+        double u = (k + offset) / number;
+        while (idx < last && norm_cumsum_array[idx] < u)
+            idx++;
+
+        indices[k] = idx;
+    }
+
+    return indices;
+}
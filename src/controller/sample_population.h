@@ -4,11 +4,22 @@
 #include <vector>
 #include <random>
 
+// Schemes for drawing many indices from a population at once
+enum resampling_t
+{
+    multinomial_resampling,
+    systematic_resampling,
+    stratified_resampling
+};
+
 void cumsum(const std::vector<double>& array,
         std::vector<double>& cumsum_array);
 void normalize(std::vector<double>& array);
 int sample_population(const std::vector<double>& norm_cumsum_array,
            std::uniform_real_distribution<double>& distribution,
            std::mt19937_64& generator);
+std::vector<int> resample_population(
+        const std::vector<double>& norm_cumsum_array, int number,
+        resampling_t scheme, std::mt19937_64& generator);
 
 #endif // SAMPLE_POPULATION_H
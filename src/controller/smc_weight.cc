@@ -30,6 +30,14 @@ double smc_weight(const Command& perturbation_pdf,
         get_perturbation_pdf(perturbation_pdf, t, prmtr_perturbed,
                 prmtr_accepted_old);
 
+    // Return weight
+    return smc_weight(prmtr_prior_pdf, weights_old, perturbation_pdf_old);
+}
+
+double smc_weight(const double prmtr_prior_pdf,
+                  const std::vector<double>& weights_old,
+                  const std::vector<double>& perturbation_pdf_old)
+{
     // Compute denominator
     double denominator = 0.0;
 
@@ -13,4 +13,8 @@ double smc_weight(const Command& perturbation_pdf,
                   const std::vector<double>& weights_old,
                   const Parameter& prmtr_perturbed);
 
+double smc_weight(const double prmtr_prior_pdf,
+                  const std::vector<double>& weights_old,
+                  const std::vector<double>& perturbation_pdf_old);
+
 #endif // SMC_WEIGHT_H
@@ -0,0 +1,488 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <stdexcept>
+#include <cmath>
+
+#include <assert.h>
+#include <unistd.h>
+
+#include "core/Command.h"
+#include "interface/types.h"
+#include "interface/NumericPopulation.h"
+
+#include "HelperPool.h"
+#include "PerturbationKernel.h"
+#include "Prior.h"
+#include "sample_population.h"
+#include "smc_weight.h"
+
+std::chrono::milliseconds g_main_timeout(1);
+std::chrono::milliseconds g_kill_timeout(100);
+const char *g_program_name = "controller_test";
+bool g_ignore_errors = false;
+bool g_force_host_spawn = false;
+int g_worker_procs = 1;
+bool g_discard_child_stderr = false;
+bool g_program_terminated = false;
+std::string g_output_file;
+bool g_async_output = false;
+bool g_binary_output = false;
+std::string g_cache_file;
+std::string g_trace_file;
+
+// Poll HelperPool until all requests have finished
+void wait_for_helpers(HelperPool& helpers)
+{
+    while (helpers.numActive() > 0)
+    {
+        helpers.poll();
+        usleep(1000);
+    }
+}
+
+// Compute denominators of SMC weights with smc_weight(), using the
+// perturbation pdf of kernel as the perturbation_pdf helper would
+std::vector<double> smc_weight_denominators(const PerturbationKernel& kernel,
+        const NumericPopulation& population_old,
+        const std::vector<double>& weights_old,
+        const NumericPopulation& perturbed)
+{
+    std::vector<double> denominators;
+    for (int j = 0; j < perturbed.size(); j++)
+    {
+        std::vector<double> perturbation_pdf_old;
+        for (int i = 0; i < population_old.size(); i++)
+            perturbation_pdf_old.push_back(
+                    kernel.pdf(population_old.row(i), perturbed.row(j)));
+
+        denominators.push_back(
+                1.0 / smc_weight(1.0, weights_old, perturbation_pdf_old));
+    }
+
+    return denominators;
+}
+
+// Returns whether values agree within absolute tolerance
+bool all_close(const std::vector<double>& lhs,
+        const std::vector<double>& rhs, double tolerance)
+{
+    if (lhs.size() != rhs.size())
+        return false;
+
+    for (int i = 0; i < lhs.size(); i++)
+        if (!(std::fabs(lhs[i] - rhs[i]) <= tolerance))
+            return false;
+
+    return true;
+}
+
+// Resample population of given weights and return number of times every
+// index was drawn, checking that indices are increasing unless resampling is
+// multinomial
+std::vector<int> resample_counts(std::vector<double> weights, int number,
+        resampling_t scheme, std::mt19937_64& generator)
+{
+    std::vector<double> weights_cumsum(weights.size());
+    normalize(weights);
+    cumsum(weights, weights_cumsum);
+
+    std::vector<int> indices = resample_population(weights_cumsum, number,
+            scheme, generator);
+    assert(indices.size() == number);
+
+    std::vector<int> counts(weights.size(), 0);
+    for (int k = 0; k < number; k++)
+    {
+        assert(indices[k] >= 0 && indices[k] < weights.size());
+        assert(scheme == multinomial_resampling || k == 0
+                || indices[k - 1] <= indices[k]);
+        counts[indices[k]]++;
+    }
+
+    return counts;
+}
+
+int main()
+{
+    ///// Test of HelperPool /////
+
+    // Synchronous helpers finish in submission order
+    {
+        HelperPool helpers(0);
+        assert(helpers.maxHelpers() == 0);
+
+        assert(helpers.submit(Command("cat"), "first\n") == 0);
+        assert(helpers.submit(Command("cat"), "second\n") == 1);
+        assert(helpers.numActive() == 0);
+
+        assert(!helpers.finishedEmpty());
+        assert(helpers.frontFinishedId() == 0);
+        assert(helpers.frontFinishedOutput() == "first\n");
+        helpers.popFinished();
+
+        assert(helpers.frontFinishedId() == 1);
+        assert(helpers.frontFinishedOutput() == "second\n");
+        helpers.popFinished();
+
+        assert(helpers.finishedEmpty());
+    }
+
+    // Background helpers are queued until poll() and finish in completion
+    // order, with at most max_helpers running at the same time
+    {
+        HelperPool helpers(2);
+        helpers.submit(Command("sh -c 'sleep 0.3; cat'"), "slow\n");
+        helpers.submit(Command("cat"), "fast\n");
+        helpers.submit(Command("cat"), "queued\n");
+        assert(helpers.numActive() == 3);
+        assert(helpers.finishedEmpty());
+
+        wait_for_helpers(helpers);
+
+        assert(helpers.frontFinishedId() == 1);
+        assert(helpers.frontFinishedOutput() == "fast\n");
+        helpers.popFinished();
+
+        assert(helpers.frontFinishedId() == 2);
+        assert(helpers.frontFinishedOutput() == "queued\n");
+        helpers.popFinished();
+
+        assert(helpers.frontFinishedId() == 0);
+        assert(helpers.frontFinishedOutput() == "slow\n");
+        helpers.popFinished();
+
+        assert(helpers.finishedEmpty());
+    }
+
+    // Helper that exits with nonzero exit status throws error
+    {
+        HelperPool helpers(1);
+        helpers.submit(Command("false"), "");
+
+        bool error_thrown = false;
+        try
+        {
+            wait_for_helpers(helpers);
+        }
+        catch (const std::runtime_error& e)
+        {
+            assert(std::string(e.what()) == "false threw an error");
+            error_thrown = true;
+        }
+        assert(error_thrown);
+    }
+
+    // Flushing terminates running helpers and discards all requests
+    {
+        HelperPool helpers(1);
+        helpers.submit(Command("cat"), "finished\n");
+        wait_for_helpers(helpers);
+        helpers.submit(Command("sleep 10"), "");
+        helpers.submit(Command("cat"), "queued\n");
+        helpers.poll();
+        assert(helpers.numActive() == 2);
+        assert(!helpers.finishedEmpty());
+
+        auto start = std::chrono::steady_clock::now();
+        helpers.flush();
+        assert(helpers.numActive() == 0);
+        assert(helpers.finishedEmpty());
+        assert(std::chrono::steady_clock::now() - start
+                < std::chrono::seconds(5));
+
+        // Identifiers are not reused after flushing
+        assert(helpers.submit(Command("cat"), "") == 3);
+    }
+
+    ///// Test of PerturbationKernel::weightDenominators() /////
+
+    // Small population with known denominators
+    {
+        NumericPopulation population_old(1);
+        population_old.push_back({0.0});
+        population_old.push_back({1.0});
+        std::vector<double> weights_old = {0.25, 0.75};
+
+        NumericPopulation perturbed(1);
+        perturbed.push_back({0.5});
+        perturbed.push_back({1.5});
+        perturbed.push_back({3.0});
+
+        // Gaussian kernel with sigma = 1
+        auto gaussian = [](double x) {
+            return std::exp(-0.5 * x * x) / std::sqrt(2.0 * M_PI); };
+        std::vector<double> expected = {
+            0.25 * gaussian(0.5) + 0.75 * gaussian(0.5),
+            0.25 * gaussian(1.5) + 0.75 * gaussian(0.5),
+            0.25 * gaussian(3.0) + 0.75 * gaussian(2.0) };
+
+        PerturbationKernel gaussian_kernel("gaussian:sigma=1", 1);
+        assert(all_close(gaussian_kernel.weightDenominators(population_old,
+                        weights_old, perturbed, 1), expected, 1e-15));
+        assert(all_close(smc_weight_denominators(gaussian_kernel,
+                        population_old, weights_old, perturbed),
+                    expected, 1e-15));
+
+        // Uniform kernel on [-1, 1], whose density is 0.5
+        expected = { 0.5, 0.75 * 0.5, 0.0 };
+
+        PerturbationKernel uniform_kernel("uniform:width=1", 1);
+        assert(all_close(uniform_kernel.weightDenominators(population_old,
+                        weights_old, perturbed, 1), expected, 1e-15));
+        assert(all_close(smc_weight_denominators(uniform_kernel,
+                        population_old, weights_old, perturbed),
+                    expected, 1e-15));
+    }
+
+    // Random two-dimensional population, which is large enough for the
+    // approximate denominators to use a grid
+    {
+        std::mt19937_64 generator(1);
+        std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+        NumericPopulation population_old(2);
+        std::vector<double> weights_old;
+        double sum = 0.0;
+        for (int i = 0; i < 500; i++)
+        {
+            population_old.push_back(
+                    {distribution(generator), distribution(generator)});
+            weights_old.push_back(distribution(generator));
+            sum += weights_old.back();
+        }
+        for (double& weight : weights_old)
+            weight /= sum;
+
+        NumericPopulation perturbed(2);
+        for (int j = 0; j < 100; j++)
+            perturbed.push_back(
+                    {distribution(generator), distribution(generator)});
+
+        // Exact Gaussian denominators agree with smc_weight() up to rounding,
+        // for any number of threads
+        PerturbationKernel gaussian("gaussian:sigma=0.05,0.1", 2);
+        std::vector<double> expected = smc_weight_denominators(gaussian,
+                population_old, weights_old, perturbed);
+        for (int num_threads : {1, 3, 8})
+            assert(all_close(gaussian.weightDenominators(population_old,
+                            weights_old, perturbed, num_threads),
+                        expected, 1e-9));
+
+        // Approximate Gaussian denominators are within the tolerance times
+        // the maximum of the kernel
+        double tolerance = 1e-4;
+        PerturbationKernel approximate_gaussian("gaussian:sigma=0.05,0.1",
+                2, tolerance);
+        double max_pdf = gaussian.pdf({0.0, 0.0}, {0.0, 0.0});
+        assert(all_close(approximate_gaussian.weightDenominators(
+                        population_old, weights_old, perturbed, 4),
+                    expected, tolerance * max_pdf));
+
+        // Uniform denominators agree with smc_weight() up to rounding, with
+        // or without a grid
+        PerturbationKernel uniform("uniform:width=0.05,0.1", 2);
+        expected = smc_weight_denominators(uniform, population_old,
+                weights_old, perturbed);
+        assert(all_close(uniform.weightDenominators(population_old,
+                        weights_old, perturbed, 4), expected, 1e-9));
+
+        PerturbationKernel approximate_uniform("uniform:width=0.05,0.1", 2,
+                0.5);
+        assert(all_close(approximate_uniform.weightDenominators(
+                        population_old, weights_old, perturbed, 4),
+                    expected, 1e-9));
+    }
+
+    ///// Test of Prior /////
+
+    // Densities of uniform and normal distributions
+    {
+        Prior uniform("uniform:1,3", 1);
+        assert(uniform.pdf({2.0}) == 0.5);
+        assert(uniform.pdf({1.0}) == 0.5);
+        assert(uniform.pdf({3.0}) == 0.5);
+
+        Prior normal("normal:1,2", 1);
+        double mode = 1.0 / (2.0 * std::sqrt(2.0 * M_PI));
+        assert(std::fabs(normal.pdf({1.0}) - mode) < 1e-15);
+        assert(std::fabs(normal.pdf({3.0}) - mode * std::exp(-0.5)) < 1e-15);
+        assert(std::fabs(normal.pdf({-1.0}) - mode * std::exp(-0.5)) < 1e-15);
+
+        // Parameters are independent, so densities multiply
+        Prior product("uniform:0,4;normal:1,2", 2);
+        assert(std::fabs(product.pdf({1.0, 1.0}) - 0.25 * mode) < 1e-15);
+    }
+
+    // Density is zero outside support of uniform distribution
+    {
+        Prior uniform("uniform:1,3", 1);
+        assert(uniform.pdf({0.999}) == 0.0);
+        assert(uniform.pdf({3.001}) == 0.0);
+
+        Prior product("normal:0,1;uniform:-1,1;normal:0,1", 3);
+        assert(product.pdf({0.0, 2.0, 0.0}) == 0.0);
+        assert(product.pdf({0.0, -1.5, 0.0}) == 0.0);
+        assert(product.pdf({0.0, 0.0, 0.0}) > 0.0);
+    }
+
+    // Samples lie in support and have the right mean
+    {
+        std::mt19937_64 generator(1);
+        Prior prior("uniform:1,3;normal:-5,0.5", 2);
+
+        int num_samples = 10000;
+        double sum_uniform = 0.0;
+        double sum_normal = 0.0;
+        for (int i = 0; i < num_samples; i++)
+        {
+            std::vector<double> values = prior.sample(generator);
+            assert(values.size() == 2);
+            assert(values[0] >= 1.0 && values[0] <= 3.0);
+            assert(std::isfinite(values[1]));
+            assert(prior.pdf(values) > 0.0);
+
+            sum_uniform += values[0];
+            sum_normal += values[1];
+        }
+
+        // Sample means lie within 5 standard errors of the true means
+        assert(std::fabs(sum_uniform / num_samples - 2.0)
+                < 5.0 * (2.0 / std::sqrt(12.0)) / std::sqrt(num_samples));
+        assert(std::fabs(sum_normal / num_samples + 5.0)
+                < 5.0 * 0.5 / std::sqrt(num_samples));
+    }
+
+    // Invalid specifications throw error
+    for (const char *spec : {"uniform:3,1", "uniform:1,1", "normal:0,0",
+            "normal:0", "beta:1,2", "uniform:a,b", "uniform:0,1;normal:0,1"})
+    {
+        bool error_thrown = false;
+        try
+        {
+            Prior prior(spec, 1);
+        }
+        catch (const std::runtime_error& e)
+        {
+            error_thrown = true;
+        }
+        assert(error_thrown);
+    }
+
+    // Parameters with the wrong number of values throw error instead of
+    // being read out of bounds
+    {
+        Prior prior("uniform:0,1;normal:0,1", 2);
+        PerturbationKernel kernel("gaussian:sigma=1", 2);
+        std::mt19937_64 generator(1);
+
+        for (const std::vector<double>& values :
+                {std::vector<double>{0.5}, std::vector<double>{0.5, 0.0, 1.0}})
+        {
+            int errors_thrown = 0;
+            try { prior.pdf(values); }
+            catch (const std::runtime_error& e) { errors_thrown++; }
+            try { kernel.perturb(values, generator); }
+            catch (const std::runtime_error& e) { errors_thrown++; }
+            try { kernel.pdf(values, {0.5, 0.0}); }
+            catch (const std::runtime_error& e) { errors_thrown++; }
+            try { kernel.pdf({0.5, 0.0}, values); }
+            catch (const std::runtime_error& e) { errors_thrown++; }
+            assert(errors_thrown == 4);
+        }
+
+        try
+        {
+            prior.pdf({0.5});
+            assert(false);
+        }
+        catch (const std::runtime_error& e)
+        {
+            assert(std::string(e.what())
+                    == "Numeric parameter 0.5 has 1 values, expected 2");
+        }
+
+        NumericPopulation population(1);
+        population.push_back({0.5});
+        bool error_thrown = false;
+        try
+        {
+            kernel.weightDenominators(population, {1.0}, population, 1);
+        }
+        catch (const std::runtime_error& e)
+        {
+            error_thrown = true;
+        }
+        assert(error_thrown);
+    }
+
+    ///// Test of resample_population() /////
+
+    // Systematic resampling draws every index floor(N * w) or ceil(N * w)
+    // times, and stratified resampling less than two times away from N * w
+    {
+        std::mt19937_64 generator(1);
+        std::vector<double> weights = {0.05, 0.3, 0.0, 0.15, 0.123, 0.377};
+        for (int number : {1, 7, 10, 100, 1000})
+        {
+            for (int trial = 0; trial < 100; trial++)
+            {
+                std::vector<int> counts = resample_counts(weights, number,
+                        systematic_resampling, generator);
+                for (int i = 0; i < weights.size(); i++)
+                {
+                    double expected = number * weights[i];
+                    assert(counts[i] >= std::floor(expected - 1e-9));
+                    assert(counts[i] <= std::ceil(expected + 1e-9));
+                }
+
+                counts = resample_counts(weights, number,
+                        stratified_resampling, generator);
+                for (int i = 0; i < weights.size(); i++)
+                    assert(std::fabs(counts[i] - number * weights[i]) < 2.0);
+            }
+        }
+    }
+
+    // Indices with zero weight are never drawn, and if one weight is one, it
+    // is always drawn
+    {
+        std::mt19937_64 generator(1);
+        for (resampling_t scheme : {multinomial_resampling,
+                systematic_resampling, stratified_resampling})
+        {
+            std::vector<int> counts = resample_counts({0.0, 0.5, 0.0, 0.5,
+                    0.0}, 1000, scheme, generator);
+            assert(counts[0] == 0 && counts[2] == 0 && counts[4] == 0);
+            assert(counts[1] + counts[3] == 1000);
+
+            counts = resample_counts({0.0, 0.0, 1.0, 0.0}, 100, scheme,
+                    generator);
+            assert(counts[2] == 100);
+
+            counts = resample_counts({1.0}, 10, scheme, generator);
+            assert(counts[0] == 10);
+        }
+    }
+
+    // Resampling with a fixed seed is reproducible
+    {
+        std::vector<double> weights_cumsum = {0.1, 0.4, 0.45, 1.0};
+        for (resampling_t scheme : {multinomial_resampling,
+                systematic_resampling, stratified_resampling})
+        {
+            std::mt19937_64 generator1(5);
+            std::mt19937_64 generator2(5);
+            assert(resample_population(weights_cumsum, 50, scheme,
+                        generator1)
+                    == resample_population(weights_cumsum, 50, scheme,
+                        generator2));
+        }
+    }
+
+    std::cout << "All tests passed!\n";
+
+    return 0;
+}
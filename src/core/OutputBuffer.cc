@@ -0,0 +1,224 @@
+#include <iostream>
+#include <streambuf>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include "Tracer.h"
+#include "OutputBuffer.h"
+
+// Construct from file descriptor
+OutputBuffer::OutputBuffer(int fd, bool background, std::size_t capacity) :
+    m_fd(fd),
+    m_buffer(capacity)
+{
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+
+    // Start background thread
+    if (background)
+    {
+        m_spare.resize(capacity);
+        m_running = true;
+        m_thread = std::thread(&OutputBuffer::run, this);
+    }
+}
+
+// Write remaining output.  The destructor must not throw, so errors are only
+// printed
+OutputBuffer::~OutputBuffer()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+// Write all output and stop background thread
+void OutputBuffer::close()
+{
+    handOver();
+
+    if (m_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = false;
+        }
+
+        m_cv.notify_all();
+        m_thread.join();
+
+        throwError();
+    }
+}
+
+// Hand over buffer and wait until background thread has written it
+void OutputBuffer::drain()
+{
+    handOver();
+
+    if (m_thread.joinable())
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        waitForWriter(lock);
+        throwError();
+    }
+}
+
+// Returns number of bytes output to the stream
+std::uint64_t OutputBuffer::offset() const
+{
+    return m_num_handed_over + (pptr() - pbase());
+}
+
+// Hand over full buffer and store character
+OutputBuffer::int_type OutputBuffer::overflow(int_type ch)
+{
+    handOver();
+
+    if (!traits_type::eq_int_type(ch, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(ch);
+}
+
+// Hand over buffer on flush
+int OutputBuffer::sync()
+{
+    handOver();
+    return 0;
+}
+
+// Hand over buffer to be written
+void OutputBuffer::handOver()
+{
+    const std::size_t size = pptr() - pbase();
+
+    const std::int64_t start = Tracer::now();
+
+    if (m_thread.joinable())
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        waitForWriter(lock);
+        if (!m_error.empty())
+        {
+            discard();
+            throwError();
+        }
+
+        // Swap buffers, so that output is collected in the spare buffer while
+        // the background thread writes the full buffer
+        if (size > 0)
+        {
+            m_buffer.swap(m_spare);
+            m_spare_size = size;
+            m_cv.notify_all();
+        }
+    }
+    else if (size > 0)
+    {
+        std::string error = writeBuffer(m_buffer, size);
+        if (!error.empty())
+        {
+            discard();
+            std::runtime_error e(error);
+            throw e;
+        }
+    }
+
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    m_num_handed_over += size;
+
+    if (size > 0)
+        Tracer::recordSpan(Tracer::output_event, 0, start, 0, size);
+}
+
+// Discard output that has not been handed over, so that output that could
+// not be written is not written again and its error is reported only once
+void OutputBuffer::discard()
+{
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+}
+
+// Wait until background thread has written spare buffer
+void OutputBuffer::waitForWriter(std::unique_lock<std::mutex>& lock)
+{
+    m_cv.wait(lock, [this] { return m_spare_size == 0; });
+}
+
+// Throw error that occurred on background thread
+void OutputBuffer::throwError()
+{
+    if (!m_error.empty())
+    {
+        std::runtime_error e(m_error);
+        m_error.clear();
+        throw e;
+    }
+}
+
+// Write buffer to file descriptor, allowing interrupts
+std::string OutputBuffer::writeBuffer(const std::vector<char>& buffer,
+        std::size_t size) const
+{
+    std::size_t written = 0;
+    while (written < size)
+    {
+        ssize_t count = ::write(m_fd, buffer.data() + written,
+                size - written);
+
+        if (count == -1 && errno != EINTR)
+        {
+            std::string error_msg;
+            error_msg += "Could not write output: ";
+            error_msg += strerror(errno);
+            return error_msg;
+        }
+        else if (count > 0)
+            written += count;
+    }
+
+    return std::string();
+}
+
+// Write spare buffers until stopped
+void OutputBuffer::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_cv.wait(lock, [this] { return m_spare_size > 0 || !m_running; });
+
+        // Stop once everything has been written
+        if (m_spare_size == 0)
+            break;
+
+        // The main thread does not touch the spare buffer until
+        // m_spare_size is reset, so it is written without holding the lock
+        const std::size_t size = m_spare_size;
+        lock.unlock();
+        std::string error = writeBuffer(m_spare, size);
+        lock.lock();
+
+        if (!error.empty() && m_error.empty())
+            m_error = error;
+
+        m_spare_size = 0;
+        m_cv.notify_all();
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef OUTPUTBUFFER_H
+#define OUTPUTBUFFER_H
+
+#include <streambuf>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+/** A stream buffer for writing large amounts of output to a file descriptor.
+ *
+ * OutputBuffer collects output in a large buffer and writes it to the file
+ * descriptor only when the buffer is full or when the stream is flushed, so
+ * that writing many short lines costs few system calls and no allocations.
+ *
+ * Optionally, the buffers are written on a background thread.  In that case,
+ * OutputBuffer owns two buffers that are swapped: while the background thread
+ * writes one buffer, output is collected in the other.  Flushing then only
+ * hands the buffer to the background thread, so that flushing after every
+ * batch of results does not block the event loop on the disk.
+ *
+ * Errors that occur while writing are thrown as std::runtime_error from the
+ * stream operation that writes or flushes the next buffer.
+ */
+
+class OutputBuffer : public std::streambuf
+{
+    public:
+
+        /** Construct from file descriptor.
+         *
+         * @param fd  file descriptor to write to.
+         * @param background  whether to write on a background thread.
+         * @param capacity  size of buffer in bytes.
+         */
+        OutputBuffer(int fd, bool background,
+                std::size_t capacity = 1 << 20);
+
+        /** Destructor writes remaining output and waits for the background
+         * thread.  Errors are printed to stderr, since the destructor must
+         * not throw. */
+        virtual ~OutputBuffer() override;
+
+        /** Write all output and wait until it has been written. */
+        void close();
+
+        /** Hand over buffer and wait until all output has been written,
+         * without stopping the background thread. */
+        void drain();
+
+        /** @return number of bytes that have been output to the stream,
+         * including bytes that have not yet been written. */
+        std::uint64_t offset() const;
+
+    protected:
+
+        /** Hand buffer over to be written and store character.
+         *
+         * @param ch  character that did not fit in the buffer.
+         *
+         * @return ch, or EOF on error.
+         */
+        virtual int_type overflow(int_type ch) override;
+
+        /** Hand buffer over to be written.
+         *
+         * @return 0.
+         */
+        virtual int sync() override;
+
+    private:
+
+        // Hand buffer over to be written, swapping it with the spare buffer
+        // if writing on a background thread
+        void handOver();
+
+        // Discard output that has not been handed over
+        void discard();
+
+        // Wait until background thread has written the spare buffer
+        void waitForWriter(std::unique_lock<std::mutex>& lock);
+
+        // Throw error that occurred while writing
+        void throwError();
+
+        // Write whole buffer to file descriptor, returning error message on
+        // error
+        std::string writeBuffer(const std::vector<char>& buffer,
+                std::size_t size) const;
+
+        // Background thread loop
+        void run();
+
+        // File descriptor
+        const int m_fd;
+
+        // Number of bytes handed over to be written
+        std::uint64_t m_num_handed_over = 0;
+
+        // Buffer that output is collected in
+        std::vector<char> m_buffer;
+
+        // Buffer that background thread writes, and number of bytes to write
+        std::vector<char> m_spare;
+        std::size_t m_spare_size = 0;
+
+        // Background thread, and whether it is still running
+        std::thread m_thread;
+        bool m_running = false;
+
+        // Mutex and condition variable guarding m_spare_size, m_running and
+        // m_error
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+
+        // Error that occurred while writing
+        std::string m_error;
+};
+
+#endif // OUTPUTBUFFER_H
@@ -1,5 +1,11 @@
 #include <string>
-#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
 
 #include "core/common.h"
 
@@ -7,6 +13,76 @@
 
 // Initialise OutputStreamHandler's static data member
 OutputStreamHandler* OutputStreamHandler::s_instance = nullptr;
+bool OutputStreamHandler::s_resuming = false;
+std::uint64_t OutputStreamHandler::s_resume_offset = 0;
+
+// Open output file, or return standard output if no filename was given
+static int open_output_file(const std::string& filename)
+{
+    if (filename.empty())
+        return STDOUT_FILENO;
+
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1)
+    {
+        std::string error_msg;
+        error_msg += "Could not open output file ";
+        error_msg += filename;
+        error_msg += ": ";
+        error_msg += strerror(errno);
+        throw std::runtime_error(error_msg);
+    }
+
+    return fd;
+}
+
+// Open output file for appending and truncate it to the given offset, or
+// return standard output if no filename was given
+static int resume_output_file(const std::string& filename,
+        std::uint64_t offset)
+{
+    if (filename.empty())
+        return STDOUT_FILENO;
+
+    std::string error_msg;
+    error_msg += "Could not resume output file ";
+    error_msg += filename;
+    error_msg += ": ";
+
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd == -1)
+    {
+        error_msg += strerror(errno);
+        throw std::runtime_error(error_msg);
+    }
+
+    // The output file must contain the output up to the checkpoint
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1)
+    {
+        error_msg += strerror(errno);
+        close(fd);
+        throw std::runtime_error(error_msg);
+    }
+
+    if (static_cast<std::uint64_t>(file_stat.st_size) < offset)
+    {
+        error_msg += "file is shorter than the output recorded in the "
+            "checkpoint";
+        close(fd);
+        throw std::runtime_error(error_msg);
+    }
+
+    // Discard output written after the checkpoint
+    if (ftruncate(fd, offset) == -1)
+    {
+        error_msg += strerror(errno);
+        close(fd);
+        throw std::runtime_error(error_msg);
+    }
+
+    return fd;
+}
 
 // Return singleton instance
 OutputStreamHandler* OutputStreamHandler::instance()
@@ -17,35 +93,113 @@ OutputStreamHandler* OutputStreamHandler::instance()
     return s_instance;
 }
 
-// Close file if a filename was given
+// Write remaining output and close file if a filename was given
+void OutputStreamHandler::close()
+{
+    if (!s_instance || s_instance->m_closed)
+        return;
+
+    OutputStreamHandler *p_instance = s_instance;
+    p_instance->m_closed = true;
+    try
+    {
+        p_instance->m_output_stream.flush();
+        p_instance->m_buffer.close();
+    }
+    catch (const std::exception& e)
+    {
+        if (!p_instance->m_filename.empty())
+            ::close(p_instance->m_fd);
+        throw;
+    }
+
+    if (!p_instance->m_filename.empty() && ::close(p_instance->m_fd) == -1)
+    {
+        std::string error_msg;
+        error_msg += "Could not close output file ";
+        error_msg += p_instance->m_filename;
+        error_msg += ": ";
+        error_msg += strerror(errno);
+        throw std::runtime_error(error_msg);
+    }
+}
+
+// Destroy instance
 void OutputStreamHandler::destroy()
 {
     if (s_instance)
     {
-        delete s_instance;
+        OutputStreamHandler *p_instance = s_instance;
         s_instance = nullptr;
+        delete p_instance;
+    }
+}
+
+// Resume output at offset
+void OutputStreamHandler::resume(std::uint64_t offset)
+{
+    if (s_instance)
+    {
+        std::runtime_error e("Output cannot be resumed after it has been "
+                "opened");
+        throw e;
     }
+
+    s_resuming = true;
+    s_resume_offset = offset;
 }
 
 // Return reference to output stream
 std::ostream& OutputStreamHandler::getOutputStream()
 {
-    return *m_p_output_stream;
+    return m_output_stream;
+}
+
+// Flush output stream and wait until all output has been written
+void OutputStreamHandler::sync()
+{
+    m_output_stream.flush();
+    m_buffer.drain();
+}
+
+// Returns offset of end of output
+std::uint64_t OutputStreamHandler::getOffset() const
+{
+    return m_initial_offset + m_buffer.offset();
 }
 
 // Private default constructor
-OutputStreamHandler::OutputStreamHandler(const std::string& filename)
-    : m_filename(filename)
+OutputStreamHandler::OutputStreamHandler(const std::string& filename) :
+    m_filename(filename),
+    m_fd(s_resuming ? resume_output_file(filename, s_resume_offset)
+            : open_output_file(filename)),
+    m_initial_offset(s_resuming ? s_resume_offset : 0),
+    m_buffer(m_fd, g_async_output),
+    m_output_stream(&m_buffer)
 {
-    // Make output file if a filename was given (default is &std::cout)
-    if (!m_filename.empty())
-        m_p_output_stream = new std::ofstream(filename);
+    // Rethrow errors of the OutputBuffer instead of only setting badbit
+    m_output_stream.exceptions(std::ios::badbit);
 }
 
 // Private destructor
 OutputStreamHandler::~OutputStreamHandler()
 {
+    // Nothing to do if output was closed with close()
+    if (m_closed)
+        return;
+
+    // Write remaining output, printing any error since the destructor must
+    // not throw
+    try
+    {
+        m_buffer.close();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+
     // Close output file if a filename was given
     if (!m_filename.empty())
-        delete m_p_output_stream;
+        ::close(m_fd);
 }
@@ -3,6 +3,9 @@
 
 #include <iostream>
 #include <string>
+#include <cstdint>
+
+#include "OutputBuffer.h"
 
 /** A singleton class providing access to the Pakman output stream.
  *
@@ -10,6 +13,17 @@
  * stream.  By default, the output stream is the standard output.  However,
  * this default behaviour can be overriden by specifying an output file using
  * the command-line option `--output-file`.
+ *
+ * The output stream writes through an OutputBuffer, so output reaches the
+ * file only when the stream is flushed or the buffer is full.  If the
+ * command-line option `--async-output` is given, the buffers are written on
+ * a background thread.  Errors that occur while writing are thrown as
+ * std::runtime_error.
+ *
+ * When resuming from a checkpoint, the output file is not truncated to zero
+ * length, but to the offset that was recorded in the checkpoint, and new
+ * output is appended to it.  This discards output that was written after the
+ * checkpoint, which the resumed run writes again.
  */
 
 class OutputStreamHandler
@@ -19,12 +33,31 @@ class OutputStreamHandler
         /** @return singleton instance. */
         static OutputStreamHandler* instance();
 
-        /** Close file if a filename was given. */
+        /** Write remaining output and close file if a filename was given,
+         * throwing an error if the output could not be written.  Does
+         * nothing if there is no instance. */
+        static void close();
+
+        /** Close file if a filename was given, printing any error. */
         static void destroy();
 
+        /** Resume output at the given offset.  Must be called before the
+         * singleton instance is created.
+         *
+         * @param offset  offset recorded in checkpoint.
+         */
+        static void resume(std::uint64_t offset);
+
         /** @return reference to output stream.*/
         std::ostream& getOutputStream();
 
+        /** Flush output stream and wait until all output has been
+         * written. */
+        void sync();
+
+        /** @return offset of end of output in output file. */
+        std::uint64_t getOffset() const;
+
     private:
 
         // Private default constructor
@@ -33,14 +66,30 @@ class OutputStreamHandler
         // Private destructor
         ~OutputStreamHandler();
 
-        // Output stream
-        std::ostream *m_p_output_stream = &std::cout;
-
         // Filename
         std::string m_filename;
 
+        // File descriptor of output file or standard output
+        int m_fd;
+
+        // Offset at which output started
+        std::uint64_t m_initial_offset;
+
+        // Whether output has been closed
+        bool m_closed = false;
+
+        // Buffer of output stream
+        OutputBuffer m_buffer;
+
+        // Output stream
+        std::ostream m_output_stream;
+
         // Static instance
         static OutputStreamHandler* s_instance;
+
+        // Whether to resume output, and offset to resume at
+        static bool s_resuming;
+        static std::uint64_t s_resume_offset;
 };
 
 #endif // OUTPUTSTREAMHANDLER_H
@@ -1,18 +1,27 @@
 #include "TaskHandler.h"
+#include <cassert>
 
-// Construct from input string
-TaskHandler::TaskHandler(const std::string& input_string) :
-    m_input_string(input_string)
+// Construct from input string and task identifier
+TaskHandler::TaskHandler(std::string input_string, task_id_t task_id) :
+    m_task_id(task_id),
+    m_p_input_string(std::make_shared<const std::string>(
+                std::move(input_string)))
 {
 }
 
-// Move constructor
-TaskHandler::TaskHandler(TaskHandler &&t) :
-    m_input_string(std::move(t.m_input_string)),
-    m_output_string(std::move(t.m_output_string)),
-    m_error_code(t.m_error_code),
-    m_state(t.m_state)
+// Construct from shared input buffer and task identifier
+TaskHandler::TaskHandler(std::shared_ptr<const std::string> p_input_string,
+        task_id_t task_id) :
+    m_task_id(task_id),
+    m_p_input_string(std::move(p_input_string))
 {
+    assert(m_p_input_string);
+}
+
+// Get task identifier
+task_id_t TaskHandler::getTaskId() const
+{
+    return m_task_id;
 }
 
 // Get state
@@ -43,14 +52,20 @@ bool TaskHandler::didErrorOccur() const
 }
 
 // Get input string
-std::string TaskHandler::getInputString() const
+const std::string& TaskHandler::getInputString() const
 {
     // Return input string
-    return m_input_string;
+    return *m_p_input_string;
+}
+
+// Get shared input buffer
+std::shared_ptr<const std::string> TaskHandler::getInputBuffer() const
+{
+    return m_p_input_string;
 }
 
 // Get output string
-std::string TaskHandler::getOutputString() const
+const std::string& TaskHandler::getOutputString() const
 {
     // Return output string
     return m_output_string;
@@ -63,15 +78,22 @@ int TaskHandler::getErrorCode() const
     return m_error_code;
 }
 
+// Get wall time
+double TaskHandler::getWallTime() const
+{
+    return m_wall_time;
+}
+
 // Record output
-void TaskHandler::recordOutputAndErrorCode(const std::string& output_string,
-        int error_code)
+void TaskHandler::recordOutputAndErrorCode(std::string output_string,
+        int error_code, double wall_time)
 {
     // This should only be called in the pending state
     assert(m_state == pending);
 
-    // Record output string, error code and set state to finished
-    m_output_string.assign(output_string);
+    // Record output string, error code, wall time and set state to finished
+    m_output_string = std::move(output_string);
     m_error_code = error_code;
+    m_wall_time = wall_time;
     m_state = finished;
 }
@@ -2,11 +2,26 @@
 #define TASKHANDLER_H
 
 #include <string>
+#include <memory>
+
+/** Type of task identifiers. */
+typedef unsigned long task_id_t;
 
 /** A class for representing tasks.
  *
  * A task represents a simulation job, which consists of spawning a
  * simulator, feeding it some input and retrieving the output.
+ *
+ * Every task carries an identifier that is assigned by the Master when the
+ * task is pushed.  Since Masters may finish tasks in a different order than
+ * they were pushed, Controllers can use the identifier to associate finished
+ * tasks with their own bookkeeping.
+ *
+ * TaskHandler is move-only, so that tasks are moved rather than copied
+ * between the pending, busy and finished queues of the Masters.  The input
+ * string is held in a reference-counted immutable buffer that can be shared
+ * with other objects without copying it, and the accessors return references
+ * rather than copies.
  */
 class TaskHandler
 {
@@ -15,18 +30,40 @@ class TaskHandler
         /** Enumeration type for TaskHandler states. */
         enum state_t { pending, finished };
 
-        /** Construct from input string.
+        /** Construct from input string and task identifier.
          *
-         * @param input_string  input string to simulator.
+         * @param input_string  input string to simulator, which is moved
+         * into the shared input buffer.
+         * @param task_id  identifier of task.
          */
-        TaskHandler(const std::string& input_string);
+        TaskHandler(std::string input_string, task_id_t task_id = 0);
+
+        /** Construct from shared input buffer and task identifier.
+         *
+         * @param p_input_string  shared input string to simulator.
+         * @param task_id  identifier of task.
+         */
+        TaskHandler(std::shared_ptr<const std::string> p_input_string,
+                task_id_t task_id = 0);
+
+        /** Default move constructor. */
+        TaskHandler(TaskHandler&& t) = default;
 
-        /** Move constructor. */
-        TaskHandler(TaskHandler &&t);
+        /** Default move-assignment operator. */
+        TaskHandler& operator=(TaskHandler&& t) = default;
+
+        /** TaskHandler is not copyable. */
+        TaskHandler(const TaskHandler& t) = delete;
+
+        /** TaskHandler is not copy-assignable. */
+        TaskHandler& operator=(const TaskHandler& t) = delete;
 
         /** Default destructor does nothing. */
         ~TaskHandler() = default;
 
+        /** @return identifier of task. */
+        task_id_t getTaskId() const;
+
         /** @return state of TaskHandler. */
         state_t getState() const;
 
@@ -42,35 +79,49 @@ class TaskHandler
         /** @return error code that simulation job returned. */
         int getErrorCode() const;
 
-        /** @return input string. */
-        std::string getInputString() const;
+        /** @return reference to input string. */
+        const std::string& getInputString() const;
+
+        /** @return shared input buffer. */
+        std::shared_ptr<const std::string> getInputBuffer() const;
 
-        /** @return output string. */
-        std::string getOutputString() const;
+        /** @return reference to output string. */
+        const std::string& getOutputString() const;
+
+        /** @return wall time in seconds that the simulation job took. */
+        double getWallTime() const;
 
         /** Record output and error code.
          *
          * @param output_string  the output string that the simulation
-         * job returned.
+         * job returned, which is moved into the TaskHandler.
          * @param error_code the error code that the simulation job
          * returned.
+         * @param wall_time  wall time in seconds that the simulation job
+         * took, which is zero if no simulation was run.
          */
-        void recordOutputAndErrorCode(const std::string& output_string,
-                int error_code);
+        void recordOutputAndErrorCode(std::string output_string,
+                int error_code, double wall_time = 0.0);
 
     private:
 
         // Initial state is pending
         state_t m_state = pending;
 
-        // Input string
-        const std::string m_input_string;
+        // Task identifier
+        task_id_t m_task_id;
+
+        // Shared input string
+        std::shared_ptr<const std::string> m_p_input_string;
 
         // Output string, only valid in finished state
         std::string m_output_string;
 
         // Error code, only valid in finished state
         int m_error_code = -1;
+
+        // Wall time of simulation, only valid in finished state
+        double m_wall_time = 0.0;
 };
 
 #endif // TASKHANDLER_H
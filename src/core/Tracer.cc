@@ -0,0 +1,229 @@
+#include <string>
+#include <vector>
+#include <set>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <cstdint>
+
+#include "Tracer.h"
+
+// Initial capacity of event buffer
+static const std::size_t initial_capacity = 1 << 16;
+
+// Names and categories of events, indexed by event type
+static const char *event_names[Tracer::num_events] =
+{
+    "task", "dispatch", "receive", "spawn", "simulate", "system_call",
+    "helper", "flush", "write output"
+};
+
+static const char *event_categories[Tracer::num_events] =
+{
+    "task", "task", "task", "worker", "worker", "helper", "helper", "flush",
+    "output"
+};
+
+// Static member variables
+bool Tracer::s_enabled = false;
+std::chrono::steady_clock::time_point Tracer::s_origin;
+std::vector<Tracer::Event> Tracer::s_events;
+
+// Enable tracing
+void Tracer::enable()
+{
+    s_enabled = true;
+    s_events.reserve(initial_capacity);
+    setOrigin();
+}
+
+// Returns whether tracing is enabled
+bool Tracer::isEnabled()
+{
+    return s_enabled;
+}
+
+// Set origin of timestamps
+void Tracer::setOrigin()
+{
+    s_origin = std::chrono::steady_clock::now();
+}
+
+// Returns nanoseconds since origin
+std::int64_t Tracer::timestamp(std::chrono::steady_clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            time - s_origin).count();
+}
+
+// Returns nanoseconds since origin of current time
+std::int64_t Tracer::now()
+{
+    return timestamp(std::chrono::steady_clock::now());
+}
+
+// Record instant event or step of task or helper lifetime
+void Tracer::record(event_t type, char phase, std::uint64_t id,
+        std::int64_t value)
+{
+    if (!s_enabled)
+        return;
+
+    s_events.push_back({type, phase, 0, id, value, now(), 0});
+}
+
+// Record span that ends now
+void Tracer::recordSpan(event_t type, int lane, std::int64_t start,
+        std::uint64_t id, std::int64_t value)
+{
+    if (!s_enabled)
+        return;
+
+    s_events.push_back({type, 'X', lane, id, value, start, now() - start});
+}
+
+// Returns events recorded by this process
+const std::vector<Tracer::Event>& Tracer::events()
+{
+    return s_events;
+}
+
+// Write arguments of event
+static void write_args(std::ostream& out, const Tracer::Event& event)
+{
+    switch (event.type)
+    {
+        case Tracer::task_event:
+        case Tracer::receive_event:
+        case Tracer::spawn_event:
+        case Tracer::simulate_event:
+            out << "{\"task\":" << event.id << '}';
+            break;
+
+        case Tracer::dispatch_event:
+            out << "{\"task\":" << event.id << ",\"target\":" << event.value
+                << '}';
+            break;
+
+        case Tracer::helper_event:
+            out << "{\"request\":" << event.id << '}';
+            break;
+
+        case Tracer::flush_event:
+            out << "{\"tasks\":" << event.value << '}';
+            break;
+
+        case Tracer::output_event:
+            out << "{\"bytes\":" << event.value << '}';
+            break;
+
+        default:
+            out << "{}";
+    }
+}
+
+// Write events in Chrome trace event format
+void Tracer::write(const std::string& filename,
+        const std::vector<std::vector<Event>>& events_per_rank)
+{
+    std::ofstream out(filename);
+    if (!out)
+    {
+        std::string error_msg;
+        error_msg += "Could not open trace file ";
+        error_msg += filename;
+        std::runtime_error e(error_msg);
+        throw e;
+    }
+
+    // Timestamps are given in microseconds
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    auto separator = [&out, &first] ()
+    {
+        if (!first)
+            out << ",\n";
+        first = false;
+    };
+
+    for (std::size_t rank = 0; rank < events_per_rank.size(); rank++)
+    {
+        // Name process and lanes
+        separator();
+        out << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << rank
+            << ",\"args\":{\"name\":\"rank " << rank << "\"}}";
+
+        std::set<int> lanes = {0};
+        for (const Event& event : events_per_rank[rank])
+            lanes.insert(event.lane);
+
+        for (int lane : lanes)
+        {
+            separator();
+            out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << rank
+                << ",\"tid\":" << lane << ",\"args\":{\"name\":\"";
+            if (lane == 0)
+                out << "event loop";
+            else
+                out << "slot " << lane - 1;
+            out << "\"}}";
+        }
+
+        // Write events
+        for (const Event& event : events_per_rank[rank])
+        {
+            separator();
+            out << "{\"name\":\"" << event_names[event.type]
+                << "\",\"cat\":\"" << event_categories[event.type]
+                << "\",\"ph\":\"" << event.phase
+                << "\",\"pid\":" << rank
+                << ",\"tid\":" << event.lane
+                << ",\"ts\":" << event.start / 1000.0;
+
+            if (event.phase == 'X')
+                out << ",\"dur\":" << event.duration / 1000.0;
+            else if (event.phase == 'i')
+                out << ",\"s\":\"t\"";
+            else
+                out << ",\"id\":" << event.id;
+
+            out << ",\"args\":";
+            write_args(out, event);
+            out << '}';
+        }
+    }
+
+    out << "\n]}\n";
+
+    if (!out)
+    {
+        std::string error_msg;
+        error_msg += "Could not write trace file ";
+        error_msg += filename;
+        std::runtime_error e(error_msg);
+        throw e;
+    }
+}
+
+// Start span
+Tracer::Span::Span(event_t type, std::uint64_t id) :
+    m_type(type),
+    m_id(id),
+    m_start(s_enabled ? now() : 0)
+{
+}
+
+// Record span
+Tracer::Span::~Span()
+{
+    recordSpan(m_type, 0, m_start, m_id, m_value);
+}
+
+// Set event-specific value
+void Tracer::Span::setValue(std::int64_t value)
+{
+    m_value = value;
+}
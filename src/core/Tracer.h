@@ -0,0 +1,171 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+/** A class for recording a trace of the lifecycle of tasks.
+ *
+ * If the command-line option `--trace` is given, Pakman records a timestamp
+ * whenever a task is pushed, dispatched to a Manager, started on a Worker
+ * slot, finished, received by the Master and consumed by the Controller, as
+ * well as spans for helper commands, flushes and output writes.  At the end
+ * of the run, the events are written in the Chrome trace event format, which
+ * can be viewed with chrome://tracing or Perfetto.
+ *
+ * Every process records events into its own buffer.  Events are only
+ * recorded by the thread running the event loop, so the buffer needs no
+ * lock, and recording an event costs a clock read and an append.  With the
+ * MPI master, the buffers of all ranks are gathered on rank 0 at shutdown.
+ *
+ * Timestamps are taken from the monotonic clock and are relative to the
+ * origin set by setOrigin().  The MPI master sets the origin on every rank
+ * right after a barrier, so that the timelines of the ranks are aligned up to
+ * the latency of the barrier.
+ *
+ * When tracing is disabled, every recording function returns immediately.
+ */
+
+class Tracer
+{
+    public:
+
+        /** Enumeration type for events. */
+        enum event_t
+        {
+            task_event,
+            dispatch_event,
+            receive_event,
+            spawn_event,
+            simulate_event,
+            system_call_event,
+            helper_event,
+            flush_event,
+            output_event,
+            num_events
+        };
+
+        /** Event in the buffer of a process. */
+        struct Event
+        {
+            /** Type of event. */
+            std::int32_t type;
+
+            /** Phase in Chrome trace event format. */
+            char phase;
+
+            /** Lane of event, which is 0 for the event loop and 1 + slot
+             * for Worker slots. */
+            std::int32_t lane;
+
+            /** Task or request identifier. */
+            std::uint64_t id;
+
+            /** Event-specific value, such as a rank or a number of bytes. */
+            std::int64_t value;
+
+            /** Start time and duration in nanoseconds. */
+            std::int64_t start;
+            std::int64_t duration;
+        };
+
+        /** Enable tracing and set origin to current time. */
+        static void enable();
+
+        /** @return whether tracing is enabled. */
+        static bool isEnabled();
+
+        /** Set origin of timestamps to current time. */
+        static void setOrigin();
+
+        /** @param time  point in time of monotonic clock.
+         *
+         * @return nanoseconds since origin.
+         */
+        static std::int64_t timestamp(std::chrono::steady_clock::time_point
+                time);
+
+        /** @return nanoseconds since origin. */
+        static std::int64_t now();
+
+        /** Record instant event, or step of task or helper lifetime.
+         *
+         * @param type  type of event.
+         * @param phase  phase in Chrome trace event format.
+         * @param id  task or request identifier.
+         * @param value  event-specific value.
+         */
+        static void record(event_t type, char phase, std::uint64_t id,
+                std::int64_t value = 0);
+
+        /** Record span that started at the given time and ends now.
+         *
+         * @param type  type of event.
+         * @param lane  lane of event.
+         * @param start  start time in nanoseconds since origin.
+         * @param id  task or request identifier.
+         * @param value  event-specific value.
+         */
+        static void recordSpan(event_t type, int lane, std::int64_t start,
+                std::uint64_t id = 0, std::int64_t value = 0);
+
+        /** @return events recorded by this process. */
+        static const std::vector<Event>& events();
+
+        /** Write events in Chrome trace event format.
+         *
+         * @param filename  path to trace file.
+         * @param events_per_rank  events recorded by every rank.
+         */
+        static void write(const std::string& filename,
+                const std::vector<std::vector<Event>>& events_per_rank);
+
+        /** A class for recording a span of the event loop from construction
+         * to destruction. */
+        class Span
+        {
+            public:
+
+                /** Start span.
+                 *
+                 * @param type  type of event.
+                 * @param id  task or request identifier.
+                 */
+                Span(event_t type, std::uint64_t id = 0);
+
+                /** Record span. */
+                ~Span();
+
+                /** @param value  event-specific value of span. */
+                void setValue(std::int64_t value);
+
+            private:
+
+                // Type of event
+                event_t m_type;
+
+                // Task or request identifier
+                std::uint64_t m_id;
+
+                // Event-specific value
+                std::int64_t m_value = 0;
+
+                // Start time
+                std::int64_t m_start;
+        };
+
+    private:
+
+        // Whether tracing is enabled
+        static bool s_enabled;
+
+        // Origin of timestamps
+        static std::chrono::steady_clock::time_point s_origin;
+
+        // Events recorded by this process
+        static std::vector<Event> s_events;
+};
+
+#endif // TRACER_H
@@ -18,6 +18,9 @@ extern std::chrono::milliseconds g_kill_timeout;
 /** Global flag for forcing MPI Worker to spawn on same host as its Manager. */
 extern bool g_force_host_spawn;
 
+/** Global variable containing number of MPI processes of every MPI Worker. */
+extern int g_worker_procs;
+
 /** Global flag for ignoring errors from simulator. */
 extern bool g_ignore_errors;
 
@@ -33,11 +36,25 @@ extern const char *g_program_name;
 /** Global variable containing name of output file if given. */
 extern std::string g_output_file;
 
+/** Global flag for writing output on a background thread. */
+extern bool g_async_output;
+
+/** Global flag for writing output in the binary columnar format instead of
+ * CSV. */
+extern bool g_binary_output;
+
+/** Global variable containing name of simulation cache file if given. */
+extern std::string g_cache_file;
+
+/** Global variable containing name of trace file if given. */
+extern std::string g_trace_file;
+
 /** Enumeration type for master type. */
 enum master_t
 {
     no_master,
     serial,
+    local,
     mpi,
 };
 
@@ -0,0 +1,253 @@
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "BinaryResultReader.h"
+
+// Returns whether host is little-endian
+static bool host_is_little_endian()
+{
+    const std::uint32_t one = 1;
+    char first_byte;
+    std::memcpy(&first_byte, &one, 1);
+    return first_byte == 1;
+}
+
+// Read unsigned integer in host byte order
+template <typename T>
+static T read_unsigned(const char *p)
+{
+    T value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Open file and map it into memory
+BinaryResultReader::BinaryResultReader(const std::string& filename) :
+    m_filename(filename)
+{
+    int fd = open(m_filename.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        std::string error_msg;
+        error_msg += "Could not open file ";
+        error_msg += m_filename;
+        error_msg += ": ";
+        error_msg += strerror(errno);
+        std::runtime_error e(error_msg);
+        throw e;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1)
+    {
+        std::string error_msg;
+        error_msg += "Could not stat file ";
+        error_msg += m_filename;
+        error_msg += ": ";
+        error_msg += strerror(errno);
+        close(fd);
+        std::runtime_error e(error_msg);
+        throw e;
+    }
+    m_size = file_stat.st_size;
+
+    // Map file, unless it is empty, in which case parse() reports it
+    if (m_size > 0)
+    {
+        void *p_map = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (p_map == MAP_FAILED)
+        {
+            std::string error_msg;
+            error_msg += "Could not map file ";
+            error_msg += m_filename;
+            error_msg += ": ";
+            error_msg += strerror(errno);
+            close(fd);
+            std::runtime_error e(error_msg);
+            throw e;
+        }
+
+        m_data = static_cast<const char*>(p_map);
+        m_mapped = true;
+    }
+
+    // The mapping remains valid after closing the file
+    close(fd);
+
+    try
+    {
+        parse();
+    }
+    catch (...)
+    {
+        if (m_mapped)
+            munmap(const_cast<char*>(m_data), m_size);
+        throw;
+    }
+}
+
+// Construct from contents of file in memory
+BinaryResultReader::BinaryResultReader(const char *data, std::size_t size) :
+    m_data(data),
+    m_size(size)
+{
+    if (reinterpret_cast<std::uintptr_t>(m_data) % 8 != 0)
+    {
+        std::runtime_error e("Binary results must be aligned to 8 bytes");
+        throw e;
+    }
+
+    parse();
+}
+
+// Unmap file
+BinaryResultReader::~BinaryResultReader()
+{
+    if (m_mapped)
+        munmap(const_cast<char*>(m_data), m_size);
+}
+
+// Get column descriptors
+const std::vector<BinaryResultReader::Column>&
+BinaryResultReader::getColumns() const
+{
+    return m_columns;
+}
+
+// Get number of blocks
+std::size_t BinaryResultReader::getNumBlocks() const
+{
+    return m_block_rows.size();
+}
+
+// Get number of rows in block
+std::size_t BinaryResultReader::getNumRows(std::size_t block) const
+{
+    return m_block_rows.at(block);
+}
+
+// Get total number of rows
+std::size_t BinaryResultReader::getNumRows() const
+{
+    std::size_t num_rows = 0;
+    for (std::size_t rows : m_block_rows)
+        num_rows += rows;
+
+    return num_rows;
+}
+
+// Get float64 column
+const double *BinaryResultReader::getFloat64Column(std::size_t block,
+        std::size_t column) const
+{
+    return reinterpret_cast<const double*>(this->column(block, column,
+                BinaryResultWriter::float64_column));
+}
+
+// Get int64 column
+const std::int64_t *BinaryResultReader::getInt64Column(std::size_t block,
+        std::size_t column) const
+{
+    return reinterpret_cast<const std::int64_t*>(this->column(block, column,
+                BinaryResultWriter::int64_column));
+}
+
+// Parse header and block lengths
+void BinaryResultReader::parse()
+{
+    const std::string name = m_filename.empty() ? "Binary results"
+        : "File " + m_filename;
+
+    auto throw_error = [&name] (const std::string& what)
+    {
+        std::runtime_error e(name + what);
+        throw e;
+    };
+
+    if (!host_is_little_endian())
+        throw_error(" cannot be read on a big-endian host");
+
+    const std::size_t magic_size = sizeof(BinaryResultWriter::magic) - 1;
+    if (m_size < magic_size + 8
+            || std::memcmp(m_data, BinaryResultWriter::magic, magic_size) != 0)
+        throw_error(" is not a Pakman binary result file");
+
+    // Parse column descriptors
+    std::size_t offset = magic_size;
+    const std::uint32_t num_columns =
+        read_unsigned<std::uint32_t>(m_data + offset);
+    offset += 8;
+
+    for (std::uint32_t i = 0; i < num_columns; i++)
+    {
+        if (offset + 8 > m_size)
+            throw_error(" has a truncated header");
+
+        Column column;
+        const std::uint32_t type =
+            read_unsigned<std::uint32_t>(m_data + offset);
+        const std::uint32_t name_size =
+            read_unsigned<std::uint32_t>(m_data + offset + 4);
+        offset += 8;
+
+        if (type != BinaryResultWriter::float64_column
+                && type != BinaryResultWriter::int64_column)
+            throw_error(" has a column of unknown type");
+
+        const std::size_t padded_size = (name_size + 7) / 8 * 8;
+        if (offset + padded_size > m_size)
+            throw_error(" has a truncated header");
+
+        column.type = static_cast<BinaryResultWriter::column_t>(type);
+        column.name.assign(m_data + offset, name_size);
+        m_columns.push_back(std::move(column));
+        offset += padded_size;
+    }
+
+    // Parse block lengths
+    while (offset < m_size)
+    {
+        if (offset + 8 > m_size)
+            throw_error(" has a truncated block");
+
+        const std::uint64_t num_rows =
+            read_unsigned<std::uint64_t>(m_data + offset);
+        offset += 8;
+
+        if (num_rows > (m_size - offset) / 8 / std::max<std::size_t>(
+                    num_columns, 1))
+            throw_error(" has a truncated block");
+
+        m_block_offsets.push_back(offset);
+        m_block_rows.push_back(num_rows);
+        offset += num_rows * num_columns * 8;
+    }
+}
+
+// Returns pointer to values of column in block
+const char *BinaryResultReader::column(std::size_t block, std::size_t column,
+        BinaryResultWriter::column_t type) const
+{
+    if (m_columns.at(column).type != type)
+    {
+        std::string error_msg;
+        error_msg += "Column ";
+        error_msg += m_columns[column].name;
+        error_msg += " does not have the requested type";
+        std::runtime_error e(error_msg);
+        throw e;
+    }
+
+    return m_data + m_block_offsets.at(block)
+        + column * m_block_rows[block] * 8;
+}
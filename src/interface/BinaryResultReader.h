@@ -0,0 +1,114 @@
+#ifndef BINARYRESULTREADER_H
+#define BINARYRESULTREADER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "interface/BinaryResultWriter.h"
+
+/** A class for reading results in the binary columnar format.
+ *
+ * BinaryResultReader reads files written by BinaryResultWriter, which also
+ * documents the format.  The file is mapped into memory and the columns are
+ * used in place, so that opening a file costs no more than scanning its
+ * header and block lengths, no matter how many results it holds.  Since
+ * columns are not converted, the host must be little-endian.
+ */
+
+class BinaryResultReader
+{
+    public:
+
+        /** Column descriptor. */
+        struct Column
+        {
+            /** Name of column. */
+            std::string name;
+
+            /** Type of column. */
+            BinaryResultWriter::column_t type;
+        };
+
+        /** Open file and map it into memory.
+         *
+         * @param filename  path to file.
+         */
+        BinaryResultReader(const std::string& filename);
+
+        /** Construct from contents of file in memory, which must be aligned
+         * to 8 bytes and outlive the BinaryResultReader.
+         *
+         * @param data  pointer to contents of file.
+         * @param size  size of contents of file.
+         */
+        BinaryResultReader(const char *data, std::size_t size);
+
+        /** Destructor unmaps file. */
+        ~BinaryResultReader();
+
+        /** BinaryResultReader is not copyable. */
+        BinaryResultReader(const BinaryResultReader&) = delete;
+
+        /** BinaryResultReader is not copy-assignable. */
+        BinaryResultReader& operator=(const BinaryResultReader&) = delete;
+
+        /** @return column descriptors. */
+        const std::vector<Column>& getColumns() const;
+
+        /** @return number of blocks. */
+        std::size_t getNumBlocks() const;
+
+        /** @param block  index of block.
+         *
+         * @return number of rows in block.
+         */
+        std::size_t getNumRows(std::size_t block) const;
+
+        /** @return total number of rows. */
+        std::size_t getNumRows() const;
+
+        /** @param block  index of block.
+         * @param column  index of column, which must be of type float64.
+         *
+         * @return pointer to values of column in block.
+         */
+        const double *getFloat64Column(std::size_t block,
+                std::size_t column) const;
+
+        /** @param block  index of block.
+         * @param column  index of column, which must be of type int64.
+         *
+         * @return pointer to values of column in block.
+         */
+        const std::int64_t *getInt64Column(std::size_t block,
+                std::size_t column) const;
+
+    private:
+
+        // Parse header and block lengths
+        void parse();
+
+        // Returns pointer to values of column in block, checking its type
+        const char *column(std::size_t block, std::size_t column,
+                BinaryResultWriter::column_t type) const;
+
+        // Path to file, empty if constructed from memory
+        std::string m_filename;
+
+        // Contents of file and their size
+        const char *m_data = nullptr;
+        std::size_t m_size = 0;
+
+        // Whether m_data is a mapping that must be unmapped
+        bool m_mapped = false;
+
+        // Column descriptors
+        std::vector<Column> m_columns;
+
+        // Offsets of first column and numbers of rows of blocks
+        std::vector<std::size_t> m_block_offsets;
+        std::vector<std::size_t> m_block_rows;
+};
+
+#endif // BINARYRESULTREADER_H
@@ -0,0 +1,159 @@
+#include <string>
+#include <vector>
+#include <ostream>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+
+#include "interface/types.h"
+#include "interface/numeric_parameter.h"
+
+#include "BinaryResultWriter.h"
+
+const char BinaryResultWriter::magic[9] = "PAKMANR1";
+
+// Write unsigned integer of N bytes in little-endian byte order
+template <int N>
+static void write_unsigned(std::ostream& ostrm, std::uint64_t value)
+{
+    char bytes[N];
+    for (int i = 0; i < N; i++)
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+
+    ostrm.write(bytes, N);
+}
+
+// Returns bit pattern of 8-byte value
+static std::uint64_t to_bits(double value)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static std::uint64_t to_bits(std::int64_t value)
+{
+    return static_cast<std::uint64_t>(value);
+}
+
+// Construct from output stream and parameter names
+BinaryResultWriter::BinaryResultWriter(std::ostream& ostrm,
+        const std::vector<ParameterName>& parameter_names, bool write_header,
+        std::size_t block_size) :
+    m_ostrm(ostrm),
+    m_parameter_names(parameter_names),
+    m_block_size(block_size),
+    m_header_written(!write_header),
+    m_parameter_columns(parameter_names.size())
+{
+}
+
+// Add row
+void BinaryResultWriter::addRow(const std::vector<double>& values,
+        double weight, long generation, double wall_time, int error_code)
+{
+    if (values.size() != m_parameter_columns.size())
+    {
+        std::string error_msg;
+        error_msg += "Parameter has ";
+        error_msg += std::to_string(values.size());
+        error_msg += " values, but there are ";
+        error_msg += std::to_string(m_parameter_columns.size());
+        error_msg += " parameter names";
+        std::runtime_error e(error_msg);
+        throw e;
+    }
+
+    for (std::size_t i = 0; i < values.size(); i++)
+        m_parameter_columns[i].push_back(values[i]);
+
+    m_weights.push_back(weight);
+    m_generations.push_back(generation);
+    m_wall_times.push_back(wall_time);
+    m_error_codes.push_back(error_code);
+
+    // Write full block
+    if (m_weights.size() >= m_block_size)
+        writeBlock();
+}
+
+// Add row from parameter
+void BinaryResultWriter::addRow(const Parameter& parameter, double weight,
+        long generation, double wall_time, int error_code)
+{
+    addRow(parse_numeric_parameter(parameter), weight, generation, wall_time,
+            error_code);
+}
+
+// Write collected rows and flush output stream
+void BinaryResultWriter::flush()
+{
+    writeBlock();
+    m_ostrm.flush();
+}
+
+// Write header
+void BinaryResultWriter::writeHeader()
+{
+    m_ostrm.write(magic, sizeof(magic) - 1);
+    write_unsigned<4>(m_ostrm, m_parameter_names.size() + 4);
+    write_unsigned<4>(m_ostrm, 0);
+
+    // Write column descriptors
+    auto write_column = [this] (column_t type, const std::string& name)
+    {
+        write_unsigned<4>(m_ostrm, type);
+        write_unsigned<4>(m_ostrm, name.size());
+        m_ostrm.write(name.data(), name.size());
+
+        static const char padding[8] = { 0 };
+        m_ostrm.write(padding, (8 - name.size() % 8) % 8);
+    };
+
+    for (const auto& parameter_name : m_parameter_names)
+        write_column(float64_column, parameter_name.str());
+
+    write_column(float64_column, "weight");
+    write_column(int64_column, "generation");
+    write_column(float64_column, "wall_time");
+    write_column(int64_column, "error_code");
+
+    m_header_written = true;
+}
+
+// Write collected rows as a block.  The header is written before the first
+// block even if there are no rows, so that every file is self-describing
+void BinaryResultWriter::writeBlock()
+{
+    if (!m_header_written)
+        writeHeader();
+
+    if (m_weights.empty())
+        return;
+
+    write_unsigned<8>(m_ostrm, m_weights.size());
+
+    for (auto& column : m_parameter_columns)
+    {
+        writeColumn(column);
+        column.clear();
+    }
+
+    writeColumn(m_weights);
+    writeColumn(m_generations);
+    writeColumn(m_wall_times);
+    writeColumn(m_error_codes);
+
+    m_weights.clear();
+    m_generations.clear();
+    m_wall_times.clear();
+    m_error_codes.clear();
+}
+
+// Write column of 8-byte values in little-endian byte order
+template <typename T>
+void BinaryResultWriter::writeColumn(const std::vector<T>& column)
+{
+    for (const T& value : column)
+        write_unsigned<8>(m_ostrm, to_bits(value));
+}
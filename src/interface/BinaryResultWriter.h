@@ -0,0 +1,127 @@
+#ifndef BINARYRESULTWRITER_H
+#define BINARYRESULTWRITER_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+#include "interface/types.h"
+
+/** A class for writing results in the binary columnar format.
+ *
+ * The binary format is an alternative to the CSV output of Pakman that can
+ * be loaded without parsing.  Next to the parameter values, it contains the
+ * weight of every parameter, the generation in which it was accepted, the
+ * wall time of its simulation and the error code of the simulator.
+ *
+ * All numbers are stored in little-endian byte order and all fields are
+ * aligned to 8 bytes, so that a reader can map the file into memory and use
+ * the columns in place (see BinaryResultReader).  The file consists of a
+ * header followed by any number of blocks:
+ *
+ * ```
+ * header:
+ *   char[8]   magic string "PAKMANR1"
+ *   uint32    number of columns C
+ *   uint32    reserved, zero
+ *   C times:
+ *     uint32  column type (0 = float64, 1 = int64)
+ *     uint32  length L of column name
+ *     char[L] column name, zero-padded to a multiple of 8 bytes
+ *
+ * block:
+ *   uint64    number of rows N
+ *   C times:
+ *     N values of 8 bytes each
+ * ```
+ *
+ * The columns are the parameter columns in the order of the parameter
+ * names, followed by the columns `weight` (float64), `generation` (int64),
+ * `wall_time` (float64, in seconds) and `error_code` (int64).
+ *
+ * Rows are collected in memory and written as a block when the block is full
+ * or when flush() is called.
+ */
+
+class BinaryResultWriter
+{
+    public:
+
+        /** Enumeration type for column types. */
+        enum column_t { float64_column = 0, int64_column = 1 };
+
+        /** Construct from output stream and parameter names.
+         *
+         * @param ostrm  output stream.
+         * @param parameter_names  list of parameter names.
+         * @param write_header  whether to write the header, which is
+         * omitted when appending to the output of an interrupted run.
+         * @param block_size  maximum number of rows per block.
+         */
+        BinaryResultWriter(std::ostream& ostrm,
+                const std::vector<ParameterName>& parameter_names,
+                bool write_header = true, std::size_t block_size = 1 << 16);
+
+        /** Add row.
+         *
+         * @param values  numeric parameter values.
+         * @param weight  weight of parameter.
+         * @param generation  generation of parameter.
+         * @param wall_time  wall time of simulation in seconds.
+         * @param error_code  error code of simulation.
+         */
+        void addRow(const std::vector<double>& values, double weight,
+                long generation, double wall_time, int error_code);
+
+        /** Add row from parameter, which must be numeric.
+         *
+         * @param parameter  parameter.
+         * @param weight  weight of parameter.
+         * @param generation  generation of parameter.
+         * @param wall_time  wall time of simulation in seconds.
+         * @param error_code  error code of simulation.
+         */
+        void addRow(const Parameter& parameter, double weight,
+                long generation, double wall_time, int error_code);
+
+        /** Write header if it has not been written yet, write collected rows
+         * as a block and flush output stream. */
+        void flush();
+
+        /** Magic string at the start of every file. */
+        static const char magic[9];
+
+    private:
+
+        // Write header
+        void writeHeader();
+
+        // Write collected rows as a block
+        void writeBlock();
+
+        // Write column of 8-byte values in little-endian byte order
+        template <typename T>
+        void writeColumn(const std::vector<T>& column);
+
+        // Output stream
+        std::ostream& m_ostrm;
+
+        // Parameter names
+        std::vector<ParameterName> m_parameter_names;
+
+        // Maximum number of rows per block
+        std::size_t m_block_size;
+
+        // Whether header has been written
+        bool m_header_written;
+
+        // Columns of collected rows
+        std::vector<std::vector<double>> m_parameter_columns;
+        std::vector<double> m_weights;
+        std::vector<std::int64_t> m_generations;
+        std::vector<double> m_wall_times;
+        std::vector<std::int64_t> m_error_codes;
+};
+
+#endif // BINARYRESULTWRITER_H
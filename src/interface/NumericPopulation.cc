@@ -0,0 +1,77 @@
+#include <vector>
+#include <stdexcept>
+
+#include <assert.h>
+
+#include "interface/numeric_parameter.h"
+
+#include "NumericPopulation.h"
+
+// Construct empty population
+NumericPopulation::NumericPopulation(int num_parameters) :
+    m_columns(num_parameters)
+{
+}
+
+// Returns number of parameters in population
+int NumericPopulation::size() const
+{
+    return m_size;
+}
+
+// Returns number of components of every parameter
+int NumericPopulation::numParameters() const
+{
+    return m_columns.size();
+}
+
+// Append parameter to population
+void NumericPopulation::push_back(const std::vector<double>& values)
+{
+    check_numeric_parameter(values, m_columns.size());
+
+    for (int d = 0; d < m_columns.size(); d++)
+        m_columns[d].push_back(values[d]);
+
+    m_size++;
+}
+
+// Get parameter
+std::vector<double> NumericPopulation::row(int i) const
+{
+    assert(0 <= i && i < m_size);
+
+    std::vector<double> values(m_columns.size());
+    for (int d = 0; d < m_columns.size(); d++)
+        values[d] = m_columns[d][i];
+
+    return values;
+}
+
+// Get component of all parameters
+const std::vector<double>& NumericPopulation::column(int d) const
+{
+    return m_columns[d];
+}
+
+// Get component of parameter
+double NumericPopulation::value(int i, int d) const
+{
+    return m_columns[d][i];
+}
+
+// Reserve space for parameters
+void NumericPopulation::reserve(int capacity)
+{
+    for (std::vector<double>& column : m_columns)
+        column.reserve(capacity);
+}
+
+// Remove all parameters
+void NumericPopulation::clear()
+{
+    for (std::vector<double>& column : m_columns)
+        column.clear();
+
+    m_size = 0;
+}
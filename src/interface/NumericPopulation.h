@@ -0,0 +1,81 @@
+#ifndef NUMERICPOPULATION_H
+#define NUMERICPOPULATION_H
+
+#include <vector>
+
+/** A class for storing a population of numeric parameters.
+ *
+ * NumericPopulation stores the numeric values of a population of parameters
+ * by column, so that every component of the parameters is a contiguous array
+ * of doubles.  The parameters are parsed once when they enter Pakman, and are
+ * only formatted as strings when they leave it, which avoids parsing and
+ * allocating strings on the hot path and allows loops over the population to
+ * be vectorized.
+ */
+
+class NumericPopulation
+{
+    public:
+
+        /** Construct empty population.
+         *
+         * @param num_parameters  number of components of every parameter.
+         */
+        NumericPopulation(int num_parameters = 0);
+
+        /** @return number of parameters in population. */
+        int size() const;
+
+        /** @return number of components of every parameter. */
+        int numParameters() const;
+
+        /** Append parameter to population.
+         *
+         * @param values  numeric values of parameter.
+         */
+        void push_back(const std::vector<double>& values);
+
+        /** Get parameter.
+         *
+         * @param i  index of parameter.
+         *
+         * @return numeric values of parameter i.
+         */
+        std::vector<double> row(int i) const;
+
+        /** Get component of all parameters.
+         *
+         * @param d  index of component.
+         *
+         * @return contiguous array of component d of all parameters.
+         */
+        const std::vector<double>& column(int d) const;
+
+        /** Get component of parameter.
+         *
+         * @param i  index of parameter.
+         * @param d  index of component.
+         *
+         * @return component d of parameter i.
+         */
+        double value(int i, int d) const;
+
+        /** Reserve space for parameters.
+         *
+         * @param capacity  number of parameters to reserve space for.
+         */
+        void reserve(int capacity);
+
+        /** Remove all parameters. */
+        void clear();
+
+    private:
+
+        // Components of parameters
+        std::vector<std::vector<double>> m_columns;
+
+        // Number of parameters
+        int m_size = 0;
+};
+
+#endif // NUMERICPOPULATION_H
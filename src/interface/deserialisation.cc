@@ -149,7 +149,7 @@ TaskHandler deserialise_scalar_value(const LineString& key, std::istream& in)
     read_key(key, in);
     auto error_code = deserialise_scalar_value<int>("m_error_code", in);
 
-    TaskHandler task(input_string);
+    TaskHandler task(std::move(input_string));
 
     // If pending task, return without recording output string and error code
     if (output_string.empty() && (error_code == -1))
@@ -158,11 +158,21 @@ TaskHandler deserialise_scalar_value(const LineString& key, std::istream& in)
     }
 
     // If finished task, return after recording output string and error code
-    task.recordOutputAndErrorCode(output_string, error_code);
+    task.recordOutputAndErrorCode(std::move(output_string), error_code);
 
     return task;
 }
 
+std::vector<Parameter> deserialise_parameters(const LineString& key,
+        std::istream& in)
+{
+    std::vector<Parameter> parameters;
+    for (std::string& string : deserialise_vector<std::string>(key, in))
+        parameters.push_back(std::move(string));
+
+    return parameters;
+}
+
 std::istream& operator>>(std::istream& in, LineString& line_string)
 {
     // Extract to string
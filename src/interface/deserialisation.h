@@ -2,11 +2,15 @@
 #define DESERIALISATION_H
 
 #include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include "core/Command.h"
 #include "core/TaskHandler.h"
 
 #include "LineString.h"
+#include "types.h"
 
 /** @file deserialisation.h
  *
@@ -102,6 +106,42 @@ Command deserialise_scalar_value(const LineString& key, std::istream& in);
 template <>
 TaskHandler deserialise_scalar_value(const LineString& key, std::istream& in);
 
+/** Deserialise vector
+ *
+ * @param key  identifier of serialised vector
+ * @param in  input stream to read from
+ *
+ * @return deserialised vector
+ */
+template <typename value_type>
+std::vector<value_type> deserialise_vector(const LineString& key,
+        std::istream& in)
+{
+    // Read number of elements
+    auto size = deserialise_scalar_value<std::size_t>(key, in);
+
+    // Read each element with key_n
+    std::vector<value_type> values;
+    values.reserve(size);
+    for (std::size_t idx = 0; idx < size; ++idx)
+    {
+        values.push_back(deserialise_scalar_value<value_type>(
+                    key.str() + "_" + std::to_string(idx), in));
+    }
+
+    return values;
+}
+
+/** Deserialise vector of parameters
+ *
+ * @param key  identifier of serialised vector
+ * @param in  input stream to read from
+ *
+ * @return deserialised parameters
+ */
+std::vector<Parameter> deserialise_parameters(const LineString& key,
+        std::istream& in);
+
 /** Overload >> operator for LineString
  *
  * @param in  input stream
@@ -0,0 +1,69 @@
+#include <string>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+
+#include "core/utils.h"
+
+#include "numeric_parameter.h"
+
+std::vector<double> parse_numeric_parameter(const Parameter& parameter)
+{
+    std::vector<double> values;
+
+    for (const std::string& token : parse_tokens(parameter.str(), " \t,"))
+    {
+        // Parse token as double-precision floating point
+        std::size_t pos = 0;
+        try
+        {
+            values.push_back(std::stod(token, &pos));
+        }
+        catch (const std::logic_error& e)
+        {
+            pos = 0;
+        }
+
+        // Ensure that whole token was parsed
+        if (pos == 0 || pos != token.size())
+        {
+            std::string error_msg;
+            error_msg += "Cannot parse parameter as numeric parameter: ";
+            error_msg += parameter.str();
+            throw std::runtime_error(error_msg);
+        }
+    }
+
+    return values;
+}
+
+Parameter format_numeric_parameter(const std::vector<double>& values)
+{
+    std::ostringstream sstrm;
+    sstrm.precision(17);
+
+    for (int i = 0; i < values.size(); i++)
+    {
+        if (i > 0)
+            sstrm << ' ';
+        sstrm << values[i];
+    }
+
+    return sstrm.str();
+}
+
+void check_numeric_parameter(const std::vector<double>& values,
+        int num_parameters)
+{
+    if (static_cast<int>(values.size()) == num_parameters)
+        return;
+
+    std::string error_msg;
+    error_msg += "Numeric parameter ";
+    error_msg += format_numeric_parameter(values).str();
+    error_msg += " has ";
+    error_msg += std::to_string(values.size());
+    error_msg += " values, expected ";
+    error_msg += std::to_string(num_parameters);
+    throw std::runtime_error(error_msg);
+}
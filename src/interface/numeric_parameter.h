@@ -0,0 +1,46 @@
+#ifndef NUMERIC_PARAMETER_H
+#define NUMERIC_PARAMETER_H
+
+#include <vector>
+
+#include "interface/types.h"
+
+/** @file numeric_parameter.h
+ *
+ * This file defines functions to convert between parameters and their
+ * numeric values.  A numeric parameter consists of floating-point numbers
+ * that are separated by whitespace or commas, one for every parameter name.
+ */
+
+/** Parse numeric parameter.
+ *
+ * @param parameter  parameter to parse.
+ *
+ * @return numeric values of parameter.
+ */
+std::vector<double> parse_numeric_parameter(const Parameter& parameter);
+
+/** Format numeric parameter.
+ *
+ * The values are formatted with enough precision to be parsed back exactly.
+ *
+ * @param values  numeric values of parameter.
+ *
+ * @return formatted parameter.
+ */
+Parameter format_numeric_parameter(const std::vector<double>& values);
+
+/** Check that numeric parameter has one value for every parameter name.
+ *
+ * Numeric parameters that are returned by helpers are not checked when they
+ * are parsed, so they must be checked before their values are indexed.  If
+ * the number of values is wrong, a runtime_error naming the parameter is
+ * thrown.
+ *
+ * @param values  numeric values of parameter.
+ * @param num_parameters  number of parameter names.
+ */
+void check_numeric_parameter(const std::vector<double>& values,
+        int num_parameters);
+
+#endif // NUMERIC_PARAMETER_H
@@ -1,48 +1,85 @@
 #include <string>
 #include <vector>
 #include <ostream>
-#include <sstream>
 
-#include "core/utils.h"
 #include "interface/types.h"
+#include "interface/NumericPopulation.h"
 
 #include "output.h"
 
+void write_parameter_names(std::ostream& ostrm,
+        const std::vector<ParameterName>& parameter_names)
+{
+    for (int i = 0; i < parameter_names.size(); i++)
+    {
+        if (i > 0)
+            ostrm << ',';
+        ostrm << parameter_names[i].str();
+    }
+
+    ostrm << '\n';
+}
+
 void write_parameters(std::ostream& ostrm,
         const std::vector<ParameterName>& parameter_names,
         const std::vector<Parameter>& parameters)
 {
     // Print header
-    {
-        std::stringstream sstrm;
+    write_parameter_names(ostrm, parameter_names);
+
+    // Print accepted parameters
+    for (const Parameter& parameter : parameters)
+        write_parameter(ostrm, parameter);
+}
+
+// Write tokens of parameter separated by commas, without building
+// intermediate strings, since this is called for every row of a sweep
+void write_parameter(std::ostream& ostrm, const Parameter& parameter)
+{
+    const std::string& str = parameter.str();
+    const char *delimiters = " \n\t";
 
-        for (const ParameterName& parameter_name : parameter_names)
-            sstrm << parameter_name.str() << ",";
+    bool first = true;
+    std::size_t begin = str.find_first_not_of(delimiters);
+    while (begin != std::string::npos)
+    {
+        std::size_t end = str.find_first_of(delimiters, begin);
+        if (end == std::string::npos)
+            end = str.size();
 
-        sstrm.seekp(sstrm.tellp() - static_cast<std::streamoff>(1));
-        sstrm << std::endl;
+        if (!first)
+            ostrm << ',';
+        ostrm.write(str.data() + begin, end - begin);
+        first = false;
 
-        ostrm << sstrm.str();
+        begin = str.find_first_not_of(delimiters, end);
     }
 
-    // Print accepted parameters
-    for (const Parameter& parameter : parameters)
-    {
-        std::vector<std::string> parameter_tokens =
-            parse_tokens(parameter.str(), " \n\t");
+    ostrm << '\n';
+}
 
-        std::stringstream sstrm;
+void write_numeric_parameters(std::ostream& ostrm,
+        const std::vector<ParameterName>& parameter_names,
+        const NumericPopulation& population)
+{
+    // Print header
+    write_parameter_names(ostrm, parameter_names);
 
-        for (int i = 0; i < parameter_tokens.size(); i++)
-        {
-            sstrm << parameter_tokens[i];
+    // Print accepted parameters with enough precision to be parsed back
+    // exactly
+    std::streamsize precision = ostrm.precision(17);
 
-            if (i < parameter_tokens.size() - 1)
-                sstrm << ',';
+    for (int i = 0; i < population.size(); i++)
+    {
+        for (int d = 0; d < population.numParameters(); d++)
+        {
+            if (d > 0)
+                ostrm << ',';
+            ostrm << population.value(i, d);
         }
 
-        sstrm << std::endl;
-
-        ostrm << sstrm.str();
+        ostrm << '\n';
     }
+
+    ostrm.precision(precision);
 }
@@ -7,11 +7,28 @@
 
 #include "types.h"
 
+class NumericPopulation;
+
 /** @file output.h
  *
  * This file contains functions to format the output of Pakman.
  */
 
+/** Write header with parameter names to output stream.
+ *
+ * @param ostrm  output stream.
+ * @param parameter_names  list of parameter names.
+ */
+void write_parameter_names(std::ostream& ostrm,
+        const std::vector<ParameterName>& parameter_names);
+
+/** Write single parameter to output stream, without header.
+ *
+ * @param ostrm  output stream.
+ * @param parameter  parameter.
+ */
+void write_parameter(std::ostream& ostrm, const Parameter& parameter);
+
 /** Write parameters to output stream.
  *
  * @param ostrm  output stream.
@@ -22,4 +39,17 @@ void write_parameters(std::ostream& ostrm,
         const std::vector<ParameterName>& parameter_names,
         const std::vector<Parameter>& parameters);
 
+/** Write numeric parameters to output stream.
+ *
+ * The values are formatted directly, without going through Parameter
+ * strings.
+ *
+ * @param ostrm  output stream.
+ * @param parameter_names  list of parameter names.
+ * @param population  numeric parameters.
+ */
+void write_numeric_parameters(std::ostream& ostrm,
+        const std::vector<ParameterName>& parameter_names,
+        const NumericPopulation& population);
+
 #endif // WRITE_PARAMETERS_H
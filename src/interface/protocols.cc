@@ -7,6 +7,44 @@
 
 #include "protocols.h"
 
+// Split output of helper in batch mode into lines, ensuring that there are
+// exactly the given number of newline-terminated lines
+static std::vector<std::string> split_batch_output(const std::string& output,
+        int number, const std::string& helper_name)
+{
+    std::vector<std::string> lines;
+
+    // Ensure that output ends with newline
+    if (number > 0 && (output.empty() || output.back() != '\n'))
+    {
+        std::string error_msg;
+        error_msg += helper_name;
+        error_msg += " output must end with newline, given output: ";
+        error_msg += output;
+        throw std::runtime_error(error_msg);
+    }
+
+    // Extract lines
+    std::istringstream sstrm(output);
+    std::string line;
+    while (std::getline(sstrm, line))
+        lines.push_back(std::move(line));
+
+    // Ensure that number of lines is correct
+    if (static_cast<int>(lines.size()) != number)
+    {
+        std::string error_msg;
+        error_msg += helper_name;
+        error_msg += " output must contain exactly ";
+        error_msg += std::to_string(number);
+        error_msg += " newline-terminated lines, given output: ";
+        error_msg += output;
+        throw std::runtime_error(error_msg);
+    }
+
+    return lines;
+}
+
 // simulator protocol
 std::string format_simulator_input(
         const Epsilon& epsilon,
@@ -95,6 +133,26 @@ Parameter parse_prior_sampler_output(const std::string& prior_sampler_output)
     }
 }
 
+std::string format_prior_sampler_input(int number)
+{
+    std::string input_string;
+    input_string += std::to_string(number);
+    input_string += '\n';
+
+    return input_string;
+}
+
+std::vector<Parameter> parse_prior_sampler_output(
+        const std::string& prior_sampler_output, int number)
+{
+    std::vector<Parameter> parameters;
+    for (std::string& line : split_batch_output(prior_sampler_output, number,
+                "Prior_sampler"))
+        parameters.push_back(std::move(line));
+
+    return parameters;
+}
+
 // perturber protocol
 std::string format_perturber_input(int t, const Parameter& parameter)
 {
@@ -107,6 +165,22 @@ std::string format_perturber_input(int t, const Parameter& parameter)
     return input_string;
 }
 
+std::string format_perturber_input(int t,
+        const std::vector<Parameter>& source_parameters)
+{
+    std::string input_string;
+    input_string += std::to_string(t);
+    input_string += '\n';
+
+    for (const Parameter& parameter : source_parameters)
+    {
+        input_string += parameter.str();
+        input_string += '\n';
+    }
+
+    return input_string;
+}
+
 Parameter parse_perturber_output(const std::string& perturber_output)
 {
     try
@@ -124,6 +198,17 @@ Parameter parse_perturber_output(const std::string& perturber_output)
     }
 }
 
+std::vector<Parameter> parse_perturber_output(
+        const std::string& perturber_output, int number)
+{
+    std::vector<Parameter> parameters;
+    for (std::string& line : split_batch_output(perturber_output, number,
+                "Perturber"))
+        parameters.push_back(std::move(line));
+
+    return parameters;
+}
+
 // prior_pdf protocol
 std::string format_prior_pdf_input(const Parameter& parameter)
 {
@@ -134,6 +219,18 @@ std::string format_prior_pdf_input(const Parameter& parameter)
     return input_string;
 }
 
+std::string format_prior_pdf_input(const std::vector<Parameter>& parameters)
+{
+    std::string input_string;
+    for (const Parameter& parameter : parameters)
+    {
+        input_string += parameter.str();
+        input_string += '\n';
+    }
+
+    return input_string;
+}
+
 double parse_prior_pdf_output(const std::string& prior_pdf_output)
 {
     // Extract line
@@ -178,6 +275,20 @@ double parse_prior_pdf_output(const std::string& prior_pdf_output)
     }
 }
 
+std::vector<double> parse_prior_pdf_output(const std::string& prior_pdf_output,
+        int number)
+{
+    std::vector<double> prior_pdfs;
+    for (std::string& line : split_batch_output(prior_pdf_output, number,
+                "Prior_pdf"))
+    {
+        line += '\n';
+        prior_pdfs.push_back(parse_prior_pdf_output(line));
+    }
+
+    return prior_pdfs;
+}
+
 // perturbation_pdf protocol
 std::string format_perturbation_pdf_input(
         int t,
@@ -249,6 +360,67 @@ std::vector<double> parse_perturbation_pdf_output(
     return perturbation_pdf_vector;
 }
 
+std::string format_perturbation_pdf_input(
+        int t,
+        const std::vector<Parameter>& perturbed_parameters,
+        const std::vector<Parameter>& parameter_population)
+{
+    std::string input_string;
+    input_string += std::to_string(t);
+    input_string += '\n';
+    input_string += std::to_string(perturbed_parameters.size());
+    input_string += '\n';
+
+    for (const Parameter& parameter : perturbed_parameters)
+    {
+        input_string += parameter.str();
+        input_string += '\n';
+    }
+
+    for (const Parameter& parameter : parameter_population)
+    {
+        input_string += parameter.str();
+        input_string += '\n';
+    }
+
+    return input_string;
+}
+
+std::vector<std::vector<double>> parse_perturbation_pdf_output(
+        const std::string& perturbation_pdf_output,
+        int number_perturbed, int population_size)
+{
+    std::vector<std::vector<double>> perturbation_pdf_matrix;
+
+    for (const std::string& line : split_batch_output(perturbation_pdf_output,
+                number_perturbed, "Perturbation_pdf"))
+    {
+        // Parse whitespace-separated probability densities
+        std::istringstream sstrm(line);
+        std::vector<double> row;
+        double value;
+        while (sstrm >> value)
+            row.push_back(value);
+
+        // Ensure that the whole line was parsed and that the number of
+        // probability densities is correct
+        if (!sstrm.eof() || static_cast<int>(row.size()) != population_size)
+        {
+            std::string error_msg;
+            error_msg += "Perturbation_pdf output must contain ";
+            error_msg += std::to_string(population_size);
+            error_msg += " probability densities on every line, "
+                "given line: ";
+            error_msg += line;
+            throw std::runtime_error(error_msg);
+        }
+
+        perturbation_pdf_matrix.push_back(std::move(row));
+    }
+
+    return perturbation_pdf_matrix;
+}
+
 // generator protocol
 std::vector<Parameter> parse_generator_output(
         const std::string& generator_output)
@@ -297,6 +469,15 @@ Parameter sample_from_prior(const Command& prior_sampler)
     return parse_prior_sampler_output(prior_sampler_output);
 }
 
+// Call prior_sampler to sample several parameters from prior
+std::vector<Parameter> sample_from_prior(const Command& prior_sampler,
+        int number)
+{
+    std::string prior_sampler_output = system_call(prior_sampler,
+            format_prior_sampler_input(number));
+    return parse_prior_sampler_output(prior_sampler_output, number);
+}
+
 // Call perturber to perturb parameter
 Parameter perturb_parameter(const Command& perturber, int t, Parameter
         source_parameter)
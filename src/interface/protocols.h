@@ -45,6 +45,24 @@ bool parse_simulator_output(const std::string& simulator_output);
  */
 Parameter parse_prior_sampler_output(const std::string& prior_sampler_output);
 
+/** Format input to prior_sampler in batch mode.
+ *
+ * @param number  number of parameters to sample.
+ *
+ * @return input string to prior_sampler.
+ */
+std::string format_prior_sampler_input(int number);
+
+/** Parse output from prior_sampler in batch mode.
+ *
+ * @param prior_sampler_output  output string from prior_sampler.
+ * @param number  number of parameters that were requested.
+ *
+ * @return parameters sampled from prior.
+ */
+std::vector<Parameter> parse_prior_sampler_output(
+        const std::string& prior_sampler_output, int number);
+
 /** Format input to perturber.
  *
  * @param t  current generation.
@@ -54,6 +72,16 @@ Parameter parse_prior_sampler_output(const std::string& prior_sampler_output);
  */
 std::string format_perturber_input(int t, const Parameter& source_parameter);
 
+/** Format input to perturber in batch mode.
+ *
+ * @param t  current generation.
+ * @param source_parameters  source parameters to be perturbed.
+ *
+ * @return input string to perturber.
+ */
+std::string format_perturber_input(int t,
+        const std::vector<Parameter>& source_parameters);
+
 /** Parse output from perturber.
  *
  * @param perturber_output  output string from perturber.
@@ -62,6 +90,16 @@ std::string format_perturber_input(int t, const Parameter& source_parameter);
  */
 Parameter parse_perturber_output(const std::string& perturber_output);
 
+/** Parse output from perturber in batch mode.
+ *
+ * @param perturber_output  output string from perturber.
+ * @param number  number of source parameters that were given.
+ *
+ * @return perturbed parameters.
+ */
+std::vector<Parameter> parse_perturber_output(
+        const std::string& perturber_output, int number);
+
 /** Format input to prior_pdf.
  *
  * @param parameter  parameter to evaluate.
@@ -70,6 +108,14 @@ Parameter parse_perturber_output(const std::string& perturber_output);
  */
 std::string format_prior_pdf_input(const Parameter& parameter);
 
+/** Format input to prior_pdf in batch mode.
+ *
+ * @param parameters  parameters to evaluate.
+ *
+ * @return input string to prior_pdf.
+ */
+std::string format_prior_pdf_input(const std::vector<Parameter>& parameters);
+
 /** Parse output from prior_pdf.
  *
  * @param prior_pdf_output  output string from prior_pdf.
@@ -78,6 +124,16 @@ std::string format_prior_pdf_input(const Parameter& parameter);
  */
 double parse_prior_pdf_output(const std::string& prior_pdf_output);
 
+/** Parse output from prior_pdf in batch mode.
+ *
+ * @param prior_pdf_output  output string from prior_pdf.
+ * @param number  number of parameters that were given.
+ *
+ * @return prior probability densities of parameters.
+ */
+std::vector<double> parse_prior_pdf_output(const std::string& prior_pdf_output,
+        int number);
+
 /** Format input to perturbation_pdf.
  *
  * @param t  current generation.
@@ -101,6 +157,33 @@ std::string format_perturbation_pdf_input(
 std::vector<double> parse_perturbation_pdf_output(
         const std::string& perturbation_pdf_output);
 
+/** Format input to perturbation_pdf in batch mode.
+ *
+ * @param t  current generation.
+ * @param perturbed_parameters  perturbed parameters.
+ * @param parameter_population  parameter population.
+ *
+ * @return input string to perturbation_pdf.
+ */
+std::string format_perturbation_pdf_input(
+        int t,
+        const std::vector<Parameter>& perturbed_parameters,
+        const std::vector<Parameter>& parameter_population);
+
+/** Parse output from perturbation_pdf in batch mode.
+ *
+ * @param perturbation_pdf_output  output string from perturbation_pdf.
+ * @param number_perturbed  number of perturbed parameters.
+ * @param population_size  size of parameter population.
+ *
+ * @return perturbation kernel probability densities, where row i contains
+ * the probability densities for perturbed parameter i and the parameter
+ * population.
+ */
+std::vector<std::vector<double>> parse_perturbation_pdf_output(
+        const std::string& perturbation_pdf_output,
+        int number_perturbed, int population_size);
+
 /** Parse output from generator.
  *
  * @param generator_output  output string from generator.
@@ -118,6 +201,16 @@ std::vector<Parameter> parse_generator_output(
  */
 Parameter sample_from_prior(const Command& prior_sampler);
 
+/** Sample from prior in batch mode.
+ *
+ * @param prior_sampler  command to sample from prior.
+ * @param number  number of parameters to sample.
+ *
+ * @return parameters sampled from prior.
+ */
+std::vector<Parameter> sample_from_prior(const Command& prior_sampler,
+        int number);
+
 /** Perturb parameter.
  *
  * @param perturber  command to perturb parameter.
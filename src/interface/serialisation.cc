@@ -40,6 +40,16 @@ void serialise_scalar_value(const LineString& key,
             value.getErrorCode(), out);
 }
 
+void serialise_parameters(const LineString& key,
+        const std::vector<Parameter>& parameters, std::ostream& out)
+{
+    std::vector<std::string> strings;
+    for (const Parameter& parameter : parameters)
+        strings.push_back(parameter.str());
+
+    serialise_vector(key, strings, out);
+}
+
 std::ostream& operator<<(std::ostream& out, const LineString& line_string)
 {
     out << line_string.str();
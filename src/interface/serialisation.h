@@ -2,11 +2,14 @@
 #define SERIALISATION_H
 
 #include <ostream>
+#include <string>
+#include <vector>
 
 #include "core/Command.h"
 #include "core/TaskHandler.h"
 
 #include "LineString.h"
+#include "types.h"
 
 /** @file serialisation.h
  *
@@ -97,6 +100,18 @@ void serialise_vector(const LineString& key,
     }
 }
 
+/** Serialise vector of parameters
+ *
+ * Unlike serialise_vector, parameters are serialised as strings, so that
+ * parameters containing whitespace are preserved.
+ *
+ * @param key  identifier of serialised vector
+ * @param parameters  parameters to serialise
+ * @param out  output stream to write to
+ */
+void serialise_parameters(const LineString& key,
+        const std::vector<Parameter>& parameters, std::ostream& out);
+
 /** Overload << operator for LineString
  *
  * @param out  output stream
@@ -1,11 +1,22 @@
 #include <sstream>
 #include <iostream>
 #include <random>
+#include <type_traits>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
 
 #include <assert.h>
 
 #include "serialisation.h"
 #include "deserialisation.h"
+#include "numeric_parameter.h"
+#include "NumericPopulation.h"
+#include "output.h"
+#include "BinaryResultWriter.h"
+#include "BinaryResultReader.h"
 
 int main()
 {
@@ -182,6 +193,22 @@ int main()
         assert(val.getErrorCode() == -1);
     }
 
+    // Test that TaskHandler is move-only and shares its input buffer
+    {
+        static_assert(!std::is_copy_constructible<TaskHandler>::value,
+                "TaskHandler should not be copyable");
+
+        TaskHandler task("my input\nstring", 3);
+        auto p_input = task.getInputBuffer();
+
+        TaskHandler moved_task(std::move(task));
+        assert(moved_task.getTaskId() == 3);
+        assert(&moved_task.getInputString() == p_input.get());
+
+        TaskHandler shared_task(p_input, 4);
+        assert(&shared_task.getInputString() == p_input.get());
+    }
+
     // Test serialising finished TaskHandler
     {
         osstr.str("");
@@ -472,4 +499,187 @@ int main()
                 "my_prng_vector_1:" + prng_sstr2.str() + "\n"
                 );
     }
+
+    // Test deserialising vector of doubles
+    {
+        isstr.str("my_double_vector:3\n"
+                "my_double_vector_0:3.14\n"
+                "my_double_vector_1:0.128\n"
+                "my_double_vector_2:1e+18\n");
+
+        auto vals = deserialise_vector<double>("my_double_vector", isstr);
+        assert(vals.size() == 3);
+        assert(vals[0] == 3.14);
+        assert(vals[1] == 0.128);
+        assert(vals[2] == 1e18);
+    }
+
+    // Test serialising and deserialising vector of parameters
+    {
+        osstr.str("");
+
+        std::vector<Parameter> vals;
+        vals.push_back("1 2");
+        vals.push_back("\t3,4 ");
+
+        serialise_parameters("my_parameters", vals, osstr);
+
+        assert(osstr.str() == "my_parameters:2\n"
+                "my_parameters_0:3:1 2\n"
+                "my_parameters_1:5:\t3,4 \n");
+
+        isstr.str(osstr.str());
+
+        auto parameters = deserialise_parameters("my_parameters", isstr);
+        assert(parameters.size() == 2);
+        assert(parameters[0].str() == "1 2");
+        assert(parameters[1].str() == "\t3,4 ");
+    }
+
+    // Test parsing and formatting numeric parameter
+    {
+        std::vector<double> values =
+            parse_numeric_parameter(Parameter("1.5 -2e-3,\t0.1"));
+        assert(values.size() == 3);
+        assert(values[0] == 1.5);
+        assert(values[1] == -2e-3);
+        assert(values[2] == 0.1);
+
+        assert(parse_numeric_parameter(
+                    format_numeric_parameter(values)) == values);
+    }
+
+    // Test write_parameters
+    {
+        osstr.str("");
+        write_parameters(osstr, {"p", "q"}, {" 1  2\t", "3 4\n"});
+        assert(osstr.str() == "p,q\n1,2\n3,4\n");
+    }
+
+    // Test NumericPopulation
+    {
+        NumericPopulation population(2);
+        population.push_back({1.0, 2.0});
+        population.push_back({3.0, 4.0});
+
+        assert(population.size() == 2);
+        assert(population.numParameters() == 2);
+        assert(population.row(1) == std::vector<double>({3.0, 4.0}));
+        assert(population.column(0) == std::vector<double>({1.0, 3.0}));
+        assert(population.value(0, 1) == 2.0);
+
+        osstr.str("");
+        write_numeric_parameters(osstr, {"p", "q"}, population);
+        assert(osstr.str() == "p,q\n1,2\n3,4\n");
+
+        population.clear();
+        assert(population.size() == 0);
+        assert(population.column(1).empty());
+
+        // Parameters with the wrong number of values are rejected
+        try
+        {
+            population.push_back({1.0, 2.0, 3.0});
+            assert(false);
+        }
+        catch (const std::runtime_error& e)
+        {
+            assert(std::string(e.what())
+                    == "Numeric parameter 1 2 3 has 3 values, expected 2");
+        }
+        assert(population.size() == 0);
+    }
+
+    // Test BinaryResultWriter and BinaryResultReader
+    {
+        // Copy contents to buffer aligned to 8 bytes
+        auto aligned = [] (const std::string& contents)
+        {
+            std::vector<std::uint64_t> buffer((contents.size() + 7) / 8);
+            std::memcpy(buffer.data(), contents.data(), contents.size());
+            return buffer;
+        };
+
+        // Blocks hold at most two rows
+        osstr.str("");
+        BinaryResultWriter writer(osstr, {"p", "long_name"}, true, 2);
+        writer.addRow({1.0, 2.0}, 0.25, 0, 0.5, 0);
+        writer.addRow({3.0, 4.0}, 0.75, 0, NAN, 0);
+        writer.addRow(Parameter("5 6"), 1.0, 1, 1.5, 3);
+        writer.flush();
+
+        std::string contents = osstr.str();
+        assert(contents.compare(0, 8, "PAKMANR1") == 0);
+        assert(contents.size() % 8 == 0);
+
+        auto buffer = aligned(contents);
+        BinaryResultReader reader(
+                reinterpret_cast<const char*>(buffer.data()),
+                contents.size());
+
+        const auto& columns = reader.getColumns();
+        assert(columns.size() == 6);
+        assert(columns[1].name == "long_name");
+        assert(columns[2].name == "weight");
+        assert(columns[3].name == "generation");
+        assert(columns[3].type == BinaryResultWriter::int64_column);
+        assert(columns[5].name == "error_code");
+
+        assert(reader.getNumBlocks() == 2);
+        assert(reader.getNumRows(0) == 2);
+        assert(reader.getNumRows(1) == 1);
+        assert(reader.getNumRows() == 3);
+
+        assert(reader.getFloat64Column(0, 1)[1] == 4.0);
+        assert(reader.getFloat64Column(0, 2)[0] == 0.25);
+        assert(std::isnan(reader.getFloat64Column(0, 4)[1]));
+        assert(reader.getFloat64Column(1, 0)[0] == 5.0);
+        assert(reader.getInt64Column(1, 3)[0] == 1);
+        assert(reader.getInt64Column(1, 5)[0] == 3);
+
+        // Columns are typed
+        bool threw = false;
+        try { reader.getInt64Column(0, 0); }
+        catch (const std::runtime_error&) { threw = true; }
+        assert(threw);
+
+        // Blocks written without header can be appended
+        std::ostringstream appended;
+        BinaryResultWriter append_writer(appended, {"p", "long_name"},
+                false);
+        append_writer.addRow({7.0, 8.0}, 1.0, 2, 0.0, 0);
+        append_writer.flush();
+
+        std::string concatenated = contents + appended.str();
+        buffer = aligned(concatenated);
+        BinaryResultReader concatenated_reader(
+                reinterpret_cast<const char*>(buffer.data()),
+                concatenated.size());
+        assert(concatenated_reader.getNumBlocks() == 3);
+        assert(concatenated_reader.getFloat64Column(2, 1)[0] == 8.0);
+
+        // Truncated blocks are detected
+        threw = false;
+        try
+        {
+            buffer = aligned(contents);
+            BinaryResultReader truncated_reader(
+                    reinterpret_cast<const char*>(buffer.data()),
+                    contents.size() - 8);
+        }
+        catch (const std::runtime_error&) { threw = true; }
+        assert(threw);
+
+        // Header is written even without rows
+        osstr.str("");
+        BinaryResultWriter empty_writer(osstr, {"p"});
+        empty_writer.flush();
+        contents = osstr.str();
+        buffer = aligned(contents);
+        BinaryResultReader empty_reader(
+                reinterpret_cast<const char*>(buffer.data()),
+                contents.size());
+        assert(empty_reader.getColumns().size() == 5);
+        assert(empty_reader.getNumBlocks() == 0);
+    }
 }
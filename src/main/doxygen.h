@@ -52,7 +52,10 @@
  * queues; the Controller pushes pending tasks to **pending queue** of the
  * Master, and pops finished tasks from the front of the **finished queue**.
  * The role of the Master is therefore simply to process tasks from the pending
- * queue and push the finished tasks on to the finished queue.
+ * queue and push the finished tasks on to the finished queue.  Tasks may
+ * finish in a different order than they were pushed, so every task carries an
+ * identifier (see TaskHandler::getTaskId()) that the Controller can use to
+ * match finished tasks with the tasks it pushed.
  *
  * Moreover, Masters and Controllers are run within an **event loop**.  This
  * means that they both implement an `iterate()` function
@@ -110,8 +113,11 @@
  * signals to terminate Workers before they have finished their simulations,
  * for example when an ABC SMC generation has finished, or the requisite number
  * of parameters have been accepted in ABC rejection.  This is not possible for
- * spawned MPI processes however, so Pakman has no choice but to wait for the
- * simulation to finish.
+ * spawned MPI processes however, so Pakman instead sends a cancellation
+ * signal through MPI.  The simulator can check for this signal and return
+ * early (see @ref mpi-simulator-cancellation "Cancelling simulations").
+ * Otherwise, the cancelled simulation runs to completion and its result is
+ * discarded.
  *
  * Secondly, it is impossible to discard the standard error of a process
  * created using `MPI_Comm_spawn`, so the flag `--discard-child-stderr` does
@@ -284,6 +290,45 @@
  * arguments.
  *
  * @include mpi-simulator-cpp.cc
+ *
+ * # Cancelling simulations {#mpi-simulator-cancellation}
+ *
+ * When the result of a simulation is no longer needed, Pakman cancels the
+ * simulation by sending a cancellation signal to the MPI Worker.  Since the
+ * MPI Worker runs the simulator function in the same process, it cannot act
+ * on this signal by itself.  Instead, simulations that take a long time
+ * should check for cancellation at regular intervals, for example at every
+ * time step, by calling pakman_should_cancel() in C or
+ * PakmanMPIWorker::shouldCancel() in C++.  When cancellation is detected, the
+ * simulator function should return as soon as possible.  The output string
+ * and error code of a cancelled simulation are discarded, but the output
+ * string must still be set (and, in C, allocated with `malloc()`).
+ *
+ * ```C
+ * int my_simulator(int argc, char *argv[],
+ *         const char* input_string, char **p_output_string)
+ * {
+ *     for (int step = 0; step < num_steps; step++)
+ *     {
+ *         /* Return early if simulation has been cancelled */
+ *         if (pakman_should_cancel())
+ *         {
+ *             *p_output_string = strdup("reject\n");
+ *             return 0;
+ *         }
+ *
+ *         /* ...
+ *          * Perform time step
+ *          * ...
+ *          */
+ *     }
+ *
+ *     /* ... */
+ * }
+ * ```
+ *
+ * Checking for cancellation is optional; a simulator that never checks for
+ * cancellation simply runs cancelled simulations to completion.
  */
 
 /** @page controller Implementing a Controller subclass
@@ -26,6 +26,13 @@ std::string general_options()
   -v, --verbosity=level         set verbosity level to debug/info/off
                                 (default info)
   -o, --output-file             set output file (default stdout)
+  -a, --async-output            write output on a background thread
+  -u, --output-format=format    set output format to csv/binary
+                                (default csv)
+  -c, --cache=FILE              reuse results of simulations cached in FILE
+                                and add new results to FILE
+  -x, --trace=FILE              write trace of task lifecycle events to FILE
+                                in Chrome trace event format
 )";
 }
 
@@ -43,6 +50,7 @@ void overview(int status)
     std::cout <<
 R"(Available masters:
   serial        run at most one simulation overall
+  local         run several simulations in parallel on this machine
   mpi           run at most one simulation per launched MPI process
 See ')" << g_program_name << R"( <master> --help' for more info.
 
@@ -14,6 +14,7 @@
 #include "core/LongOptions.h"
 #include "core/Arguments.h"
 #include "core/OutputStreamHandler.h"
+#include "core/Tracer.h"
 
 #include "master/AbstractMaster.h"
 #include "controller/AbstractController.h"
@@ -27,11 +28,16 @@ std::chrono::milliseconds g_kill_timeout(100);
 
 bool g_ignore_errors = false;
 bool g_force_host_spawn = false;
+int g_worker_procs = 1;
 bool g_discard_child_stderr = false;
 
 bool g_program_terminated = false;
 
 std::string g_output_file;
+bool g_async_output = false;
+bool g_binary_output = false;
+std::string g_cache_file;
+std::string g_trace_file;
 
 // Is help flag
 bool is_help_flag(const std::string& flag)
@@ -47,6 +53,10 @@ void add_general_long_options(LongOptions& lopts)
     lopts.add({"discard-child-stderr", no_argument, nullptr, 'd'});
     lopts.add({"verbosity", required_argument, nullptr, 'v'});
     lopts.add({"output-file", required_argument, nullptr, 'o'});
+    lopts.add({"async-output", no_argument, nullptr, 'a'});
+    lopts.add({"output-format", required_argument, nullptr, 'u'});
+    lopts.add({"cache", required_argument, nullptr, 'c'});
+    lopts.add({"trace", required_argument, nullptr, 'x'});
 }
 
 // Process general options
@@ -78,6 +88,30 @@ void process_general_options(master_t master, controller_t controller,
 
     if (args.isOptionalArgumentSet("output-file"))
         g_output_file = args.optionalArgument("output-file");
+
+    if (args.isOptionalArgumentSet("async-output"))
+        g_async_output = true;
+
+    if (args.isOptionalArgumentSet("output-format"))
+    {
+        std::string arg = args.optionalArgument("output-format");
+
+        if (arg.compare("csv") == 0)
+            g_binary_output = false;
+        else if (arg.compare("binary") == 0)
+            g_binary_output = true;
+        else
+            help(master, controller, EXIT_FAILURE);
+    }
+
+    if (args.isOptionalArgumentSet("cache"))
+        g_cache_file = args.optionalArgument("cache");
+
+    if (args.isOptionalArgumentSet("trace"))
+    {
+        g_trace_file = args.optionalArgument("trace");
+        Tracer::enable();
+    }
 }
 
 int main(int argc, char *argv[])
@@ -153,6 +187,9 @@ int main(int argc, char *argv[])
     try
     {
         AbstractMaster::run(master, controller, args);
+
+        // Write remaining output, so that errors are reported
+        OutputStreamHandler::close();
     }
     catch (const std::exception& e)
     {
@@ -3,6 +3,8 @@
 
 #include <assert.h>
 
+#include "controller/AbstractController.h"
+
 #include "AbstractMaster.h"
 
 // Construct from pointer to program terminated flag
@@ -16,6 +18,11 @@ void AbstractMaster::assignController(
         std::shared_ptr<AbstractController> p_controller)
 {
     m_p_controller = p_controller;
+
+    // Open cache file for simulator of controller
+    if (!g_cache_file.empty())
+        m_p_cache.reset(new SimulationCache(g_cache_file,
+                    p_controller->getSimulator()));
 }
 
 // Getter for m_p_program_terminated
@@ -23,3 +30,32 @@ bool AbstractMaster::programTerminated() const
 {
     return *m_p_program_terminated;
 }
+
+// Return new task identifier
+task_id_t AbstractMaster::nextTaskId()
+{
+    return m_next_task_id++;
+}
+
+// Look up task in cache
+bool AbstractMaster::lookupCache(TaskHandler& task)
+{
+    if (!m_p_cache)
+        return false;
+
+    std::string output_string;
+    int error_code;
+    if (!m_p_cache->lookup(task.getInputString(), output_string, error_code))
+        return false;
+
+    task.recordOutputAndErrorCode(std::move(output_string), error_code);
+    return true;
+}
+
+// Add result of finished task to cache
+void AbstractMaster::insertCache(const TaskHandler& task)
+{
+    if (m_p_cache && !task.didErrorOccur())
+        m_p_cache->insert(task.getInputString(), task.getOutputString(),
+                task.getErrorCode());
+}
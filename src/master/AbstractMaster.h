@@ -7,6 +7,8 @@
 #include "core/common.h"
 #include "core/TaskHandler.h"
 
+#include "SimulationCache.h"
+
 class AbstractController;
 class LongOptions;
 class Arguments;
@@ -34,9 +36,17 @@ class Arguments;
  * pushPendingTask() and access finished tasks using frontFinishedTask().  The
  * AbstractMaster is responsible for popping tasks from the pending tasks
  * queue, running the corresponding simulation and pushing finished tasks to
- * the finished tasks queue.  The finished tasks should be pushed in the same
- * order as they were added to the pending tasks queue.  The flush() method
- * flushes all queues and discards all running simulations.
+ * the finished tasks queue.  Finished tasks may be pushed in the order in
+ * which they finish, which need not be the order in which they were added to
+ * the pending tasks queue.  Therefore, pushPendingTask() returns an
+ * identifier that is unique to the task and can be retrieved from the
+ * finished task with TaskHandler::getTaskId().  The flush() method flushes
+ * all queues and discards all running simulations.
+ *
+ * If a cache file is given with the general option `--cache`, the
+ * AbstractMaster looks up every pushed task in a SimulationCache.  Tasks that
+ * are found are finished immediately without running the simulator, and the
+ * results of all other successful tasks are added to the cache.
  *
  * The use of AbstractMaster is governed by static methods.  The static
  * addLongOptions() and help() methods determine which command-line options the
@@ -65,11 +75,17 @@ class AbstractMaster
         /** @return whether more pending tasks are needed. */
         virtual bool needMorePendingTasks() const = 0;
 
+        /** @return number of Workers that perform tasks at the same time. */
+        virtual int numWorkers() const = 0;
+
         /** Push a new pending task.
          *
-         * @param input_string  input string to simulation job.
+         * @param input_string  input string to simulation job, which is
+         * moved into the task.
+         *
+         * @return identifier of the new task.
          */
-        virtual void pushPendingTask(const std::string& input_string) = 0;
+        virtual task_id_t pushPendingTask(std::string input_string) = 0;
 
         /** @return whether finished tasks queue is empty. */
         virtual bool finishedTasksEmpty() const = 0;
@@ -167,6 +183,9 @@ class AbstractMaster
     protected:
 
         /** Assign pointer to AbstractController.
+         *
+         * If a cache file was given, the SimulationCache is opened for the
+         * simulator of the AbstractController.
          *
          * @param p_controller  pointer to AbstractController object to be
          * assigned to AbstractMaster.
@@ -180,6 +199,25 @@ class AbstractMaster
         /** @return whether the program has been terminated. */
         bool programTerminated() const;
 
+        /** @return a new task identifier. */
+        task_id_t nextTaskId();
+
+        /** Look up task in SimulationCache and, if it is found, record the
+         * cached output string and error code in the task.
+         *
+         * @param task  pending task.
+         *
+         * @return whether the task was found.
+         */
+        bool lookupCache(TaskHandler& task);
+
+        /** Add result of finished task to SimulationCache.  Tasks where an
+         * error occurred are not added, so that they are retried next time.
+         *
+         * @param task  finished task.
+         */
+        void insertCache(const TaskHandler& task);
+
         ///// Member variables /////
         /** Weak pointer to AbstractController. */
         std::weak_ptr<AbstractController> m_p_controller;
@@ -189,6 +227,12 @@ class AbstractMaster
         ///// Member variables /////
         // Pointer to program terminated flag
         bool *m_p_program_terminated;
+
+        // Next task identifier
+        task_id_t m_next_task_id = 0;
+
+        // Cache of simulation results, or null if no cache file was given
+        std::unique_ptr<SimulationCache> m_p_cache;
 };
 
 #endif // ABSTRACTMASTER_H
@@ -5,6 +5,8 @@
 
 #include "core/Command.h"
 
+class EventWaiter;
+
 /** An abstract class for representing Workers.
  *
  * Workers are instantiations of the simulator user executable.  Since they can
@@ -39,6 +41,12 @@ class AbstractWorkerHandler
         /** @return whether Worker has finished. */
         virtual bool isDone() = 0;
 
+        /** Register the events that signal progress of the Worker.
+         *
+         * @param waiter  EventWaiter to register events with.
+         */
+        virtual void registerEvents(EventWaiter& waiter) const = 0;
+
         /** @return output of finished Worker.
          *
          * @warning Calling this function before Worker is finished will result
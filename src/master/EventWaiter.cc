@@ -0,0 +1,148 @@
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+
+#include <mpi.h>
+
+#include "mpi/mpi_utils.h"
+
+#include "EventWaiter.h"
+
+// Length of first blocking slice
+static const std::chrono::microseconds INITIAL_SLICE(10);
+
+// Construct from spin timeout and maximum timeout
+EventWaiter::EventWaiter(std::chrono::microseconds spin_timeout,
+        std::chrono::microseconds max_timeout) :
+    m_spin_timeout(spin_timeout),
+    m_max_timeout(max_timeout)
+{
+}
+
+// Register file descriptor
+void EventWaiter::addFileDescriptor(int fd)
+{
+    m_fds.push_back(fd);
+}
+
+// Register MPI probe
+void EventWaiter::addProbe(int source, int tag, MPI_Comm comm)
+{
+    m_probes.push_back({source, tag, comm});
+}
+
+// Return immediately from next wait
+void EventWaiter::setReady()
+{
+    m_ready = true;
+}
+
+// Wait for event
+bool EventWaiter::wait()
+{
+    using std::chrono::steady_clock;
+    using std::chrono::microseconds;
+    using std::chrono::duration_cast;
+
+    // Record start time
+    const steady_clock::time_point start = steady_clock::now();
+    microseconds elapsed(0);
+
+    // Spin phase: check events without blocking
+    bool ready = m_ready;
+    while (!ready && (elapsed < m_spin_timeout) && (elapsed < m_max_timeout))
+    {
+        ready = probesReady() || fileDescriptorsReady(microseconds(0));
+        elapsed = duration_cast<microseconds>(steady_clock::now() - start);
+    }
+
+    // Block phase: block on file descriptors with exponentially growing
+    // slices, checking MPI probes in between
+    microseconds slice = INITIAL_SLICE;
+    while (!ready && (elapsed < m_max_timeout))
+    {
+        ready = probesReady() ||
+            fileDescriptorsReady(std::min(slice, m_max_timeout - elapsed));
+        elapsed = duration_cast<microseconds>(steady_clock::now() - start);
+        slice *= 2;
+    }
+
+    // Clear registered events
+    clear();
+
+    return ready;
+}
+
+// Check MPI probes
+bool EventWaiter::probesReady() const
+{
+    for (auto it = m_probes.begin(); it != m_probes.end(); it++)
+        if (iprobe_wrapper(it->source, it->tag, it->comm))
+            return true;
+
+    return false;
+}
+
+// Check file descriptors
+bool EventWaiter::fileDescriptorsReady(std::chrono::microseconds timeout) const
+{
+    // Initialize poll file descriptors
+    std::vector<struct pollfd> fds(m_fds.size());
+    for (std::size_t i = 0; i < m_fds.size(); i++)
+    {
+        fds[i].fd = m_fds[i];
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+
+    // Block until a file descriptor is readable or closed, or the timeout
+    // has elapsed.  If there are no file descriptors, this simply sleeps for
+    // the timeout.
+#ifdef __linux__
+    struct timespec ts;
+    ts.tv_sec = timeout.count() / 1000000;
+    ts.tv_nsec = (timeout.count() % 1000000) * 1000;
+    int retval = ppoll(fds.data(), fds.size(), &ts, nullptr);
+#else
+    // poll() has millisecond resolution, so round up nonzero timeouts
+    int retval = poll(fds.data(), fds.size(),
+            (timeout.count() + 999) / 1000);
+#endif
+
+    if (retval == -1)
+    {
+        // An interrupt counts as an event, since it may have set the program
+        // terminated flag
+        if (errno == EINTR)
+            return true;
+
+        std::runtime_error e("an error occurred while waiting for events");
+        throw e;
+    }
+
+    // Registering a file descriptor that is not open is an error
+    for (const struct pollfd& fd : fds)
+    {
+        if (fd.revents & POLLNVAL)
+        {
+            std::runtime_error e("an invalid file descriptor was registered "
+                    "to wait on");
+            throw e;
+        }
+    }
+
+    return retval > 0;
+}
+
+// Clear registered events
+void EventWaiter::clear()
+{
+    m_fds.clear();
+    m_probes.clear();
+    m_ready = false;
+}
@@ -0,0 +1,108 @@
+#ifndef EVENTWAITER_H
+#define EVENTWAITER_H
+
+#include <vector>
+#include <chrono>
+
+#include <mpi.h>
+
+/** A class for blocking an event loop until there is something to do.
+ *
+ * The event loops of the Masters and Managers only make progress when an MPI
+ * message arrives, when a Worker writes to its output pipe or when a helper
+ * or generator of the Controller writes to its output pipe.  Instead of
+ * sleeping for a fixed amount of time at every iteration, the event loop
+ * registers the events it is interested in with an EventWaiter and calls
+ * wait(), which returns as soon as any of the events is ready.
+ *
+ * Since MPI offers no way to block on a probe with a timeout, wait() uses an
+ * adaptive spin-then-block policy.  First, the events are checked in a busy
+ * loop for at most the spin timeout.  Then, the EventWaiter blocks on the
+ * registered file descriptors with `poll()`, checking the MPI probes in
+ * between, so that there is no limit on the number or values of the file
+ * descriptors.  On Linux, `ppoll()` is used for its microsecond resolution.
+ * The blocking slices start small and double every time, so that short gaps
+ * between events are noticed quickly while long gaps cost little CPU time.
+ * The total time spent in wait() never exceeds the maximum timeout, so that
+ * the event loop is guaranteed to iterate regularly.
+ *
+ * Registered events are cleared after every call to wait().
+ */
+
+class EventWaiter
+{
+    public:
+
+        /** Construct from spin timeout and maximum timeout.
+         *
+         * @param spin_timeout  time to busy-wait before blocking.
+         * @param max_timeout  maximum time to wait for an event.
+         */
+        EventWaiter(std::chrono::microseconds spin_timeout,
+                std::chrono::microseconds max_timeout);
+
+        /** Default destructor does nothing. */
+        ~EventWaiter() = default;
+
+        /** Register file descriptor to wait for until it is readable.
+         *
+         * @param fd  file descriptor.
+         */
+        void addFileDescriptor(int fd);
+
+        /** Register MPI message to wait for until it can be received.
+         *
+         * @param source  rank of source.
+         * @param tag  message tag.
+         * @param comm  MPI communicator.
+         */
+        void addProbe(int source, int tag, MPI_Comm comm);
+
+        /** Make the next call to wait() return immediately, because there is
+         * already something to do. */
+        void setReady();
+
+        /** Wait until any registered event is ready or until the maximum
+         * timeout has elapsed, then clear all registered events.
+         *
+         * @return whether a registered event is ready.
+         */
+        bool wait();
+
+    private:
+
+        // MPI probe
+        struct Probe
+        {
+            int source;
+            int tag;
+            MPI_Comm comm;
+        };
+
+        // Check MPI probes
+        bool probesReady() const;
+
+        // Check file descriptors, blocking for at most the given time
+        bool fileDescriptorsReady(std::chrono::microseconds timeout) const;
+
+        // Clear registered events
+        void clear();
+
+        ///// Member variables /////
+        // Time to busy-wait before blocking
+        const std::chrono::microseconds m_spin_timeout;
+
+        // Maximum time to wait
+        const std::chrono::microseconds m_max_timeout;
+
+        // Registered file descriptors
+        std::vector<int> m_fds;
+
+        // Registered MPI probes
+        std::vector<Probe> m_probes;
+
+        // Whether wait() should return immediately
+        bool m_ready = false;
+};
+
+#endif // EVENTWAITER_H
@@ -1,7 +1,5 @@
 #include <string>
-#include <thread>
 #include <stdexcept>
-#include <signal.h>
 #include <sys/wait.h>
 #include <sys/types.h>
 
@@ -10,6 +8,8 @@
 #include "system/pipe_io.h"
 #include "mpi/mpi_common.h"
 
+#include "EventWaiter.h"
+
 #include "ForkedWorkerHandler.h"
 
 ForkedWorkerHandler::ForkedWorkerHandler(
@@ -41,41 +41,12 @@ void ForkedWorkerHandler::terminate()
     // If already terminated, return immediately
     if (!m_child_pid) return;
 
-    // If simulation has finished, mark by setting m_child_pid to zero
-    if ( waitpid_success(m_child_pid, WNOHANG, m_simulator) )
-    {
-        m_child_pid = 0;
-        return;
-    }
-
-    // Send SIGTERM to child process
-    if ( kill(m_child_pid, SIGTERM) )
-    {
-        std::runtime_error e("an error occurred while trying to terminate "
-                             "child process");
-        throw e;
-    }
-
-    // Sleep for g_kill_timeout
-    std::this_thread::sleep_for(g_kill_timeout);
-
-    // If simulation has finished, mark by setting m_child_pid to zero
-    if ( waitpid_success(m_child_pid, WNOHANG, m_simulator, ignore_error) )
-    {
-        m_child_pid = 0;
-        return;
-    }
-
-    // Send SIGKILL to child process
-    if ( kill(m_child_pid, SIGKILL) )
-    {
-        std::runtime_error e("an error occurred while trying to kill "
-                             "child process");
-        throw e;
-    }
-
-     waitpid_success(m_child_pid, 0, m_simulator, ignore_error);
-     m_child_pid = 0;
+    // Terminate child process without waiting for it to exit, and mark by
+    // setting m_child_pid to zero.  The results of a terminated Worker are
+    // discarded, so its exit status is irrelevant.  Moreover, this function
+    // is called from the destructor, which must not throw.
+    terminate_process_async(m_child_pid, m_simulator, ignore_error);
+    m_child_pid = 0;
 }
 
 bool ForkedWorkerHandler::isDone()
@@ -96,3 +67,10 @@ bool ForkedWorkerHandler::isDone()
 
     return m_read_done;
 }
+
+void ForkedWorkerHandler::registerEvents(EventWaiter& waiter) const
+{
+    // Wait for output or closing of read pipe
+    if (!m_read_done)
+        waiter.addFileDescriptor(m_pipe_read_fd);
+}
@@ -43,12 +43,20 @@ class ForkedWorkerHandler : public AbstractWorkerHandler
          */
         virtual bool isDone() override;
 
+        /** Register read pipe with EventWaiter.
+         *
+         * @param waiter  EventWaiter to register read pipe with.
+         */
+        virtual void registerEvents(EventWaiter& waiter) const override;
+
     private:
 
         /** Terminate active Worker with system signals.
          *
          * Terminate simulation by sending `SIGTERM` first, followed by
-         * `SIGKILL` if process does not respond.
+         * `SIGKILL` if process does not respond.  This function does not
+         * wait for the process to exit; the process is reaped later by
+         * reap_terminating_processes().
          */
         void terminate();
 
@@ -0,0 +1,341 @@
+#include <string>
+#include <memory>
+#include <chrono>
+#include <queue>
+#include <list>
+#include <vector>
+#include <iterator>
+#include <cstdint>
+
+#include <assert.h>
+
+#include "spdlog/spdlog.h"
+
+#include "core/common.h"
+#include "core/Tracer.h"
+#include "system/system_call.h"
+#include "controller/AbstractController.h"
+
+#include "ForkedWorkerHandler.h"
+#include "PersistentWorkerHandler.h"
+#include "EventWaiter.h"
+
+#include "LocalMaster.h"
+
+// Construct from simulator, pointer to program terminated flag, number of
+// jobs, persistent simulator flag and in-order flag
+LocalMaster::LocalMaster(const Command& simulator,
+        bool *p_program_terminated, int num_jobs,
+        bool persistent_simulator, bool in_order) :
+    AbstractMaster(p_program_terminated),
+    m_simulator(simulator),
+    m_persistent_simulator(persistent_simulator),
+    m_in_order(in_order),
+    m_p_worker_handlers(num_jobs),
+    m_map_slot_to_task(num_jobs),
+    m_slot_start_times(num_jobs)
+{
+    // Initialize idle Worker slots
+    for (int i = 0; i < num_jobs; i++)
+        m_idle_slots.insert(i);
+}
+
+// Terminate running Workers
+LocalMaster::~LocalMaster()
+{
+    terminateWorkers();
+}
+
+// Probe whether Master is active
+bool LocalMaster::isActive() const
+{
+    return m_state != terminated;
+}
+
+// Iterate
+void LocalMaster::iterate()
+{
+    // This function should never be called recursively
+    assert(!m_entered);
+    m_entered = true;
+
+    // This function should never be called if the Master has
+    // terminated
+    assert(m_state != terminated);
+
+    // Check for program termination interrupt
+    if (programTerminated())
+    {
+        // Terminate Workers
+        terminateWorkers();
+
+        // Terminate Master
+        m_state = terminated;
+        m_entered = false;
+        return;
+    }
+
+    // Reap terminated Workers that have exited and kill those that have
+    // outlived the kill timeout
+    reap_terminating_processes();
+
+    // Tasks found in the cache are delivered below
+    m_cached_tasks_ready = false;
+
+    // Check Workers
+    checkWorkers();
+
+    // Pop finished tasks from busy queue and insert into finished queue
+    popBusyQueue();
+
+    // Call controller
+    if (auto p_controller = m_p_controller.lock())
+        p_controller->iterate();
+
+    // Start Workers unless the controller has terminated the Master
+    if (m_state != terminated)
+        startWorkers();
+
+    m_entered = false;
+}
+
+// Returns true if more pending tasks are needed
+bool LocalMaster::needMorePendingTasks() const
+{
+    return m_pending_tasks.size() < m_p_worker_handlers.size();
+}
+
+// Returns number of Workers
+int LocalMaster::numWorkers() const
+{
+    return m_p_worker_handlers.size();
+}
+
+// Push pending task
+task_id_t LocalMaster::pushPendingTask(std::string input_string)
+{
+    task_id_t task_id = nextTaskId();
+    m_pending_tasks.emplace(std::move(input_string), task_id);
+    Tracer::record(Tracer::task_event, 'b', task_id);
+
+    // Tasks found in the cache stay in the pending queue to preserve their
+    // order, but are not given to a Worker
+    lookupCache(m_pending_tasks.back());
+
+    return task_id;
+}
+
+// Returns whether finished tasks queue is empty
+bool LocalMaster::finishedTasksEmpty() const
+{
+    return m_finished_tasks.empty();
+}
+
+// Returns reference to front finished task
+TaskHandler& LocalMaster::frontFinishedTask()
+{
+    return m_finished_tasks.front();
+}
+
+// Pop finished task
+void LocalMaster::popFinishedTask()
+{
+    Tracer::record(Tracer::task_event, 'e',
+            m_finished_tasks.front().getTaskId());
+    m_finished_tasks.pop();
+}
+
+// Flush finished, busy and pending tasks
+void LocalMaster::flush()
+{
+    Tracer::Span span(Tracer::flush_event);
+    span.setValue(m_finished_tasks.size() + m_busy_tasks.size()
+            + m_pending_tasks.size());
+
+    // Terminate busy Workers
+    terminateWorkers();
+
+    // Flush all TaskHandler queues
+    while (!m_finished_tasks.empty())
+    {
+        Tracer::record(Tracer::task_event, 'e',
+                m_finished_tasks.front().getTaskId());
+        m_finished_tasks.pop();
+    }
+
+    for (const TaskHandler& task : m_busy_tasks)
+        Tracer::record(Tracer::task_event, 'e', task.getTaskId());
+    m_busy_tasks.clear();
+
+    while (!m_pending_tasks.empty())
+    {
+        Tracer::record(Tracer::task_event, 'e',
+                m_pending_tasks.front().getTaskId());
+        m_pending_tasks.pop();
+    }
+}
+
+// Terminate Master
+void LocalMaster::terminate()
+{
+    // Terminate Workers
+    terminateWorkers();
+
+    m_state = terminated;
+}
+
+// Register events
+void LocalMaster::registerEvents(EventWaiter& waiter) const
+{
+    // Deliver tasks found in the cache without waiting
+    if (m_cached_tasks_ready)
+        waiter.setReady();
+
+    // Wait for Workers
+    for (auto it = m_p_worker_handlers.begin();
+            it != m_p_worker_handlers.end(); it++)
+        if (*it)
+            (*it)->registerEvents(waiter);
+
+    // Wait for Controller
+    if (auto p_controller = m_p_controller.lock())
+        p_controller->registerEvents(waiter);
+}
+
+// Check Workers and record results of finished tasks
+void LocalMaster::checkWorkers()
+{
+    for (int slot = 0; slot < static_cast<int>(m_p_worker_handlers.size());
+            slot++)
+    {
+        // Skip idle and unfinished Workers
+        if (!m_p_worker_handlers[slot] || !m_p_worker_handlers[slot]->isDone())
+            continue;
+
+        // Record output string, error code and wall time
+        auto it = m_map_slot_to_task[slot];
+        std::chrono::duration<double> wall_time =
+            std::chrono::steady_clock::now() - m_slot_start_times[slot];
+        Tracer::recordSpan(Tracer::simulate_event, slot + 1,
+                Tracer::timestamp(m_slot_start_times[slot]), it->getTaskId());
+        it->recordOutputAndErrorCode(m_p_worker_handlers[slot]->getOutput(),
+                m_p_worker_handlers[slot]->getErrorCode(), wall_time.count());
+
+        // Add result to cache
+        insertCache(*it);
+
+        // Unless finished tasks are delivered in submission order, move
+        // TaskHandler to finished tasks immediately
+        if (!m_in_order)
+        {
+            m_finished_tasks.push(std::move(*it));
+            m_busy_tasks.erase(it);
+        }
+
+        // Flush Worker and mark Worker slot as idle
+        m_p_worker_handlers[slot].reset();
+        m_idle_slots.insert(slot);
+    }
+}
+
+// Pop finished tasks from busy queue and insert into finished queue.  If
+// finished tasks are not delivered in submission order, they have already
+// been moved by checkWorkers(), so there is nothing to do.
+void LocalMaster::popBusyQueue()
+{
+    // While there are finished tasks (or tasks where errors occured) in the
+    // front of the queue
+    while (!m_busy_tasks.empty() && !m_busy_tasks.front().isPending())
+    {
+        // Move TaskHandler to finished tasks
+        m_finished_tasks.push(std::move(m_busy_tasks.front()));
+
+        // Pop front TaskHandler from busy queue
+        m_busy_tasks.pop_front();
+    }
+}
+
+// Start Workers for pending tasks on idle Worker slots.  Tasks that were
+// found in the cache are moved on without starting a Worker.
+void LocalMaster::startWorkers()
+{
+    // While there are pending tasks
+    auto it = m_idle_slots.begin();
+    while (!m_pending_tasks.empty())
+    {
+        // Move task that was found in the cache to busy queue, so that it is
+        // delivered in order, or else to finished queue
+        if (!m_pending_tasks.front().isPending())
+        {
+            if (m_in_order)
+                m_busy_tasks.push_back(std::move(m_pending_tasks.front()));
+            else
+                m_finished_tasks.push(std::move(m_pending_tasks.front()));
+
+            m_pending_tasks.pop();
+            m_cached_tasks_ready = true;
+            continue;
+        }
+
+        // Stop if there are no idle Worker slots
+        if (it == m_idle_slots.end())
+            break;
+
+        spdlog::debug("LocalMaster::startWorkers: "
+                "starting Worker in slot {}", *it);
+
+        // Start Worker
+        const task_id_t task_id = m_pending_tasks.front().getTaskId();
+        Tracer::record(Tracer::dispatch_event, 'n', task_id, *it);
+        const std::int64_t spawn_start = Tracer::now();
+        createWorker(*it, m_pending_tasks.front().getInputString());
+        Tracer::recordSpan(Tracer::spawn_event, *it + 1, spawn_start, task_id);
+        m_slot_start_times[*it] = std::chrono::steady_clock::now();
+
+        // Move pending TaskHandler to busy queue
+        m_busy_tasks.push_back(std::move(m_pending_tasks.front()));
+
+        // Pop front TaskHandler from pending queue
+        m_pending_tasks.pop();
+
+        // Set map from Worker slot to TaskHandler
+        m_map_slot_to_task[*it] = std::prev(m_busy_tasks.end());
+
+        it++;
+    }
+
+    // Mark Worker slots as busy
+    m_idle_slots.erase(m_idle_slots.begin(), it);
+}
+
+// Terminate Workers
+void LocalMaster::terminateWorkers()
+{
+    for (int slot = 0; slot < static_cast<int>(m_p_worker_handlers.size());
+            slot++)
+    {
+        // Reset Worker handler to null pointer and mark Worker slot as idle
+        if (m_p_worker_handlers[slot])
+        {
+            m_p_worker_handlers[slot].reset();
+            m_idle_slots.insert(slot);
+        }
+    }
+}
+
+// Create Worker in slot
+void LocalMaster::createWorker(int slot, const std::string& input_string)
+{
+    // Sanity check: Worker slot should be idle
+    assert(!m_p_worker_handlers[slot]);
+
+    if (m_persistent_simulator)
+        m_p_worker_handlers[slot] =
+            std::unique_ptr<PersistentWorkerHandler>(
+                    new PersistentWorkerHandler(m_simulator, input_string,
+                        slot));
+    else
+        m_p_worker_handlers[slot] =
+            std::unique_ptr<ForkedWorkerHandler>(
+                    new ForkedWorkerHandler(m_simulator, input_string));
+}
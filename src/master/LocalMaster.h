@@ -0,0 +1,207 @@
+#ifndef LOCALMASTER_H
+#define LOCALMASTER_H
+
+#include <string>
+#include <queue>
+#include <list>
+#include <vector>
+#include <set>
+#include <memory>
+#include <chrono>
+
+#include "core/common.h"
+#include "core/Command.h"
+
+#include "AbstractMaster.h"
+
+class LongOptions;
+class Arguments;
+class AbstractWorkerHandler;
+class EventWaiter;
+
+/** A Master class for performing simulation tasks in parallel on the local
+ * machine.
+ *
+ * The LocalMaster class performs simulation tasks in parallel by running up
+ * to a fixed number of Workers at the same time.  The Workers are either
+ * forked Workers (see ForkedWorkerHandler) or persistent Workers (see
+ * PersistentWorkerHandler).  In contrast with MPIMaster, LocalMaster does not
+ * use MPI, so Pakman does not need to be launched with `mpiexec`.
+ *
+ * The LocalMaster is run in an event loop that blocks on the output pipes of
+ * the Workers (see EventWaiter), so that it wakes up as soon as any Worker
+ * makes progress.
+ *
+ * By default, finished tasks are pushed to the finished tasks queue as soon
+ * as their results arrive.  For reproducibility, the LocalMaster can instead
+ * be made to deliver finished tasks in the order in which they were pushed.
+ *
+ * For instructions on how to use Pakman with the local master, execute the
+ * following command
+ * ```
+ * $ pakman local --help
+ * ```
+ */
+
+class LocalMaster : public AbstractMaster
+{
+    public:
+
+        /** Constructor saves simulator command and program termination flag.
+         *
+         * @param simulator  command to run simulation.
+         * @param p_program_terminated  pointer to boolean flag that is set
+         * when the execution of Pakman is terminated by the user.
+         * @param num_jobs  maximum number of Workers running at the same
+         * time.
+         * @param persistent_simulator  whether the simulator is a persistent
+         * simulator.
+         * @param in_order  whether to deliver finished tasks in the order in
+         * which they were pushed.
+         */
+        LocalMaster(const Command& simulator, bool *p_program_terminated,
+                int num_jobs, bool persistent_simulator = false,
+                bool in_order = false);
+
+        /** Destructor terminates any running Workers. */
+        virtual ~LocalMaster() override;
+
+        /** @return whether the LocalMaster is active. */
+        virtual bool isActive() const override;
+
+        /** @return whether more pending tasks are needed. */
+        virtual bool needMorePendingTasks() const override;
+
+        /** @return number of Workers that perform tasks at the same time. */
+        virtual int numWorkers() const override;
+
+        /** Push a new pending task.
+         *
+         * @param input_string  input string to simulation job.
+         *
+         * @return identifier of the new task.
+         */
+        virtual task_id_t pushPendingTask(std::string input_string)
+            override;
+
+        /** @return whether finished tasks queue is empty. */
+        virtual bool finishedTasksEmpty() const override;
+
+        /** @return reference to front finished task. */
+        virtual TaskHandler& frontFinishedTask() override;
+
+        /** Pop front finished task. */
+        virtual void popFinishedTask() override;
+
+        /** Flush all finished, busy and pending tasks. */
+        virtual void flush() override;
+
+        /** Terminate LocalMaster. */
+        virtual void terminate() override;
+
+        /** Register the events that the LocalMaster is waiting for.
+         *
+         * The LocalMaster waits for its busy Workers and its Controller to
+         * make progress.
+         *
+         * @param waiter  EventWaiter to register events with.
+         */
+        void registerEvents(EventWaiter& waiter) const;
+
+        /** @return help message string. */
+        static std::string help();
+
+        /** Add long command-line options.
+         *
+         * @param lopts  long command-line options that the LocalMaster needs.
+         */
+        static void addLongOptions(LongOptions& lopts);
+
+        /** Run LocalMaster in an event loop.
+         *
+         * This function creates the LocalMaster and Controller objects, and
+         * runs them in an event loop.
+         *
+         * @param controller  controller type.
+         * @param args  command-line arguments.
+         */
+        static void run(controller_t controller, const Arguments& args);
+
+        /** Shut down persistent simulators if there are any. */
+        static void cleanup();
+
+    protected:
+
+        /** Iterates the LocalMaster in an event loop. */
+        virtual void iterate() override;
+
+    private:
+
+        /** Enumerate type for LocalMaster states.
+         *
+         * The LocalMaster can either in a `normal` state, or in a
+         * `terminated` state.  When the LocalMaster is in a `terminated`
+         * state, the member function isActive() will return false and the
+         * event loop should terminate.
+         */
+        enum state_t { normal, terminated };
+
+        ///// Member functions /////
+        // Check Workers and record results of finished tasks
+        void checkWorkers();
+
+        // Pop finished tasks from busy queue and insert into finished queue
+        void popBusyQueue();
+
+        // Start Workers for pending tasks on idle Worker slots
+        void startWorkers();
+
+        // Terminate all Workers
+        void terminateWorkers();
+
+        // Create Worker in slot
+        void createWorker(int slot, const std::string& input_string);
+
+        ///// Member variables /////
+        // Initial state is normal
+        state_t m_state = normal;
+
+        // Simulator command
+        const Command m_simulator;
+
+        // Whether simulator is persistent
+        const bool m_persistent_simulator;
+
+        // Flag for delivering finished tasks in submission order
+        const bool m_in_order;
+
+        // Pointers to Worker handlers, indexed by Worker slot
+        std::vector<std::unique_ptr<AbstractWorkerHandler>>
+            m_p_worker_handlers;
+
+        // Set of idle Worker slots
+        std::set<int> m_idle_slots;
+
+        // Mapping from Worker slot to corresponding task
+        std::vector<std::list<TaskHandler>::iterator> m_map_slot_to_task;
+
+        // Start times of tasks running on Worker slots
+        std::vector<std::chrono::steady_clock::time_point> m_slot_start_times;
+
+        // Finished tasks
+        std::queue<TaskHandler> m_finished_tasks;
+
+        // Busy tasks
+        std::list<TaskHandler> m_busy_tasks;
+
+        // Pending tasks
+        std::queue<TaskHandler> m_pending_tasks;
+
+        // Whether tasks found in the cache await delivery
+        bool m_cached_tasks_ready = false;
+
+        // Entered iterate()
+        bool m_entered = false;
+};
+
+#endif // LOCALMASTER_H
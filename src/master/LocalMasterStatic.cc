@@ -0,0 +1,172 @@
+#include <chrono>
+#include <string>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include <getopt.h>
+
+#include "core/common.h"
+#include "core/Arguments.h"
+#include "core/LongOptions.h"
+#include "core/Command.h"
+#include "core/Tracer.h"
+#include "system/signal_handler.h"
+#include "system/debug.h"
+#include "system/system_call.h"
+#include "main/help.h"
+#include "controller/AbstractController.h"
+
+#include "PersistentWorkerHandler.h"
+#include "EventWaiter.h"
+
+#include "LocalMaster.h"
+
+// Static help function
+std::string LocalMaster::help()
+{
+    return
+R"(* Help message for 'local' master *
+
+Description:
+  The local master runs several instances of the simulator, also called
+  "workers", in parallel on the local machine.  In contrast with the MPI
+  master, it does not use MPI, so pakman does not need to be launched with
+  mpiexec.  The optional argument --jobs sets the maximum number of workers
+  that run at the same time.  By default, this is the number of processors of
+  the local machine.
+
+  It is assumed that the simulator is a standard simulator, which means that
+  it communicates with pakman through its stdin and stdout.  If the optional
+  argument --persistent-simulator is given, the simulator is assumed to be a
+  persistent simulator.  Every worker then starts the simulator only once and
+  sends it all of its simulations one after the other.  See 'pakman serial
+  --help' for a description of the persistent simulator protocol.
+
+  The local master is implemented using an event loop that blocks until a
+  worker produces output.  The optional argument --main-timeout gives an upper
+  bound on the time spent waiting at each iteration of the event loop.
+
+  When a worker needs to be shut down, for example when the algorithm has
+  finished, pakman first sends SIGTERM to the worker.  If the worker has not
+  exited after a fixed amount of time, it is killed by sending the SIGKILL
+  signal.  The amount of time between sending SIGTERM and SIGKILL can be
+  changed using the optional argument --kill-timeout.
+
+  By default, the results of simulations are passed on to the controller as
+  soon as they arrive.  The flag --in-order can be used to pass on results in
+  the order in which the simulations were submitted, which is needed for
+  reproducible results.
+
+Local master options:
+  -j, --jobs=NUM               run up to NUM workers at the same time
+                               (default number of processors)
+  -l, --persistent-simulator   simulator is a persistent simulator
+  -O, --in-order               deliver results to the controller in the
+                               order in which the tasks were submitted
+  -t, --main-timeout=TIME      wait at most TIME ms in event loop (default 1)
+  -k, --kill-timeout=TIME      wait for TIME ms before sending SIGKILL
+                               (default 100)
+)";
+}
+
+// Static addLongOptions function
+void LocalMaster::addLongOptions(LongOptions& lopts)
+{
+    lopts.add({"jobs", required_argument, nullptr, 'j'});
+    lopts.add({"persistent-simulator", no_argument, nullptr, 'l'});
+    lopts.add({"in-order", no_argument, nullptr, 'O'});
+    lopts.add({"main-timeout", required_argument, nullptr, 't'});
+    lopts.add({"kill-timeout", required_argument, nullptr, 'k'});
+}
+
+// Static run function
+void LocalMaster::run(controller_t controller, const Arguments& args)
+{
+    // Process optional arguments
+    int num_jobs = std::thread::hardware_concurrency();
+    if (num_jobs < 1)
+        num_jobs = 1;
+
+    if (args.isOptionalArgumentSet("jobs"))
+    {
+        std::string&& arg = args.optionalArgument("jobs");
+        num_jobs = std::stoi(arg);
+
+        if (num_jobs < 1)
+        {
+            std::cout << "Error: --jobs must be at least 1\n";
+            ::help(local, controller, EXIT_FAILURE);
+        }
+    }
+
+    if (args.isOptionalArgumentSet("main-timeout"))
+    {
+        std::string&& arg = args.optionalArgument("main-timeout");
+        g_main_timeout = std::chrono::milliseconds(std::stoi(arg));
+    }
+
+    if (args.isOptionalArgumentSet("kill-timeout"))
+    {
+        std::string&& arg = args.optionalArgument("kill-timeout");
+        g_kill_timeout = std::chrono::milliseconds(std::stoi(arg));
+    }
+
+    // Set signal handlers
+    set_handlers();
+    set_signal_handler();
+
+    // Create controller and LocalMaster
+    std::shared_ptr<AbstractController>
+        p_controller(AbstractController::makeController(controller, args));
+
+    auto p_master =
+        std::make_shared<LocalMaster>(p_controller->getSimulator(),
+                &g_program_terminated, num_jobs,
+                args.isOptionalArgumentSet("persistent-simulator"),
+                args.isOptionalArgumentSet("in-order"));
+
+    // Associate with each other
+    p_master->assignController(p_controller);
+    p_controller->assignMaster(p_master);
+
+    // Create EventWaiter for event loop
+    EventWaiter waiter(std::chrono::microseconds(0), g_main_timeout);
+
+    // Start event loop
+    while (p_master->isActive())
+    {
+        p_master->iterate();
+
+        // Wait for next event
+        if (p_master->isActive())
+        {
+            p_master->registerEvents(waiter);
+            waiter.wait();
+        }
+    }
+
+    // Destroy Master and Controller
+    p_master.reset();
+    p_controller.reset();
+
+    // Shut down persistent simulators
+    PersistentWorkerHandler::terminateStatic();
+
+    // Wait for terminated processes to exit
+    wait_terminating_processes();
+
+    // Write trace
+    if (Tracer::isEnabled())
+        Tracer::write(g_trace_file, {Tracer::events()});
+}
+
+// Static cleanup function
+void LocalMaster::cleanup()
+{
+    // Shut down persistent simulators
+    PersistentWorkerHandler::terminateStatic();
+
+    // Wait for terminated processes to exit
+    wait_terminating_processes();
+}
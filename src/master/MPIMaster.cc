@@ -2,6 +2,12 @@
 #include <memory>
 #include <string>
 #include <queue>
+#include <list>
+#include <map>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <cmath>
 
 #include <assert.h>
 
@@ -9,26 +15,36 @@
 
 #include "spdlog/spdlog.h"
 
+#include "core/Tracer.h"
 #include "mpi/mpi_utils.h"
 #include "mpi/mpi_common.h"
 #include "controller/AbstractController.h"
 
+#include "EventWaiter.h"
+
 #include "MPIMaster.h"
 
-// Construct from pointer to program terminated flag
-MPIMaster::MPIMaster(bool *p_program_terminated) :
+// Construct from pointer to program terminated flag, in-order flag, number
+// of Worker slots per Manager, maximum batch size, batch time and prefetch
+// depth
+MPIMaster::MPIMaster(bool *p_program_terminated, bool in_order,
+        int slots_per_rank, int max_batch_size, double batch_time,
+        int prefetch) :
     AbstractMaster(p_program_terminated),
     m_comm_size(get_mpi_comm_world_size()),
-    m_map_manager_to_task(get_mpi_comm_world_size()),
+    m_slots_per_rank(slots_per_rank),
+    m_max_batch_size(max_batch_size),
+    m_batch_time(batch_time),
+    m_prefetch(prefetch),
+    m_in_order(in_order),
+    m_outstanding_tasks(get_mpi_comm_world_size(), 0),
     m_message_buffers(get_mpi_comm_world_size())
 {
     // Initialize requests to MPI_REQUEST_NULL
-    // and initialize idle managers
     for (int i = 0; i < m_comm_size; i++)
     {
         m_message_requests.push_back(MPI_REQUEST_NULL);
         m_signal_requests.push_back(MPI_REQUEST_NULL);
-        m_idle_managers.insert(i);
     }
 }
 
@@ -90,7 +106,13 @@ void MPIMaster::iterate()
 // Returns true if more pending tasks are needed
 bool MPIMaster::needMorePendingTasks() const
 {
-    return m_pending_tasks.size() < m_comm_size;
+    return m_pending_tasks.size() < m_comm_size * managerCapacity();
+}
+
+// Returns number of Workers
+int MPIMaster::numWorkers() const
+{
+    return m_comm_size * m_slots_per_rank;
 }
 
 // Do normal stuff
@@ -107,6 +129,10 @@ void MPIMaster::doNormalStuff()
         m_state = terminated;
         return;
     }
+
+    // Tasks found in the cache are delivered below
+    m_cached_tasks_ready = false;
+
     // Listen to Managers
     listenToManagers();
 
@@ -174,23 +200,16 @@ void MPIMaster::doFlushingStuff()
         return;
     }
 
-    // Discard messages, error codes and signals
-    discardMessagesErrorCodesAndSignals();
+    // Discard messages and signals
+    discardMessagesAndSignals();
 
-    // If all Managers are idle, transition to normal state
-    if (m_idle_managers.size() == m_comm_size)
+    // If no Manager has outstanding tasks, transition to normal state
+    if (!anyOutstandingTasks())
     {
         // Debug info
-        if (spdlog::get(g_program_name)->level() <= spdlog::level::debug)
-        {
-            spdlog::debug("MPIMaster::doFlushingStuff: "
-                    "transition to normal state!");
-            spdlog::debug("Idle managers:");
-            for (auto it = m_idle_managers.begin();
-                    it != m_idle_managers.end(); it++)
-                spdlog::debug("{}", *it);
-            spdlog::debug("-- END --");
-        }
+        spdlog::debug("MPIMaster::doFlushingStuff: "
+                "transition to normal state!");
+        debugOutstandingTasks();
 
         m_state = normal;
         return;
@@ -198,9 +217,17 @@ void MPIMaster::doFlushingStuff()
 }
 
 // Push pending task
-void MPIMaster::pushPendingTask(const std::string& input_string)
+task_id_t MPIMaster::pushPendingTask(std::string input_string)
 {
-    m_pending_tasks.push(input_string);
+    task_id_t task_id = nextTaskId();
+    m_pending_tasks.emplace(std::move(input_string), task_id);
+    Tracer::record(Tracer::task_event, 'b', task_id);
+
+    // Tasks found in the cache stay in the pending queue to preserve their
+    // order, but are not given to a Worker
+    lookupCache(m_pending_tasks.back());
+
+    return task_id;
 }
 
 // Returns whether finished tasks queue is empty
@@ -218,12 +245,18 @@ TaskHandler& MPIMaster::frontFinishedTask()
 // Pop finished task
 void MPIMaster::popFinishedTask()
 {
+    Tracer::record(Tracer::task_event, 'e',
+            m_finished_tasks.front().getTaskId());
     m_finished_tasks.pop();
 }
 
 // Flush finished, busy and pending tasks
 void MPIMaster::flush()
 {
+    Tracer::Span span(Tracer::flush_event);
+    span.setValue(m_finished_tasks.size() + m_busy_tasks.size()
+            + m_pending_tasks.size());
+
     m_worker_flushed = true;
 
     // Flush all TaskHandler queues
@@ -246,21 +279,54 @@ void MPIMaster::listenToManagers()
         int manager_rank = probeMessageManager();
 
         // Receive message
-        std::string&& output_string = receiveMessage(manager_rank);
-
-        // Receive error code
-        int error_code = receiveErrorCode(manager_rank);
+        std::vector<char> buffer = receiveMessage(manager_rank);
+        int position = 0;
 
-        // Record output string
-        m_map_manager_to_task[manager_rank]->recordOutputAndErrorCode(
-                output_string, error_code);
+        // Unpack number of finished tasks, followed by task identifier,
+        // error code, duration and output string of every finished task
+        int num_tasks = unpack_integer(MPI_COMM_WORLD, buffer, position);
+        for (int i = 0; i < num_tasks; i++)
+        {
+            task_id_t task_id =
+                unpack_task_id(MPI_COMM_WORLD, buffer, position);
+            int error_code = unpack_integer(MPI_COMM_WORLD, buffer, position);
+            double duration = unpack_double(MPI_COMM_WORLD, buffer, position);
+            std::string output_string =
+                unpack_string(MPI_COMM_WORLD, buffer, position);
+            Tracer::record(Tracer::receive_event, 'n', task_id,
+                    manager_rank);
+
+            // Update batch size
+            updateBatchSize(duration);
+
+            // Record output string
+            auto jt = m_map_id_to_task.find(task_id);
+            assert(jt != m_map_id_to_task.end());
+            auto it = jt->second;
+            m_map_id_to_task.erase(jt);
+            it->recordOutputAndErrorCode(std::move(output_string), error_code,
+                    duration);
+
+            // Add result to cache
+            insertCache(*it);
+
+            // Unless finished tasks are delivered in submission order, move
+            // TaskHandler to finished tasks immediately
+            if (!m_in_order)
+            {
+                m_finished_tasks.push(std::move(*it));
+                m_busy_tasks.erase(it);
+            }
+        }
 
-        // Mark manager as idle
-        m_idle_managers.insert(manager_rank);
+        // Decrement number of outstanding tasks
+        m_outstanding_tasks[manager_rank] -= num_tasks;
     }
 }
 
-// Pop finished tasks from busy queue and insert into finished queue
+// Pop finished tasks from busy queue and insert into finished queue.  If
+// finished tasks are not delivered in submission order, they have already
+// been moved by listenToManagers(), so there is nothing to do.
 void MPIMaster::popBusyQueue()
 {
     // If busy queue is empty, return immediately
@@ -281,7 +347,7 @@ void MPIMaster::popBusyQueue()
         m_finished_tasks.push(std::move(m_busy_tasks.front()));
 
         // Pop front TaskHandler from busy queue
-        m_busy_tasks.pop();
+        m_busy_tasks.pop_front();
 
         spdlog::debug("MPIMaster::popBusyQueue: "
                 "Done moving TaskHandler from busy to finished!");
@@ -291,72 +357,129 @@ void MPIMaster::popBusyQueue()
     }
 }
 
-// Delegate to Managers
-void MPIMaster::delegateToManagers()
+// Move tasks at the front of the pending queue that were found in the cache
+// to the busy queue, so that they are delivered in order, or else to the
+// finished queue
+bool MPIMaster::moveCachedTasks()
 {
-    if (spdlog::get(g_program_name)->level() <= spdlog::level::debug)
+    bool moved = false;
+    while (!m_pending_tasks.empty() && !m_pending_tasks.front().isPending())
     {
-        spdlog::debug("MPIMaster::delegateToManagers: entered!");
-        spdlog::debug("Idle managers:");
-        for (auto it = m_idle_managers.begin();
-                it != m_idle_managers.end(); it++)
-            spdlog::debug("{}", *it);
-        spdlog::debug("-- END --");
+        if (m_in_order)
+            m_busy_tasks.push_back(std::move(m_pending_tasks.front()));
+        else
+            m_finished_tasks.push(std::move(m_pending_tasks.front()));
+
+        m_pending_tasks.pop();
+        moved = true;
+        m_cached_tasks_ready = true;
     }
 
-    // While there are idle managers
-    auto it = m_idle_managers.begin();
-    for (; (it != m_idle_managers.end()) && !m_pending_tasks.empty(); it++)
-    {
-        spdlog::debug("MPIMaster::delegateToManagers: "
-                "Moving TaskHandler from pending to busy!");
-        spdlog::debug("finished, busy, pending: {}, {}, {}",
-                m_finished_tasks.size(), m_busy_tasks.size(),
-                m_pending_tasks.size());
+    return moved;
+}
 
-        // Send message to Manager
-        sendMessageToManager(*it, m_pending_tasks.front().getInputString());
+// Delegate to Managers
+void MPIMaster::delegateToManagers()
+{
+    spdlog::debug("MPIMaster::delegateToManagers: entered!");
+    debugOutstandingTasks();
 
-        // Move pending TaskHandler to busy queue
-        m_busy_tasks.push(std::move(m_pending_tasks.front()));
+    // Maximum number of outstanding tasks of every Manager
+    const int capacity = managerCapacity();
 
-        // Pop front TaskHandler from pending queue
-        m_pending_tasks.pop();
+    // Move tasks at the front of the pending queue that were found in the
+    // cache, so that they do not wait for a Manager with free capacity
+    moveCachedTasks();
 
-        // Set map from Manager to TaskHandler
-        m_map_manager_to_task[*it] = &m_busy_tasks.back();
+    for (int manager_rank = 0;
+            (manager_rank < m_comm_size) && !m_pending_tasks.empty();
+            manager_rank++)
+    {
+        // Only send tasks to a Manager once it can take at least one batch
+        // of tasks for a Worker slot, so that messages are not wasted on
+        // single tasks when the batch size is large
+        int free = capacity - m_outstanding_tasks[manager_rank];
+        if (free < m_batch_size)
+            continue;
+
+        // Move pending TaskHandlers to busy queue
+        std::vector<task_id_t> task_ids;
+        while ((free > 0) && !m_pending_tasks.empty())
+        {
+            if (moveCachedTasks())
+                continue;
 
-        spdlog::debug("MPIMaster::delegateToManagers: "
-                "Done moving TaskHandler from pending to busy!");
-        spdlog::debug("finished, busy, pending: {}, {}, {}",
-                m_finished_tasks.size(), m_busy_tasks.size(),
-                m_pending_tasks.size());
-    }
+            m_busy_tasks.push_back(std::move(m_pending_tasks.front()));
+            m_pending_tasks.pop();
 
-    // Mark Managers as busy
-    m_idle_managers.erase(m_idle_managers.begin(), it);
+            // Set map from task identifier to TaskHandler
+            task_id_t task_id = m_busy_tasks.back().getTaskId();
+            m_map_id_to_task[task_id] = std::prev(m_busy_tasks.end());
+            task_ids.push_back(task_id);
+            Tracer::record(Tracer::dispatch_event, 'n', task_id,
+                    manager_rank);
 
-    if (spdlog::get(g_program_name)->level() <= spdlog::level::debug)
-    {
-        spdlog::debug("MPIMaster::delegateToManagers: exiting");
-        spdlog::debug("Idle managers:");
-        for (auto it = m_idle_managers.begin();
-                it != m_idle_managers.end(); it++)
-            spdlog::debug("{}", *it);
-        spdlog::debug("-- END --");
+            free--;
+        }
+
+        // Send batch to Manager, unless all remaining pending tasks were
+        // found in the cache
+        if (!task_ids.empty())
+        {
+            m_outstanding_tasks[manager_rank] += task_ids.size();
+            sendMessageToManager(manager_rank, task_ids);
+        }
     }
+
+    spdlog::debug("MPIMaster::delegateToManagers: exiting");
+    debugOutstandingTasks();
+}
+
+// Register events
+void MPIMaster::registerEvents(EventWaiter& waiter) const
+{
+    // Deliver tasks found in the cache without waiting
+    if (m_cached_tasks_ready)
+        waiter.setReady();
+
+    // Wait for messages from Managers
+    waiter.addProbe(MPI_ANY_SOURCE, MANAGER_MSG_TAG, MPI_COMM_WORLD);
+
+    // When flushing, also wait for signals from Managers
+    if (m_state == flushing)
+        waiter.addProbe(MPI_ANY_SOURCE, MANAGER_SIGNAL_TAG, MPI_COMM_WORLD);
+
+    // Wait for Controller
+    if (auto p_controller = m_p_controller.lock())
+        p_controller->registerEvents(waiter);
 }
 
 // Flush all task queues (finished, busy, pending)
 void MPIMaster::flushQueues()
 {
-    while (!m_finished_tasks.empty()) m_finished_tasks.pop();
-    while (!m_busy_tasks.empty()) m_busy_tasks.pop();
-    while (!m_pending_tasks.empty()) m_pending_tasks.pop();
+    while (!m_finished_tasks.empty())
+    {
+        Tracer::record(Tracer::task_event, 'e',
+                m_finished_tasks.front().getTaskId());
+        m_finished_tasks.pop();
+    }
+
+    m_map_id_to_task.clear();
+
+    for (const TaskHandler& task : m_busy_tasks)
+        Tracer::record(Tracer::task_event, 'e', task.getTaskId());
+    m_busy_tasks.clear();
+
+    while (!m_pending_tasks.empty())
+    {
+        Tracer::record(Tracer::task_event, 'e',
+                m_pending_tasks.front().getTaskId());
+        m_pending_tasks.pop();
+    }
 }
 
-// Discard any messages and signals until all Managers are idle
-void MPIMaster::discardMessagesErrorCodesAndSignals()
+// Discard any messages and signals until no Manager has outstanding tasks
+void MPIMaster::discardMessagesAndSignals()
 {
     // While there are any incoming messages
     while (probeMessage())
@@ -364,14 +487,13 @@ void MPIMaster::discardMessagesErrorCodesAndSignals()
         // Probe manager
         int manager_rank = probeMessageManager();
 
-        // Receive and discard message
-        receiveMessage(manager_rank);
-
-        // Receive and discard error code
-        receiveErrorCode(manager_rank);
+        // Receive message
+        std::vector<char> buffer = receiveMessage(manager_rank);
+        int position = 0;
 
-        // Mark manager as idle
-        m_idle_managers.insert(manager_rank);
+        // Discard results and decrement number of outstanding tasks
+        m_outstanding_tasks[manager_rank] -=
+            unpack_integer(MPI_COMM_WORLD, buffer, position);
     }
 
     // While there are any incoming signals
@@ -380,9 +502,69 @@ void MPIMaster::discardMessagesErrorCodesAndSignals()
         // Probe manager
         int manager_rank = probeSignalManager();
 
-        // If it a cancellation signal, mark manager as idle
-        if (receiveSignal(manager_rank) == WORKER_FLUSHED_SIGNAL)
-            m_idle_managers.insert(manager_rank);
+        // Receive signal
+        std::vector<char> buffer = receiveSignal(manager_rank);
+        int position = 0;
+
+        // If it a cancellation signal, decrement number of outstanding tasks
+        // by number of flushed tasks
+        if (unpack_integer(MPI_COMM_WORLD, buffer, position) ==
+                WORKER_FLUSHED_SIGNAL)
+            m_outstanding_tasks[manager_rank] -=
+                unpack_integer(MPI_COMM_WORLD, buffer, position);
+    }
+}
+
+// Update average task duration and batch size
+void MPIMaster::updateBatchSize(double duration)
+{
+    // If batching is disabled, nothing needs to be done
+    if (m_max_batch_size == 1)
+        return;
+
+    // Update exponential moving average of task duration
+    if (m_average_duration == 0.0)
+        m_average_duration = duration;
+    else
+        m_average_duration = 0.9 * m_average_duration + 0.1 * duration;
+
+    // Choose batch size such that a batch takes about m_batch_time to run
+    int batch_size = m_max_batch_size;
+    if (m_average_duration > 0.0)
+        batch_size = static_cast<int>(std::min<double>(m_max_batch_size,
+                    std::ceil(m_batch_time / m_average_duration)));
+
+    m_batch_size = std::max(1, batch_size);
+}
+
+// Return whether any Manager has outstanding tasks
+bool MPIMaster::anyOutstandingTasks() const
+{
+    for (auto it = m_outstanding_tasks.begin();
+            it != m_outstanding_tasks.end(); it++)
+        if (*it > 0)
+            return true;
+
+    return false;
+}
+
+// Maximum number of outstanding tasks of every Manager: a batch of tasks for
+// each Worker slot, plus the prefetched tasks
+int MPIMaster::managerCapacity() const
+{
+    return m_slots_per_rank * m_batch_size + m_prefetch;
+}
+
+// Print outstanding tasks for debugging
+void MPIMaster::debugOutstandingTasks() const
+{
+    if (spdlog::get(g_program_name)->level() <= spdlog::level::debug)
+    {
+        spdlog::debug("Outstanding tasks (manager, number), batch size {}:",
+                m_batch_size);
+        for (int i = 0; i < m_comm_size; i++)
+            spdlog::debug("{}, {}", i, m_outstanding_tasks[i]);
+        spdlog::debug("-- END --");
     }
 }
 
@@ -415,58 +597,54 @@ int MPIMaster::probeSignalManager() const
 }
 
 // Receive message from Manager
-std::string MPIMaster::receiveMessage(int manager_rank) const
+std::vector<char> MPIMaster::receiveMessage(int manager_rank) const
 {
     // Sanity check: probeMessage must return true
     assert(probeMessage());
 
-    return receive_string(MPI_COMM_WORLD, manager_rank, MANAGER_MSG_TAG);
+    return receive_packed(MPI_COMM_WORLD, manager_rank, MANAGER_MSG_TAG);
 }
 
 // Receive signal from Manager
-int MPIMaster::receiveSignal(int manager_rank) const
+std::vector<char> MPIMaster::receiveSignal(int manager_rank) const
 {
     // Sanity check: probeSignal must return true
     assert(probeSignal());
 
-    return receive_integer(MPI_COMM_WORLD, manager_rank, MANAGER_SIGNAL_TAG);
-}
-
-// Receive error code from Manager
-int MPIMaster::receiveErrorCode(int manager_rank) const
-{
-    return receive_integer(MPI_COMM_WORLD, manager_rank,
-            MANAGER_ERROR_CODE_TAG);
+    return receive_packed(MPI_COMM_WORLD, manager_rank, MANAGER_SIGNAL_TAG);
 }
 
-// Send message to a Manager
+// Send batch of tasks to a Manager
 void MPIMaster::sendMessageToManager(int manager_rank,
-        const std::string& message_string)
+        const std::vector<task_id_t>& task_ids)
 {
-    if (spdlog::get(g_program_name)->level() <= spdlog::level::debug)
-    {
-        spdlog::debug("MPIMaster::sendMessageToManager: "
-                "sending to manager_rank {}",
-                " and message:\n{}", manager_rank, message_string);
-        spdlog::debug("Idle managers:");
-        for (auto it = m_idle_managers.begin();
-                it != m_idle_managers.end(); it++)
-            spdlog::debug("{}", *it);
-        spdlog::debug("-- END --");
-    }
+    spdlog::debug("MPIMaster::sendMessageToManager: "
+            "sending {} tasks to manager_rank {}", task_ids.size(),
+            manager_rank);
 
     // Ensure previous message has finished sending
     MPI_Wait(&m_message_requests[manager_rank], MPI_STATUS_IGNORE);
 
-    // Store message string in buffer
-    m_message_buffers[manager_rank].assign(message_string);
+    // Pack batch size, prefetch depth and number of tasks, followed by task
+    // identifier and input string of every task
+    std::vector<char>& buffer = m_message_buffers[manager_rank];
+    buffer.clear();
+    pack_integer(MPI_COMM_WORLD, m_batch_size, buffer);
+    pack_integer(MPI_COMM_WORLD, m_prefetch, buffer);
+    pack_integer(MPI_COMM_WORLD, task_ids.size(), buffer);
+    for (auto it = task_ids.begin(); it != task_ids.end(); it++)
+    {
+        const TaskHandler& task = *m_map_id_to_task.at(*it);
+        pack_task_id(MPI_COMM_WORLD, *it, buffer);
+        pack_string(MPI_COMM_WORLD, task.getInputString(), buffer);
+    }
 
     // Note: Isend is used here to avoid deadlock since the Master and the root
     // Manager are executed by the same process
     MPI_Isend(
-            m_message_buffers[manager_rank].c_str(),
-            m_message_buffers[manager_rank].size() + 1,
-            MPI_CHAR, manager_rank, MASTER_MSG_TAG,
+            buffer.data(),
+            buffer.size(),
+            MPI_PACKED, manager_rank, MASTER_MSG_TAG,
             MPI_COMM_WORLD,
             &m_message_requests[manager_rank]);
 }
@@ -2,18 +2,21 @@
 #define MPIMASTER_H
 
 #include <queue>
+#include <list>
 #include <vector>
-#include <set>
+#include <map>
 #include <string>
 
 #include <mpi.h>
 
 #include "core/common.h"
+#include "core/TaskHandler.h"
 
 #include "AbstractMaster.h"
 
 class LongOptions;
 class Arguments;
+class EventWaiter;
 
 /** A Master class for performing simulation tasks in parallel using MPI.
  *
@@ -22,6 +25,26 @@ class Arguments;
  * Manager class).  These Managers then perform simulation tasks by spawning
  * child processes with `fork()`--`exec()` to run simulation.
  *
+ * Every Manager owns the same number of Worker slots.  The MPIMaster keeps
+ * track of the number of outstanding tasks of every Manager, and sends tasks
+ * to Managers in batches, every batch consisting of one or more tasks per
+ * Worker slot.  A Manager runs the tasks of a batch back to back across its
+ * Worker slots and returns their results in a single message.  The batch
+ * size adapts to the duration of tasks reported by the Managers, so that a
+ * batch takes roughly a given amount of time to run.  This reduces the
+ * number of messages the MPIMaster handles when simulations are short.
+ *
+ * Optionally, the MPIMaster keeps a number of extra tasks queued on every
+ * Manager, so that Workers do not sit idle while the result of a task
+ * travels to the MPIMaster and the next task travels back.  Queued tasks are
+ * discarded by the Managers when the MPIMaster is flushed.
+ *
+ * By default, finished tasks are pushed to the finished tasks queue as soon
+ * as their results arrive, so that one slow simulation does not hold back
+ * the results of simulations that were started later.  For reproducibility,
+ * the MPIMaster can instead be made to deliver finished tasks in the order
+ * in which they were pushed.
+ *
  * @warning If your simulator uses MPI internally, this will likely clash with
  * Pakman when using MPIMaster.  In that case, you will need to build an MPI
  * simulator.  An example of an MPI simulator can be found [on our
@@ -43,8 +66,19 @@ class MPIMaster : public AbstractMaster
          *
          * @param p_program_terminated  pointer to boolean flag that is set
          * when the execution of Pakman is terminated by the user.
+         * @param in_order  whether to deliver finished tasks in the order in
+         * which they were pushed.
+         * @param slots_per_rank  number of Worker slots of every Manager.
+         * @param max_batch_size  maximum number of tasks per Worker slot
+         * in a batch.
+         * @param batch_time  targeted time in seconds to run one task per
+         * Worker slot in a batch.
+         * @param prefetch  number of extra tasks to keep queued on every
+         * Manager.
          */
-        MPIMaster(bool *p_program_terminated);
+        MPIMaster(bool *p_program_terminated, bool in_order = false,
+                int slots_per_rank = 1, int max_batch_size = 1,
+                double batch_time = 0.01, int prefetch = 0);
 
         /** Default destructor does nothing. */
         virtual ~MPIMaster() override;
@@ -55,11 +89,17 @@ class MPIMaster : public AbstractMaster
         /** @return whether more pending tasks are needed. */
         virtual bool needMorePendingTasks() const override;
 
+        /** @return number of Workers that perform tasks at the same time. */
+        virtual int numWorkers() const override;
+
         /** Push a new pending task.
          *
          * @param input_string  input string to simulation job.
+         *
+         * @return identifier of the new task.
          */
-        virtual void pushPendingTask(const std::string& input_string) override;
+        virtual task_id_t pushPendingTask(std::string input_string)
+            override;
 
         /** @return whether finished tasks queue is empty. */
         virtual bool finishedTasksEmpty() const override;
@@ -116,7 +156,7 @@ class MPIMaster : public AbstractMaster
          * The MPIMaster can either in a `normal` state, a `flushing` state or
          * in a `terminated` state.  When the MPIMaster is in a flushing state,
          * it has flushed the task queues and is waiting for all Managers to
-         * finish ongoing simulations before accepting new tasks.  When the
+         * account for their outstanding tasks before accepting new tasks.  When the
          * MPIMaster is in a `terminated` state, the member function isActive()
          * will return false and the event loop should terminate.
          */
@@ -138,12 +178,31 @@ class MPIMaster : public AbstractMaster
         // Delegate to Managers
         void delegateToManagers();
 
+        // Move tasks at the front of the pending queue that were found in
+        // the cache and return whether any task was moved
+        bool moveCachedTasks();
+
+        // Register the events that the Master is waiting for
+        void registerEvents(EventWaiter& waiter) const;
+
         // Flush all task queues (finished, busy, pending)
         void flushQueues();
 
-        // Discard any messages, error codes and signals until all Managers are
-        // idle
-        void discardMessagesErrorCodesAndSignals();
+        // Discard any messages and signals until no Manager has outstanding
+        // tasks
+        void discardMessagesAndSignals();
+
+        // Update average task duration and batch size
+        void updateBatchSize(double duration);
+
+        // Return whether any Manager has outstanding tasks
+        bool anyOutstandingTasks() const;
+
+        // Print outstanding tasks for debugging
+        void debugOutstandingTasks() const;
+
+        // Maximum number of outstanding tasks of every Manager
+        int managerCapacity() const;
 
         // Probe for message
         bool probeMessage() const;
@@ -158,17 +217,14 @@ class MPIMaster : public AbstractMaster
         int probeSignalManager() const;
 
         // Receive message from Manager
-        std::string receiveMessage(int manager_rank) const;
+        std::vector<char> receiveMessage(int manager_rank) const;
 
         // Receive signal from Manager
-        int receiveSignal(int manager_rank) const;
-
-        // Receive error cdoe from Manager
-        int receiveErrorCode(int manager_rank) const;
+        std::vector<char> receiveSignal(int manager_rank) const;
 
-        // Send message to a Manager
+        // Send batch of tasks to a Manager
         void sendMessageToManager(int manager_rank,
-                const std::string& message_string);
+                const std::vector<task_id_t>& task_ids);
 
         // Send signal to all Managers
         void sendSignalToAllManagers(int signal);
@@ -180,29 +236,50 @@ class MPIMaster : public AbstractMaster
         // Communicator size
         const int m_comm_size;
 
+        // Number of Worker slots of every Manager
+        const int m_slots_per_rank;
+
+        // Maximum number of tasks per Worker slot in a batch
+        const int m_max_batch_size;
+
+        // Targeted time in seconds to run one task per Worker slot in a batch
+        const double m_batch_time;
+
+        // Current number of tasks per Worker slot in a batch
+        int m_batch_size = 1;
+
+        // Number of extra tasks to keep queued on every Manager
+        const int m_prefetch;
+
+        // Moving average of task duration in seconds (zero if unknown)
+        double m_average_duration = 0.0;
+
         // Flag for terminating Master and Managers
         bool m_master_manager_terminated = false;
 
         // Flag for flushing Workers
         bool m_worker_flushed = false;
 
-        // Set of idle managers
-        std::set<int> m_idle_managers;
+        // Flag for delivering finished tasks in submission order
+        const bool m_in_order;
 
-        // Mapping from Manager to corresponding task
-        std::vector<TaskHandler*> m_map_manager_to_task;
+        // Number of outstanding tasks of every Manager
+        std::vector<int> m_outstanding_tasks;
+
+        // Mapping from task identifier to corresponding busy task
+        std::map<task_id_t, std::list<TaskHandler>::iterator> m_map_id_to_task;
 
         // Finished tasks
         std::queue<TaskHandler> m_finished_tasks;
 
         // Busy tasks
-        std::queue<TaskHandler> m_busy_tasks;
+        std::list<TaskHandler> m_busy_tasks;
 
         // Pending tasks
         std::queue<TaskHandler> m_pending_tasks;
 
         // Message buffers
-        std::vector<std::string> m_message_buffers;
+        std::vector<std::vector<char>> m_message_buffers;
 
         // Message requests
         std::vector<MPI_Request> m_message_requests;
@@ -214,6 +291,9 @@ class MPIMaster : public AbstractMaster
         // Signal requests
         std::vector<MPI_Request> m_signal_requests;
 
+        // Whether tasks found in the cache await delivery
+        bool m_cached_tasks_ready = false;
+
         // Entered iterate()
         bool m_entered = false;
 };
@@ -1,17 +1,23 @@
-#include <thread>
+#include <chrono>
 #include <string>
 #include <iostream>
 #include <memory>
+#include <vector>
+#include <cstring>
 
 #include <mpi.h>
 
 #include <getopt.h>
 
+#include "spdlog/spdlog.h"
+
 #include "core/common.h"
 #include "core/utils.h"
 #include "core/LongOptions.h"
 #include "core/Arguments.h"
+#include "core/Tracer.h"
 #include "system/signal_handler.h"
+#include "system/system_call.h"
 #include "mpi/mpi_utils.h"
 #include "mpi/mpi_common.h"
 #include "main/help.h"
@@ -19,6 +25,8 @@
 
 #include "Manager.h"
 #include "MPIWorkerHandler.h"
+#include "PersistentWorkerHandler.h"
+#include "EventWaiter.h"
 
 #include "MPIMaster.h"
 
@@ -35,8 +43,8 @@ Description:
   The MPI master parallelizes instances of the simulator, also called
   "workers", across all launched MPI processes.  This means that every MPI
   process is responsible for spawning workers.  The correspondence between
-  workers and MPI processes is one-to-one; launching N MPI processes results in
-  N workers running in parallel.
+  workers and MPI processes is one-to-one by default; launching N MPI
+  processes results in N workers running in parallel.
 
   If no optional arguments are given, the simulator is, by default, assumed to
   be a standard simulator, which means that it communicates with pakman
@@ -46,10 +54,69 @@ Description:
   to communicate with pakman through MPI.  The MPI simulator must then be
   written with the header pakman_mpi_worker.h or PakmanMPIWorker.hpp.
 
+  By default, every MPI simulator is spawned as a single MPI process.  The
+  optional argument --worker-procs spawns every MPI simulator as a group of
+  the given number of MPI processes instead, so that the simulator itself can
+  run in parallel.  The first process of the group communicates with pakman
+  and shares the input with the other processes of the group.  Every worker
+  then occupies this many processors, on top of the MPI process that manages
+  it, so the number of launched MPI processes and --slots-per-rank should be
+  chosen such that all workers fit on the available processors.
+
+  If the optional argument --persistent-simulator is given, the simulator is
+  assumed to be a persistent simulator.  Every MPI process then starts the
+  simulator only once and sends it all of its simulations one after the
+  other.  Since the stdin of a persistent simulator stays open between
+  simulations, the input and output of every simulation are prefixed with
+  their length in bytes.  The input is sent as
+
+    <length of input>\n<input>
+
+  and the simulator must reply with
+
+    <length of output> <error code>\n<output>
+
+  and flush its stdout.  The simulator should exit when its stdin is closed.
+  If a persistent simulator exits or is terminated in the middle of a
+  simulation, it is restarted for the next simulation.
+
+  By default, every MPI process runs one worker at a time.  The optional
+  argument --slots-per-rank makes every MPI process run up to the given number
+  of workers concurrently.  This makes it possible to launch a single MPI
+  process per node instead of one MPI process per core, which reduces the
+  number of MPI processes and the amount of MPI communication.  The MPI master
+  sends the simulations for all idle workers of an MPI process in a single
+  message.  When using an MPI simulator, every worker slot spawns its own MPI
+  simulator.
+
+  When simulations are short, the MPI master may spend most of its time
+  sending and receiving messages.  The optional argument --max-batch-size
+  allows the MPI master to send up to the given number of simulations per
+  worker in a single message.  Every MPI process then runs these simulations
+  back to back and returns their results in a single message.  The batch size
+  adapts to the measured duration of the simulations, such that one
+  simulation per worker in a batch takes roughly the time given by the
+  optional argument --batch-time.  By default, the maximum batch size is 1,
+  meaning that simulations are not batched.
+
+  Normally, an MPI process only receives its next simulation after the
+  result of its previous simulation has reached the MPI master, so workers
+  sit idle for a round trip between simulations.  The optional argument
+  --prefetch makes the MPI master keep the given number of extra simulations
+  queued on every MPI process, so that a worker can start its next
+  simulation as soon as the previous one finishes.  Queued simulations are
+  discarded whenever the MPI master cancels ongoing simulations.
+
   In order to maximize the number of CPU cycles devoted to the workers, the MPI
-  master is implemented using an event loop.  The time spent sleeping at each
-  iteration of the event loop can be adjusted using the optional argument
-  --main-timeout.
+  master is implemented using an event loop that blocks until a message
+  arrives from another MPI process or until a worker produces output.  Since
+  MPI offers no way to block on incoming messages, these are checked at
+  intervals that grow exponentially while nothing happens.  The optional
+  argument --main-timeout gives an upper bound on the time spent waiting at
+  each iteration of the event loop.  The optional argument --spin-timeout
+  makes the event loop busy-wait for the given amount of time before
+  blocking, which trades CPU cycles for lower latency when simulations are
+  short.
 
   When a worker needs to be shut down, for example when the algorithm has
   finished, pakman first sends SIGTERM to the worker.  If the worker has not
@@ -59,44 +126,117 @@ Description:
   for standard simulators because the MPI standard does not support signals for
   processes that are spawned using MPI functions.
 
+  By default, MPI simulators are spawned when the first simulation arrives at
+  a worker, so that all MPI processes spawn their simulators at the same time
+  in the middle of the first generation.  The flag --eager-spawn makes every
+  MPI process spawn the MPI simulators of all its workers at startup instead,
+  before any simulations are sent out.  The time this takes is reported at
+  the info verbosity level.
+
   Some MPI implementations do not automatically spawn dynamic MPI processes on
   the same host as the spawning MPI process.  The flag --force-host-spawn tries
   to enforce spawning dynamic MPI processes on the same host by setting the
   "host" key in MPI_Info to the same host as the spawning MPI process.
 
+  By default, the results of simulations are passed on to the controller as
+  soon as they arrive, so that a slow simulation does not delay the results of
+  other simulations.  Since the order in which simulations finish varies from
+  run to run, the flag --in-order can be used to pass on results in the order
+  in which the simulations were submitted, which is needed for reproducible
+  results.
+
 MPI master options:
   -m, --mpi-simulator          simulator is spawned using MPI
+  -l, --persistent-simulator   simulator is a persistent simulator
   -f, --force-host-spawn       force MPI simulator to spawn on same host
                                as manager (requires -m option)
+  -e, --eager-spawn            spawn MPI simulators at startup
+                               (requires -m option)
+  -W, --worker-procs=NUM       spawn every MPI simulator with NUM MPI
+                               processes (default 1, requires -m option)
   -p, --mpi-info=KEY_VAL_STR   specify key-value pairs for MPI_Info object
                                to MPI_Comm_spawn as
                                'KEY1=VALUE1; KEY2=VALUE2; ...; KEYN=VALUEN'
                                (requires -m option).  The characters '=' and
                                ';' can be escaped using a backslash.
-  -t, --main-timeout=TIME      sleep for TIME ms in event loop (default 1)
+  -O, --in-order               deliver results to the controller in the
+                               order in which the tasks were submitted
+  -n, --slots-per-rank=NUM     run up to NUM workers concurrently on every
+                               MPI process (default 1)
+  -b, --max-batch-size=NUM     send up to NUM simulations per worker in a
+                               single message (default 1)
+  -B, --batch-time=TIME        adapt batch size so that batches take about
+                               TIME ms per worker (default 10)
+  -F, --prefetch=NUM           keep NUM extra simulations queued on every
+                               MPI process (default 0)
+  -t, --main-timeout=TIME      wait at most TIME ms in event loop (default 1)
+  -w, --spin-timeout=TIME      busy-wait for TIME us in event loop before
+                               blocking (default 0)
   -k, --kill-timeout=TIME      wait for TIME ms before sending SIGKILL
                                (default 100)
 )";
 }
 
-Manager::worker_t get_worker(bool mpi_simulator)
+Manager::worker_t get_worker(bool mpi_simulator, bool persistent_simulator)
 {
     if (mpi_simulator)
     {
         return Manager::mpi_worker;
     }
+    else if (persistent_simulator)
+    {
+        return Manager::persistent_worker;
+    }
     else
         return Manager::forked_worker;
 }
 
+// Gather events of all ranks on rank 0 and write trace file
+void write_trace()
+{
+    // Copy events into byte buffer
+    const std::vector<Tracer::Event>& events = Tracer::events();
+    std::vector<char> bytes(events.size() * sizeof(Tracer::Event));
+    if (!bytes.empty())
+        std::memcpy(bytes.data(), events.data(), bytes.size());
+
+    std::vector<std::vector<char>> bytes_per_rank =
+        gather_bytes(MPI_COMM_WORLD, 0, bytes);
+
+    if (get_mpi_comm_world_rank() != 0)
+        return;
+
+    // Copy byte buffers back into events
+    std::vector<std::vector<Tracer::Event>> events_per_rank;
+    for (const std::vector<char>& rank_bytes : bytes_per_rank)
+    {
+        events_per_rank.emplace_back(
+                rank_bytes.size() / sizeof(Tracer::Event));
+        if (!rank_bytes.empty())
+            std::memcpy(events_per_rank.back().data(), rank_bytes.data(),
+                    rank_bytes.size());
+    }
+
+    Tracer::write(g_trace_file, events_per_rank);
+}
+
 // Static addLongOptions function
 void MPIMaster::addLongOptions(LongOptions& lopts)
 {
     lopts.add({"main-timeout", required_argument, nullptr, 't'});
+    lopts.add({"spin-timeout", required_argument, nullptr, 'w'});
     lopts.add({"kill-timeout", required_argument, nullptr, 'k'});
     lopts.add({"mpi-simulator", no_argument, nullptr, 'm'});
+    lopts.add({"persistent-simulator", no_argument, nullptr, 'l'});
     lopts.add({"force-host-spawn", no_argument, nullptr, 'f'});
+    lopts.add({"eager-spawn", no_argument, nullptr, 'e'});
+    lopts.add({"worker-procs", required_argument, nullptr, 'W'});
     lopts.add({"mpi-info", required_argument, nullptr, 'p'});
+    lopts.add({"in-order", no_argument, nullptr, 'O'});
+    lopts.add({"slots-per-rank", required_argument, nullptr, 'n'});
+    lopts.add({"max-batch-size", required_argument, nullptr, 'b'});
+    lopts.add({"batch-time", required_argument, nullptr, 'B'});
+    lopts.add({"prefetch", required_argument, nullptr, 'F'});
 }
 
 // Static main function
@@ -104,14 +244,72 @@ void MPIMaster::run(controller_t controller, const Arguments& args)
 {
     // Initialize flags for mpi simulator and persistence
     bool mpi_simulator = false;
+    bool persistent_simulator =
+        args.isOptionalArgumentSet("persistent-simulator");
+
+    // Initialize flag for in-order delivery of results
+    bool in_order = args.isOptionalArgumentSet("in-order");
 
     // Process optional arguments
+    int slots_per_rank = 1;
+    if (args.isOptionalArgumentSet("slots-per-rank"))
+    {
+        std::string&& arg = args.optionalArgument("slots-per-rank");
+        slots_per_rank = std::stoi(arg);
+
+        if (slots_per_rank < 1)
+        {
+            std::cout << "Error: --slots-per-rank must be at least 1\n";
+            ::help(mpi, controller, EXIT_FAILURE);
+        }
+    }
+
+    int max_batch_size = 1;
+    if (args.isOptionalArgumentSet("max-batch-size"))
+    {
+        std::string&& arg = args.optionalArgument("max-batch-size");
+        max_batch_size = std::stoi(arg);
+
+        if (max_batch_size < 1)
+        {
+            std::cout << "Error: --max-batch-size must be at least 1\n";
+            ::help(mpi, controller, EXIT_FAILURE);
+        }
+    }
+
+    double batch_time = 0.01;
+    if (args.isOptionalArgumentSet("batch-time"))
+    {
+        std::string&& arg = args.optionalArgument("batch-time");
+        batch_time = std::stod(arg) / 1000.0;
+    }
+
+    int prefetch = 0;
+    if (args.isOptionalArgumentSet("prefetch"))
+    {
+        std::string&& arg = args.optionalArgument("prefetch");
+        prefetch = std::stoi(arg);
+
+        if (prefetch < 0)
+        {
+            std::cout << "Error: --prefetch must be nonnegative\n";
+            ::help(mpi, controller, EXIT_FAILURE);
+        }
+    }
+
     if (args.isOptionalArgumentSet("main-timeout"))
     {
         std::string&& arg = args.optionalArgument("main-timeout");
         g_main_timeout = std::chrono::milliseconds(std::stoi(arg));
     }
 
+    std::chrono::microseconds spin_timeout(0);
+    if (args.isOptionalArgumentSet("spin-timeout"))
+    {
+        std::string&& arg = args.optionalArgument("spin-timeout");
+        spin_timeout = std::chrono::microseconds(std::stoi(arg));
+    }
+
     if (args.isOptionalArgumentSet("kill-timeout"))
     {
         std::string&& arg = args.optionalArgument("kill-timeout");
@@ -122,8 +320,39 @@ void MPIMaster::run(controller_t controller, const Arguments& args)
     {
         mpi_simulator = true;
 
+        if (persistent_simulator)
+        {
+            std::cout << "Error: options --mpi-simulator and "
+                "--persistent-simulator cannot both be set\n";
+            ::help(mpi, controller, EXIT_FAILURE);
+        }
+
         if (args.isOptionalArgumentSet("force-host-spawn"))
             g_force_host_spawn = true;
+
+        if (args.isOptionalArgumentSet("worker-procs"))
+        {
+            std::string&& arg = args.optionalArgument("worker-procs");
+            g_worker_procs = std::stoi(arg);
+
+            if (g_worker_procs < 1)
+            {
+                std::cout << "Error: --worker-procs must be at least 1\n";
+                ::help(mpi, controller, EXIT_FAILURE);
+            }
+        }
+    }
+    else if (args.isOptionalArgumentSet("worker-procs"))
+    {
+        std::cout << "Error: option --mpi-simulator must be set "
+            "if --worker-procs is set\n";
+        ::help(mpi, controller, EXIT_FAILURE);
+    }
+    else if (args.isOptionalArgumentSet("eager-spawn"))
+    {
+        std::cout << "Error: option --mpi-simulator must be set "
+            "if --eager-spawn is set\n";
+        ::help(mpi, controller, EXIT_FAILURE);
     }
     else if (args.isOptionalArgumentSet("force-host-spawn"))
     {
@@ -160,12 +389,19 @@ void MPIMaster::run(controller_t controller, const Arguments& args)
     int rank = 0;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 
+    // Align origin of trace timestamps across ranks
+    if (Tracer::isEnabled())
+    {
+        MPI_Barrier(MPI_COMM_WORLD);
+        Tracer::setOrigin();
+    }
+
     // Set signal handler
     set_signal_handler();
 
     // Determine Worker type
     Manager::worker_t worker_type =
-        get_worker(mpi_simulator);
+        get_worker(mpi_simulator, persistent_simulator);
 
     // Create controller
     std::shared_ptr<AbstractController>
@@ -173,12 +409,38 @@ void MPIMaster::run(controller_t controller, const Arguments& args)
 
     // Create Manager object
     auto p_manager = std::make_shared<Manager>(p_controller->getSimulator(),
-            worker_type, &g_program_terminated);
+            worker_type, &g_program_terminated, slots_per_rank);
+
+    // Spawn MPI simulators of all Worker slots at startup if requested
+    if (args.isOptionalArgumentSet("eager-spawn"))
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        MPIWorkerHandler::spawnStatic(p_controller->getSimulator(),
+                slots_per_rank);
+
+        // Wait for all Managers to finish spawning
+        MPI_Barrier(MPI_COMM_WORLD);
+
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        if (rank == 0)
+            spdlog::info("Spawned {} MPI simulators of {} processes "
+                    "in {:.3f} s",
+                    get_mpi_comm_world_size() * slots_per_rank,
+                    g_worker_procs, elapsed.count());
+    }
+
+    // Create EventWaiter for event loop
+    EventWaiter waiter(spin_timeout, g_main_timeout);
 
     if (rank == 0)
     {
         // Create MPI master
-        auto p_master = std::make_shared<MPIMaster>(&g_program_terminated);
+        auto p_master = std::make_shared<MPIMaster>(&g_program_terminated,
+                in_order, slots_per_rank, max_batch_size, batch_time,
+                prefetch);
 
         // Associate with each other
         p_master->assignController(p_controller);
@@ -193,7 +455,14 @@ void MPIMaster::run(controller_t controller, const Arguments& args)
             if (p_manager->isActive())
                 p_manager->iterate();
 
-            std::this_thread::sleep_for(g_main_timeout);
+            // Wait for next event
+            if (p_master->isActive())
+                p_master->registerEvents(waiter);
+
+            if (p_manager->isActive())
+                p_manager->registerEvents(waiter);
+
+            waiter.wait();
         }
     }
     else
@@ -203,7 +472,11 @@ void MPIMaster::run(controller_t controller, const Arguments& args)
         {
             p_manager->iterate();
 
-            std::this_thread::sleep_for(g_main_timeout);
+            // Wait for next event
+            if (p_manager->isActive())
+                p_manager->registerEvents(waiter);
+
+            waiter.wait();
         }
     }
 
@@ -217,6 +490,14 @@ void MPIMaster::run(controller_t controller, const Arguments& args)
 
     // Terminate any remaining Workers
     MPIWorkerHandler::terminateStatic();
+    PersistentWorkerHandler::terminateStatic();
+
+    // Wait for terminated processes to exit
+    wait_terminating_processes();
+
+    // Write trace
+    if (Tracer::isEnabled())
+        write_trace();
 
     // Finalize
     MPI_Finalize();
@@ -233,8 +514,12 @@ void MPIMaster::cleanup()
         MPI_Send(&signal, 1, MPI_INT, manager_rank,
                 MASTER_SIGNAL_TAG, MPI_COMM_WORLD);
 
-    // Terminate Worker associated with MPI process with rank 0
+    // Terminate Workers associated with MPI process with rank 0
     MPIWorkerHandler::terminateStatic();
+    PersistentWorkerHandler::terminateStatic();
+
+    // Wait for terminated processes to exit
+    wait_terminating_processes();
 
     // Finalize MPI if not yet finalized
     int is_finalized = 0;
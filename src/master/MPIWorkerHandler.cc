@@ -1,4 +1,5 @@
 #include <string>
+#include <vector>
 #include <thread>
 
 #include "core/common.h"
@@ -6,36 +7,51 @@
 #include "mpi/mpi_common.h"
 #include "mpi/spawn.h"
 
+#include "EventWaiter.h"
+
 #include "MPIWorkerHandler.h"
 
-// Initialize static child communicator of MPIWorkerHandler to the
-// null communicators (MPI_COMM_NULL)
-MPI_Comm MPIWorkerHandler::s_child_comm = MPI_COMM_NULL;
+// Initialize static child communicators of MPIWorkerHandler to no Worker
+// slots
+std::vector<MPI_Comm> MPIWorkerHandler::s_child_comms;
+
+// Initialize static cancellation flags of MPIWorkerHandler to no Worker slots
+std::vector<bool> MPIWorkerHandler::s_cancelled;
 
 MPIWorkerHandler::MPIWorkerHandler(const Command& simulator,
-        const std::string& input_string) :
-    AbstractWorkerHandler(simulator, input_string)
+        const std::string& input_string, int slot) :
+    AbstractWorkerHandler(simulator, input_string),
+    m_slot(slot)
 {
+    // Initialize child communicators of new Worker slots to the null
+    // communicator (MPI_COMM_NULL)
+    resizeStatic(m_slot + 1);
+
     // Spawn  MPI child process if it has not yet been spawned
-    if (s_child_comm == MPI_COMM_NULL)
-        s_child_comm = spawn_worker(m_simulator);
+    if (childComm() == MPI_COMM_NULL)
+        childComm() = spawn_worker(m_simulator);
+
+    // Discard results of previously cancelled simulation
+    if (s_cancelled[m_slot])
+        discardResults(m_slot);
 
     // Write input string to spawned MPI process
     MPI_Send(input_string.c_str(), input_string.size() + 1, MPI_CHAR,
-            WORKER_RANK, MANAGER_MSG_TAG, s_child_comm);
+            WORKER_RANK, MANAGER_MSG_TAG, childComm());
 }
 
 MPIWorkerHandler::~MPIWorkerHandler()
 {
-    // Just discard results, do not terminate MPI child process
-    discardResults();
+    // Cancel simulation if it has not finished yet, do not terminate MPI
+    // child process
+    cancel();
 }
 
 bool MPIWorkerHandler::isDone()
 {
     // Probe for result if result has not yet been received
     if (    !m_result_received &&
-            iprobe_wrapper(WORKER_RANK, WORKER_MSG_TAG, s_child_comm))
+            iprobe_wrapper(WORKER_RANK, WORKER_MSG_TAG, childComm()))
     {
         // Receive message
         m_output_buffer.assign(receiveMessage());
@@ -50,53 +66,106 @@ bool MPIWorkerHandler::isDone()
     return m_result_received;
 }
 
+void MPIWorkerHandler::registerEvents(EventWaiter& waiter) const
+{
+    // Wait for message from Worker
+    if (!m_result_received)
+        waiter.addProbe(WORKER_RANK, WORKER_MSG_TAG, childComm());
+}
+
+MPI_Comm& MPIWorkerHandler::childComm() const
+{
+    return s_child_comms[m_slot];
+}
+
 std::string MPIWorkerHandler::receiveMessage() const
 {
-    return receive_string(s_child_comm, WORKER_RANK, WORKER_MSG_TAG);
+    return receive_string(childComm(), WORKER_RANK, WORKER_MSG_TAG);
 }
 
 int MPIWorkerHandler::receiveErrorCode() const
 {
-    return receive_integer(s_child_comm, WORKER_RANK, WORKER_ERROR_CODE_TAG);
+    return receive_integer(childComm(), WORKER_RANK, WORKER_ERROR_CODE_TAG);
 }
 
-void MPIWorkerHandler::discardResults()
+void MPIWorkerHandler::cancel()
 {
-    // MPI does not provide process control, so
-    // we can only wait for the simulation to finish
-    // if it has not finished yet
-    if (!m_result_received)
-    {
-        // Timeout if message is not ready yet
-        while (!iprobe_wrapper(WORKER_RANK, WORKER_MSG_TAG, s_child_comm))
-            std::this_thread::sleep_for(g_main_timeout);
-
-        // Receive message
-        receiveMessage();
+    // If the result has already been received, nothing needs to be done
+    if (m_result_received)
+        return;
 
-        // Receive error code
-        receiveErrorCode();
+    // MPI does not provide process control, so we ask the MPI Worker to
+    // cancel its simulation.  The MPI Worker still sends a result, which is
+    // discarded later.
+    int signal = CANCEL_WORKER_SIGNAL;
+    MPI_Send(&signal, 1, MPI_INT, WORKER_RANK, MANAGER_SIGNAL_TAG,
+            childComm());
 
-        // Set flag
-        m_result_received = true;
-    }
+    s_cancelled[m_slot] = true;
+    m_result_received = true;
 }
 
-void MPIWorkerHandler::terminateStatic()
+void MPIWorkerHandler::discardResults(int slot)
 {
-    // If this function is called, the Worker must be in an idle state, so it
-    // is not necessary to discard results from Worker.
+    MPI_Comm& comm = s_child_comms[slot];
 
-    // If s_child_comm is the null communicator, the Worker has already been
-    // terminated, so nothing needs to be done.
-    if (s_child_comm == MPI_COMM_NULL)
-        return;
+    // Timeout if message is not ready yet
+    while (!iprobe_wrapper(WORKER_RANK, WORKER_MSG_TAG, comm))
+        std::this_thread::sleep_for(g_main_timeout);
 
-    // Else, send termination signal to Worker
-    int signal = TERMINATE_WORKER_SIGNAL;
-    MPI_Send(&signal, 1, MPI_INT, WORKER_RANK, MANAGER_SIGNAL_TAG,
-            s_child_comm);
+    // Receive message
+    receive_string(comm, WORKER_RANK, WORKER_MSG_TAG);
+
+    // Receive error code
+    receive_integer(comm, WORKER_RANK, WORKER_ERROR_CODE_TAG);
+
+    // Reset flag
+    s_cancelled[slot] = false;
+}
+
+void MPIWorkerHandler::spawnStatic(const Command& simulator, int num_slots)
+{
+    // Initialize child communicators of new Worker slots to the null
+    // communicator (MPI_COMM_NULL)
+    resizeStatic(num_slots);
+
+    // Spawn MPI child processes that have not yet been spawned
+    for (int slot = 0; slot < num_slots; slot++)
+        if (s_child_comms[slot] == MPI_COMM_NULL)
+            s_child_comms[slot] = spawn_worker(simulator);
+}
 
-    // Free communicator
-    MPI_Comm_disconnect(&s_child_comm);
+void MPIWorkerHandler::resizeStatic(int num_slots)
+{
+    if (s_child_comms.size() < static_cast<std::size_t>(num_slots))
+    {
+        s_child_comms.resize(num_slots, MPI_COMM_NULL);
+        s_cancelled.resize(num_slots, false);
+    }
+}
+
+void MPIWorkerHandler::terminateStatic()
+{
+    // If this function is called, the Workers must be in an idle state, so it
+    // is only necessary to discard results from cancelled simulations.
+    for (int slot = 0; slot < static_cast<int>(s_child_comms.size());
+            slot++)
+    {
+        // If the child communicator is the null communicator, the Worker has
+        // already been terminated, so nothing needs to be done.
+        MPI_Comm& comm = s_child_comms[slot];
+        if (comm == MPI_COMM_NULL)
+            continue;
+
+        // Discard results of cancelled simulation
+        if (s_cancelled[slot])
+            discardResults(slot);
+
+        // Send termination signal to Worker
+        int signal = TERMINATE_WORKER_SIGNAL;
+        MPI_Send(&signal, 1, MPI_INT, WORKER_RANK, MANAGER_SIGNAL_TAG, comm);
+
+        // Free communicator
+        MPI_Comm_disconnect(&comm);
+    }
 }
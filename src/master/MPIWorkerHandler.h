@@ -2,6 +2,7 @@
 #define MPIWORKERHANDLER_H
 
 #include <string>
+#include <vector>
 
 #include <mpi.h>
 
@@ -18,6 +19,17 @@
  * accept more simulation tasks.  Each simulation task is represented by a new
  * instance of MPIWorkerHandler.  Only when terminateStatic() is called will
  * the MPI Worker process be terminated.
+ *
+ * Since a Manager can run several Workers concurrently, every Worker slot of
+ * the Manager has its own MPI child process.
+ *
+ * MPI child processes cannot be terminated with system signals.  Instead,
+ * when a busy MPIWorkerHandler is destroyed, it sends a cancellation signal
+ * to the MPI child process and returns immediately.  The simulator can check
+ * for this signal (see pakman_should_cancel() and
+ * PakmanMPIWorker::shouldCancel()) and return early.  The results of the
+ * cancelled simulation are discarded before the next simulation task is sent
+ * to the same MPI child process.
  */
 
 class MPIWorkerHandler : public AbstractWorkerHandler
@@ -41,15 +53,19 @@ class MPIWorkerHandler : public AbstractWorkerHandler
          *
          * @param simulator  command to run simulation.
          * @param input_string  input string to simulator.
+         * @param slot  Worker slot whose MPI child process runs the
+         * simulation.
          */
         MPIWorkerHandler(const Command& simulator, const std::string&
-                input_string);
+                input_string, int slot = 0);
 
         /** Destructor.
          *
-         * The destructor waits for the MPI Worker to finish its simulation
-         * task and send its output string and error code if it has not yet
-         * done so.
+         * If the MPI Worker has not yet sent its output string and error
+         * code, the destructor sends it a cancellation signal.  It does not
+         * wait for the MPI Worker to respond; the results of the cancelled
+         * simulation are discarded when the next simulation task is sent to
+         * the same Worker slot, or when terminateStatic() is called.
          *
          * We assume that the MPI child process does not exit after sending its
          * results, but rather stays alive to accept further simulation tasks.
@@ -63,6 +79,12 @@ class MPIWorkerHandler : public AbstractWorkerHandler
          */
         virtual bool isDone() override;
 
+        /** Register probe for Worker message with EventWaiter.
+         *
+         * @param waiter  EventWaiter to register probe with.
+         */
+        virtual void registerEvents(EventWaiter& waiter) const override;
+
         /** Terminate Workers remaining after their Managers have terminated.
          *
          * Since the Managers can only call terminate() on busy Workers, any
@@ -71,6 +93,19 @@ class MPIWorkerHandler : public AbstractWorkerHandler
          */
         static void terminateStatic();
 
+        /** Spawn the MPI child processes of all Worker slots in advance.
+         *
+         * By default, the MPI child process of a Worker slot is spawned when
+         * the first simulation task arrives.  This function instead spawns
+         * the MPI child processes of the given number of Worker slots
+         * immediately, so that spawning does not delay the first simulation
+         * tasks.
+         *
+         * @param simulator  command to run simulation.
+         * @param num_slots  number of Worker slots.
+         */
+        static void spawnStatic(const Command& simulator, int num_slots);
+
     private:
 
         // Receive message from Worker
@@ -79,13 +114,30 @@ class MPIWorkerHandler : public AbstractWorkerHandler
         // Receive error code from Worker
         int receiveErrorCode() const;
 
-        // Discard results from MPI process
-        void discardResults();
+        // Cancel simulation of MPI process
+        void cancel();
+
+        // Wait for and discard results of cancelled simulation of Worker
+        // slot
+        static void discardResults(int slot);
+
+        // Intercomm with child of this Worker slot
+        MPI_Comm& childComm() const;
+
+        // Make room for at least the given number of Worker slots
+        static void resizeStatic(int num_slots);
+
+        // Intercomms with children, indexed by Worker slot
+        // These intercommunicators are static so that they survive across
+        // multiple instances of MPIWorkerHandler
+        static std::vector<MPI_Comm> s_child_comms;
+
+        // Flags for cancelled simulations whose results have not yet been
+        // discarded, indexed by Worker slot
+        static std::vector<bool> s_cancelled;
 
-        // Intercomm with child
-        // This intercommunicator is static so that it survives across multiple
-        // instances of MPIWorkerHandler
-        static MPI_Comm s_child_comm;
+        // Worker slot
+        const int m_slot;
 
         // Flag for receiving result
         bool m_result_received = false;
@@ -1,5 +1,9 @@
 #include <string>
+#include <vector>
+#include <queue>
 #include <memory>
+#include <chrono>
+#include <cstdint>
 
 #include <assert.h>
 
@@ -8,21 +12,28 @@
 #include "spdlog/spdlog.h"
 
 #include "core/common.h"
+#include "core/Tracer.h"
+#include "system/system_call.h"
 #include "mpi/mpi_common.h"
 #include "mpi/mpi_utils.h"
 
 #include "ForkedWorkerHandler.h"
 #include "MPIWorkerHandler.h"
+#include "PersistentWorkerHandler.h"
+#include "EventWaiter.h"
 
 #include "Manager.h"
 
-// Construct from simulator, pointer to program terminated flag, and
-// Worker type (forked vs MPI)
+// Construct from simulator, pointer to program terminated flag, Worker type
+// (forked vs MPI) and number of Worker slots
 Manager::Manager(const Command &simulator, worker_t worker_type,
-        bool *p_program_terminated) :
+        bool *p_program_terminated, int num_slots) :
     m_simulator(simulator),
     m_worker_type(worker_type),
-    m_p_program_terminated(p_program_terminated)
+    m_p_program_terminated(p_program_terminated),
+    m_p_worker_handlers(num_slots),
+    m_slot_task_ids(num_slots),
+    m_slot_start_times(num_slots)
 {
 }
 
@@ -41,8 +52,6 @@ Manager::~Manager()
         MPI_Request_free(&m_message_request);
     if (m_signal_request != MPI_REQUEST_NULL)
         MPI_Request_free(&m_signal_request);
-    if (m_error_code_request != MPI_REQUEST_NULL)
-        MPI_Request_free(&m_error_code_request);
 }
 
 // Probe whether Manager is active
@@ -58,6 +67,10 @@ void Manager::iterate()
     // terminated
     assert(m_state != terminated);
 
+    // Reap terminated Workers that have exited and kill those that have
+    // outlived the kill timeout
+    reap_terminating_processes();
+
     // Switch based on state
     switch (m_state)
     {
@@ -74,11 +87,27 @@ void Manager::iterate()
     }
 }
 
+// Register events
+void Manager::registerEvents(EventWaiter& waiter) const
+{
+    // Always wait for signals and messages from Master
+    waiter.addProbe(MASTER_RANK, MASTER_SIGNAL_TAG, MPI_COMM_WORLD);
+    waiter.addProbe(MASTER_RANK, MASTER_MSG_TAG, MPI_COMM_WORLD);
+
+    // Wait for Workers
+    for (auto it = m_p_worker_handlers.begin();
+            it != m_p_worker_handlers.end(); it++)
+        if (*it)
+            (*it)->registerEvents(waiter);
+}
+
 // Do idle stuff
 void Manager::doIdleStuff()
 {
-    // Sanity check: m_p_worker_handler should be the null pointer
-    assert(!m_p_worker_handler);
+    // Sanity check: all Worker slots should be idle and there should be no
+    // queued tasks
+    assert(!anySlotBusy());
+    assert(m_queued_tasks.empty());
 
     // Check for program termination interrupt
     if (*m_p_program_terminated)
@@ -127,9 +156,9 @@ void Manager::doIdleStuff()
         spdlog::debug("Idle manager {}/{}: received message!",
                 get_mpi_comm_world_rank(), get_mpi_comm_world_size());
 
-        // Receive input string and create new Worker
-        std::string input_string = receiveMessage();
-        createWorker(input_string);
+        // Receive tasks and start Workers
+        receiveTasks();
+        startWorkers();
 
         // Switch to busy state
         m_state = busy;
@@ -140,14 +169,15 @@ void Manager::doIdleStuff()
 // Do busy stuff
 void Manager::doBusyStuff()
 {
-    // Sanity check: m_p_worker_handler should not be the null pointer
-    assert(m_p_worker_handler);
+    // Sanity check: at least one Worker slot should be busy or there should be
+    // queued tasks
+    assert(anySlotBusy() || !m_queued_tasks.empty());
 
     // Check for program termination interrupt
     if (*m_p_program_terminated)
     {
-        // Terminate Worker
-        terminateWorker();
+        // Terminate Workers
+        terminateWorkers();
 
         // Terminate Manager
         m_state = terminated;
@@ -165,8 +195,8 @@ void Manager::doBusyStuff()
                         "TERMINATE_MANAGER_SIGNAL!",
                         get_mpi_comm_world_rank(), get_mpi_comm_world_size());
 
-                // Terminate Worker
-                terminateWorker();
+                // Terminate Workers
+                terminateWorkers();
 
                 // Terminate Manager
                 m_state = terminated;
@@ -178,11 +208,9 @@ void Manager::doBusyStuff()
                         "FLUSH_WORKER_SIGNAL!",
                         get_mpi_comm_world_rank(), get_mpi_comm_world_size());
 
-                // Flush Worker
-                flushWorker();
-
-                // Send WORKER_FLUSHED_SIGNAL result
-                sendSignalToMaster(WORKER_FLUSHED_SIGNAL);
+                // Flush tasks and send WORKER_FLUSHED_SIGNAL with number of
+                // flushed tasks
+                sendSignalToMaster(WORKER_FLUSHED_SIGNAL, flushTasks());
 
                 // Switch to idle state
                 m_state = idle;
@@ -195,57 +223,114 @@ void Manager::doBusyStuff()
         }
     }
 
-    // Check if Worker has finished
-    if (m_p_worker_handler->isDone())
+    // Check for message with more tasks
+    if (probeMessage())
     {
-        spdlog::debug("Busy manager {}/{}: Worker is done!",
+        spdlog::debug("Busy manager {}/{}: received message!",
                 get_mpi_comm_world_rank(), get_mpi_comm_world_size());
 
-        // Get output string
-        std::string output_string = m_p_worker_handler->getOutput();
+        // Receive and queue tasks
+        receiveTasks();
+    }
 
-        // Get error code
-        int error_code = m_p_worker_handler->getErrorCode();
+    // Collect results of finished Workers
+    collectFinishedWorkers();
 
-        // Send output string to master
-        sendMessageToMaster(output_string);
+    // Start queued tasks on idle Worker slots
+    startWorkers();
 
-        // Send error code to master
-        sendErrorCodeToMaster(error_code);
+    // Report results to Master
+    reportResults();
 
-        // Flush Worker
-        flushWorker();
+    // If all tasks have finished, switch to idle state
+    if (!anySlotBusy() && m_queued_tasks.empty())
+    {
+        // Sanity check: all results should have been reported
+        assert(m_results.empty());
 
-        // Switch to idle state
         m_state = idle;
-        return;
     }
+}
+
+// Receive tasks from Master and queue them
+void Manager::receiveTasks()
+{
+    // Receive message
+    std::vector<char> buffer = receiveMessage();
+    int position = 0;
+
+    // Unpack batch size, prefetch depth and number of tasks, followed by task
+    // identifier and input string of every task
+    m_batch_size = unpack_integer(MPI_COMM_WORLD, buffer, position);
+    m_prefetch = unpack_integer(MPI_COMM_WORLD, buffer, position);
+    int num_tasks = unpack_integer(MPI_COMM_WORLD, buffer, position);
+    for (int i = 0; i < num_tasks; i++)
+    {
+        QueuedTask task;
+        task.task_id = unpack_task_id(MPI_COMM_WORLD, buffer, position);
+        task.input_string = unpack_string(MPI_COMM_WORLD, buffer, position);
+        m_queued_tasks.push(std::move(task));
+    }
+}
 
-    // Sanity check: No message should be received in the busy state
-    assert(probeMessage() == false);
+// Start queued tasks on idle Worker slots
+void Manager::startWorkers()
+{
+    for (int slot = 0; slot < static_cast<int>(m_p_worker_handlers.size());
+            slot++)
+    {
+        // If there are no more queued tasks, return immediately
+        if (m_queued_tasks.empty())
+            return;
+
+        // Skip busy Worker slots
+        if (m_p_worker_handlers[slot])
+            continue;
+
+        // Start Worker and record task identifier and start time
+        QueuedTask& task = m_queued_tasks.front();
+        const std::int64_t spawn_start = Tracer::now();
+        createWorker(slot, task.input_string);
+        Tracer::recordSpan(Tracer::spawn_event, slot + 1, spawn_start,
+                task.task_id);
+        m_slot_task_ids[slot] = task.task_id;
+        m_slot_start_times[slot] = std::chrono::steady_clock::now();
+
+        // Pop queued task
+        m_queued_tasks.pop();
+    }
 }
 
-// Create Worker
-void Manager::createWorker(const std::string& input_string)
+// Create Worker in slot
+void Manager::createWorker(int slot, const std::string& input_string)
 {
-    // Sanity check: m_p_worker_handler should be the null pointer
-    assert(!m_p_worker_handler);
+    // Sanity check: Worker slot should be idle
+    assert(!m_p_worker_handlers[slot]);
 
     // Switch on Worker type
     switch (m_worker_type)
     {
         // Fork Worker
         case forked_worker:
-            m_p_worker_handler =
+            m_p_worker_handlers[slot] =
                 std::unique_ptr<ForkedWorkerHandler>(
                         new ForkedWorkerHandler(m_simulator, input_string));
             break;
 
         // Spawn MPI Worker
         case mpi_worker:
-            m_p_worker_handler =
+            m_p_worker_handlers[slot] =
                 std::unique_ptr<MPIWorkerHandler>(
-                        new MPIWorkerHandler(m_simulator, input_string));
+                        new MPIWorkerHandler(m_simulator, input_string,
+                            slot));
+            break;
+
+        // Persistent Worker
+        case persistent_worker:
+            m_p_worker_handlers[slot] =
+                std::unique_ptr<PersistentWorkerHandler>(
+                        new PersistentWorkerHandler(m_simulator,
+                            input_string, slot));
             break;
 
         default:
@@ -253,27 +338,116 @@ void Manager::createWorker(const std::string& input_string)
     }
 }
 
-// Flush Worker
-void Manager::flushWorker()
+// Flush Workers, queued tasks and unreported results
+int Manager::flushTasks()
+{
+    Tracer::Span span(Tracer::flush_event);
+
+    // Count tasks that the Master has not yet received results for
+    int num_flushed = m_queued_tasks.size() + m_results.size();
+
+    // Reset busy Worker handlers to null pointer, this flushes the Workers
+    for (auto it = m_p_worker_handlers.begin();
+            it != m_p_worker_handlers.end(); it++)
+    {
+        if (*it)
+        {
+            it->reset();
+            num_flushed++;
+        }
+    }
+
+    // Discard queued tasks and unreported results
+    while (!m_queued_tasks.empty()) m_queued_tasks.pop();
+    m_results.clear();
+
+    span.setValue(num_flushed);
+    return num_flushed;
+}
+
+// Terminate Workers
+void Manager::terminateWorkers()
+{
+    // Reset Worker handlers to null pointer
+    for (auto it = m_p_worker_handlers.begin();
+            it != m_p_worker_handlers.end(); it++)
+        it->reset();
+}
+
+// Collect results of finished Workers
+void Manager::collectFinishedWorkers()
+{
+    for (int slot = 0; slot < static_cast<int>(m_p_worker_handlers.size());
+            slot++)
+    {
+        // Skip idle and unfinished Workers
+        if (!m_p_worker_handlers[slot] || !m_p_worker_handlers[slot]->isDone())
+            continue;
+
+        // Record result
+        std::chrono::duration<double> duration =
+            std::chrono::steady_clock::now() - m_slot_start_times[slot];
+        Tracer::recordSpan(Tracer::simulate_event, slot + 1,
+                Tracer::timestamp(m_slot_start_times[slot]),
+                m_slot_task_ids[slot]);
+
+        Result result;
+        result.task_id = m_slot_task_ids[slot];
+        result.error_code = m_p_worker_handlers[slot]->getErrorCode();
+        result.duration = duration.count();
+        result.output_string = m_p_worker_handlers[slot]->getOutput();
+        m_results.push_back(std::move(result));
+
+        // Flush finished Worker
+        m_p_worker_handlers[slot].reset();
+    }
+}
+
+// Report results to Master
+void Manager::reportResults()
+{
+    // If there are no results, return immediately
+    if (m_results.empty())
+        return;
+
+    // Report results once a full batch has finished on every Worker slot, or
+    // when the Manager is running out of tasks so that the Master can send
+    // more.  With prefetching, the Manager is running out of tasks as soon
+    // as fewer tasks than the prefetch depth remain queued.
+    if (    (m_results.size() >= m_batch_size * m_p_worker_handlers.size()) ||
+            (static_cast<int>(m_queued_tasks.size()) < m_prefetch) ||
+            (m_queued_tasks.empty() && anySlotIdle()) )
+    {
+        spdlog::debug("Busy manager {}/{}: reporting {} results!",
+                get_mpi_comm_world_rank(), get_mpi_comm_world_size(),
+                m_results.size());
+
+        // Send results to master
+        sendMessageToMaster();
+        m_results.clear();
+    }
+}
+
+// Return whether any Worker slot is busy
+bool Manager::anySlotBusy() const
 {
-    // Sanity check: This function should not be called when
-    // m_p_worker_handler is the null pointer
-    assert(m_p_worker_handler);
+    for (auto it = m_p_worker_handlers.begin();
+            it != m_p_worker_handlers.end(); it++)
+        if (*it)
+            return true;
 
-    // Reset m_p_worker_handler to null pointer,
-    // this flushes the worker
-    m_p_worker_handler.reset();
+    return false;
 }
 
-// Terminate Worker
-void Manager::terminateWorker()
+// Return whether any Worker slot is idle
+bool Manager::anySlotIdle() const
 {
-    // Sanity check: This function should not be called when
-    // m_p_worker_handler is the null pointer
-    assert(m_p_worker_handler);
+    for (auto it = m_p_worker_handlers.begin();
+            it != m_p_worker_handlers.end(); it++)
+        if (!*it)
+            return true;
 
-    // Reset m_p_worker_handler to null pointer
-    m_p_worker_handler.reset();
+    return false;
 }
 
 // Probe for message
@@ -289,12 +463,12 @@ bool Manager::probeSignal() const
 }
 
 // Receive message
-std::string Manager::receiveMessage() const
+std::vector<char> Manager::receiveMessage() const
 {
     // Sanity check: probeMessage must return true
     assert(probeMessage());
 
-    return receive_string(MPI_COMM_WORLD, MASTER_RANK, MASTER_MSG_TAG);
+    return receive_packed(MPI_COMM_WORLD, MASTER_RANK, MASTER_MSG_TAG);
 }
 
 // Receive signal
@@ -307,52 +481,47 @@ int Manager::receiveSignal() const
 }
 
 // Send message to Master
-void Manager::sendMessageToMaster(const std::string& message_string)
+void Manager::sendMessageToMaster()
 {
     // Ensure previous message has finished sending
     MPI_Wait(&m_message_request, MPI_STATUS_IGNORE);
 
-    // Store message string in buffer
-    m_message_buffer.assign(message_string);
+    // Pack number of results, followed by task identifier, error code,
+    // duration and output string of every result
+    m_message_buffer.clear();
+    pack_integer(MPI_COMM_WORLD, m_results.size(), m_message_buffer);
+    for (auto it = m_results.begin(); it != m_results.end(); it++)
+    {
+        pack_task_id(MPI_COMM_WORLD, it->task_id, m_message_buffer);
+        pack_integer(MPI_COMM_WORLD, it->error_code, m_message_buffer);
+        pack_double(MPI_COMM_WORLD, it->duration, m_message_buffer);
+        pack_string(MPI_COMM_WORLD, it->output_string, m_message_buffer);
+    }
 
     // Note: Isend is used here to avoid deadlock since the Master and the root
     // Manager are executed by the same process
     MPI_Isend(
-            m_message_buffer.c_str(),
-            m_message_buffer.size() + 1,
-            MPI_CHAR, MASTER_RANK, MANAGER_MSG_TAG,
+            m_message_buffer.data(),
+            m_message_buffer.size(),
+            MPI_PACKED, MASTER_RANK, MANAGER_MSG_TAG,
             MPI_COMM_WORLD,
             &m_message_request);
 }
 
 // Send signal to Master
-void Manager::sendSignalToMaster(int signal)
+void Manager::sendSignalToMaster(int signal, int num_tasks)
 {
     // Ensure previous signal has finished sending
     MPI_Wait(&m_signal_request, MPI_STATUS_IGNORE);
 
-    // Store signal in buffer
-    m_signal_buffer = signal;
+    // Pack signal, followed by number of tasks it concerns
+    m_signal_buffer.clear();
+    pack_integer(MPI_COMM_WORLD, signal, m_signal_buffer);
+    pack_integer(MPI_COMM_WORLD, num_tasks, m_signal_buffer);
 
     // Note: Isend is used here to avoid deadlock since the Master and the root
     // Manager are executed by the same process
-    MPI_Isend(&m_signal_buffer, 1, MPI_INT, MASTER_RANK,
-            MANAGER_SIGNAL_TAG, MPI_COMM_WORLD,
+    MPI_Isend(m_signal_buffer.data(), m_signal_buffer.size(), MPI_PACKED,
+            MASTER_RANK, MANAGER_SIGNAL_TAG, MPI_COMM_WORLD,
             &m_signal_request);
 }
-
-// Send error code to Master
-void Manager::sendErrorCodeToMaster(int error_code)
-{
-    // Ensure previous error code has finished sending
-    MPI_Wait(&m_error_code_request, MPI_STATUS_IGNORE);
-
-    // Store error_code in buffer
-    m_error_code_buffer = error_code;
-
-    // Note: Isend is used here to avoid deadlock since the Master and the root
-    // Manager are executed by the same process
-    MPI_Isend(&m_error_code_buffer, 1, MPI_INT, MASTER_RANK,
-            MANAGER_ERROR_CODE_TAG, MPI_COMM_WORLD,
-            &m_error_code_request);
-}
@@ -2,15 +2,20 @@
 #define MANAGER_H
 
 #include <string>
+#include <vector>
+#include <queue>
 #include <memory>
+#include <chrono>
 
 #include <assert.h>
 
 #include <mpi.h>
 
 #include "core/Command.h"
+#include "core/TaskHandler.h"
 
 class AbstractWorkerHandler;
+class EventWaiter;
 
 /** A helper class for performing simulation tasks in parallel using MPI.
  *
@@ -18,6 +23,24 @@ class AbstractWorkerHandler;
  * child processes (also called Workers) to perform the simulation, and report
  * the results back to MPIMaster.
  *
+ * A Manager owns a fixed number of Worker slots, each of which runs at most
+ * one Worker at a time.  This allows one MPI process to drive all the
+ * Workers on a node, instead of having to launch one MPI process per Worker.
+ *
+ * The MPIMaster sends simulation tasks to a Manager in batches.  The Manager
+ * queues the tasks it receives and runs them back to back on its Worker
+ * slots.  The results of finished tasks are collected and reported to the
+ * MPIMaster in a single message once a full batch has finished, or once the
+ * Manager has run out of queued tasks.  With every result, the Manager
+ * reports how long the simulation took, so that the MPIMaster can adapt the
+ * batch size to the duration of the simulations.
+ *
+ * The MPIMaster may also keep a number of extra tasks queued on every
+ * Manager, called the prefetch depth, so that a Worker slot can start its
+ * next task as soon as the current one finishes instead of waiting for a
+ * round trip to the MPIMaster.  The Manager reports its results early when
+ * fewer tasks than the prefetch depth remain queued.
+ *
  * The Workers can be either a forked Worker or an MPI Worker.  These are
  * represented by the ForkedWorkerHandler and MPIWorkerHandler classes,
  * respectively (both are derived form the AbstractWorkerHandler class).  The
@@ -36,7 +59,8 @@ class Manager
         enum worker_t
         {
             forked_worker,
-            mpi_worker
+            mpi_worker,
+            persistent_worker
         };
 
         /** Constructor.
@@ -45,9 +69,10 @@ class Manager
          * @param worker_type  type of Worker
          * @param p_program_terminated  pointer to boolean flag that is set
          * when the execution of Pakman is terminated by the user.
+         * @param num_slots  number of Worker slots.
          */
         Manager(const Command &simulator, worker_t worker_type,
-                bool *p_program_terminated);
+                bool *p_program_terminated, int num_slots = 1);
 
         /** Default destructor destroys MPI_Request objects. */
         ~Manager();
@@ -58,14 +83,26 @@ class Manager
         /** Iterates the Manager in an event loop. */
         void iterate();
 
+        /** Register the events that the Manager is waiting for.
+         *
+         * The Manager always waits for signals and messages from the
+         * MPIMaster.  When busy, the Manager also waits for its Workers to
+         * make progress.
+         *
+         * @param waiter  EventWaiter to register events with.
+         */
+        void registerEvents(EventWaiter& waiter) const;
+
     private:
 
         /** Enumerate type for Manager states.
          *
          * The Manager can either in a `idle` state, a `busy` state, or in a
-         * `terminated` state.  When the Manager is in a `terminated` state,
-         * the member function isActive() will return false and the event loop
-         * should terminate.
+         * `terminated` state.  The Manager is busy when at least one of its
+         * Worker slots is running a Worker or when it has queued tasks, and
+         * idle otherwise.
+         * When the Manager is in a `terminated` state, the member function
+         * isActive() will return false and the event loop should terminate.
          */
         enum state_t { idle, busy, terminated };
 
@@ -76,14 +113,34 @@ class Manager
         // Do busy stuff
         void doBusyStuff();
 
-        // Create Worker
-        void createWorker(const std::string& input_string);
+        // Receive tasks from Master and queue them
+        void receiveTasks();
+
+        // Start queued tasks on idle Worker slots
+        void startWorkers();
+
+        // Create Worker in slot
+        void createWorker(int slot, const std::string& input_string);
+
+        // Terminate all Workers
+        void terminateWorkers();
+
+        // Flush all Workers, queued tasks and unreported results, and return
+        // the number of flushed tasks
+        int flushTasks();
+
+        // Collect results of finished Workers and flush them
+        void collectFinishedWorkers();
+
+        // Report collected results to Master if a batch has finished or if
+        // the queue is running low on tasks
+        void reportResults();
 
-        // Terminate Worker
-        void terminateWorker();
+        // Return whether any Worker slot is busy
+        bool anySlotBusy() const;
 
-        // Flush Worker
-        void flushWorker();
+        // Return whether any Worker slot is idle
+        bool anySlotIdle() const;
 
         // Probe for message
         bool probeMessage() const;
@@ -92,19 +149,32 @@ class Manager
         bool probeSignal() const;
 
         // Receive message
-        std::string receiveMessage() const;
+        std::vector<char> receiveMessage() const;
 
         // Receive signal
         int receiveSignal() const;
 
-        // Send message to Master
-        void sendMessageToMaster(const std::string& message_string);
+        // Send collected results to Master
+        void sendMessageToMaster();
 
-        // Send signal to Master
-        void sendSignalToMaster(int signal);
+        // Send signal concerning the given number of tasks to Master
+        void sendSignalToMaster(int signal, int num_tasks);
 
-        // Send error code to Master
-        void sendErrorCodeToMaster(int error_code);
+        // Queued task
+        struct QueuedTask
+        {
+            task_id_t task_id;
+            std::string input_string;
+        };
+
+        // Result of finished task
+        struct Result
+        {
+            task_id_t task_id;
+            int error_code;
+            double duration;
+            std::string output_string;
+        };
 
         ///// Member variables /////
         // Initial state is idle
@@ -119,26 +189,40 @@ class Manager
         // Pointer to program terminated flag
         bool *m_p_program_terminated;
 
-        // Pointer to Worker handler
-        std::unique_ptr<AbstractWorkerHandler> m_p_worker_handler;
+        // Pointers to Worker handlers, indexed by Worker slot
+        std::vector<std::unique_ptr<AbstractWorkerHandler>>
+            m_p_worker_handlers;
+
+        // Identifiers of tasks running on Worker slots
+        std::vector<task_id_t> m_slot_task_ids;
+
+        // Start times of tasks running on Worker slots
+        std::vector<std::chrono::steady_clock::time_point> m_slot_start_times;
+
+        // Queued tasks
+        std::queue<QueuedTask> m_queued_tasks;
+
+        // Results that have not yet been reported to Master
+        std::vector<Result> m_results;
+
+        // Number of results per Worker slot to report at once, as set by
+        // the Master
+        int m_batch_size = 1;
+
+        // Number of extra tasks the Master keeps queued, as set by the Master
+        int m_prefetch = 0;
 
         // Message buffer
-        std::string m_message_buffer;
+        std::vector<char> m_message_buffer;
 
         // Message request
         MPI_Request m_message_request = MPI_REQUEST_NULL;
 
         // Signal buffer
-        int m_signal_buffer;
+        std::vector<char> m_signal_buffer;
 
         // Signal request
         MPI_Request m_signal_request = MPI_REQUEST_NULL;
-
-        // Error code buffer
-        int m_error_code_buffer;
-
-        // Error code request
-        MPI_Request m_error_code_request = MPI_REQUEST_NULL;
 };
 
 #endif // MANAGER_H
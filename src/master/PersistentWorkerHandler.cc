@@ -0,0 +1,294 @@
+#include <string>
+#include <vector>
+#include <chrono>
+#include <tuple>
+#include <stdexcept>
+
+#include <stdio.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "spdlog/spdlog.h"
+
+#include "core/common.h"
+#include "system/system_call.h"
+#include "system/pipe_io.h"
+
+#include "EventWaiter.h"
+
+#include "PersistentWorkerHandler.h"
+
+// Initialize static simulator processes of PersistentWorkerHandler to no
+// Worker slots
+std::vector<PersistentWorkerHandler::Process>
+PersistentWorkerHandler::s_processes;
+Command PersistentWorkerHandler::s_simulator;
+
+PersistentWorkerHandler::PersistentWorkerHandler(
+        const Command& simulator,
+        const std::string& input_string, int slot) :
+    AbstractWorkerHandler(simulator, input_string),
+    m_slot(slot)
+{
+    // Initialize new Worker slots to no process
+    if (s_processes.size() <= static_cast<std::size_t>(m_slot))
+        s_processes.resize(m_slot + 1);
+
+    // Send framed input string to simulator process
+    sendInput();
+}
+
+PersistentWorkerHandler::~PersistentWorkerHandler()
+{
+    // If the simulation task has not finished, the simulator process is still
+    // busy with it, so terminate the simulator process
+    if (!m_result_received && process().pid)
+        stopProcess(m_slot);
+}
+
+bool PersistentWorkerHandler::isDone()
+{
+    // If result has already been received, return immediately
+    if (m_result_received)
+        return true;
+
+    // Poll read pipe
+    bool pipe_closed = poll_read_from_pipe(process().read_fd, m_raw_output);
+
+    // Check if framed output has been received completely
+    if (parseOutput())
+    {
+        process().num_replies++;
+        m_result_received = true;
+        return true;
+    }
+
+    // If read pipe was closed before the framed output was received
+    // completely, the simulator process has exited prematurely
+    if (pipe_closed)
+    {
+        reapProcess();
+
+        // A simulator process that replied to earlier tasks and exited
+        // without any output most likely exited before reading this task, so
+        // send it again to a new simulator process
+        if (m_may_resend && m_raw_output.empty())
+        {
+            m_may_resend = false;
+            sendInput();
+            return false;
+        }
+
+        m_result_received = true;
+    }
+
+    return m_result_received;
+}
+
+void PersistentWorkerHandler::registerEvents(EventWaiter& waiter) const
+{
+    // Wait for output or closing of read pipe
+    if (!m_result_received)
+        waiter.addFileDescriptor(process().read_fd);
+}
+
+void PersistentWorkerHandler::terminateStatic()
+{
+    // Close stdin of simulator processes, which signals them to exit
+    for (auto it = s_processes.begin(); it != s_processes.end(); it++)
+    {
+        if (it->pid)
+        {
+            close_check(it->write_fd);
+            it->write_fd = -1;
+        }
+    }
+
+    // Give simulator processes g_kill_timeout to exit, which is detected by
+    // the read pipe closing
+    auto deadline = std::chrono::steady_clock::now() + g_kill_timeout;
+    for (int slot = 0; slot < static_cast<int>(s_processes.size()); slot++)
+    {
+        // If there is no simulator process, nothing needs to be done
+        if (!s_processes[slot].pid)
+            continue;
+
+        struct pollfd fds;
+        fds.fd = s_processes[slot].read_fd;
+        fds.events = POLLIN;
+
+        std::string discarded_output;
+        while (!poll_read_from_pipe(s_processes[slot].read_fd,
+                    discarded_output)
+                && std::chrono::steady_clock::now() < deadline)
+            check_poll(&fds, 1, 1);
+
+        // Terminate simulator process if it has not exited yet
+        stopProcess(slot);
+    }
+}
+
+void PersistentWorkerHandler::startProcess()
+{
+    // Start process
+    std::tie(process().pid, process().write_fd, process().read_fd) =
+        system_call_non_blocking_read_write(m_simulator);
+
+    // Save command
+    s_simulator = m_simulator;
+}
+
+void PersistentWorkerHandler::sendInput()
+{
+    std::string framed_input(std::to_string(m_input_string.size()));
+    framed_input += '\n';
+    framed_input += m_input_string;
+
+    // Restart simulator process if it has exited since its last task
+    if (process().pid && processExited())
+        spdlog::debug("PersistentWorkerHandler: restarting simulator in "
+                "slot {}", m_slot);
+
+    // Start simulator process if it is not running
+    if (!process().pid)
+        startProcess();
+
+    // Write framed input string to simulator process.  If the simulator
+    // process has replied to earlier tasks, it may have exited in the
+    // meantime, in which case the task is sent to a new simulator process.
+    // Otherwise, the task is finished when isDone() detects that the read
+    // pipe was closed.
+    m_may_resend = process().num_replies > 0;
+    if (!try_write_to_pipe(process().write_fd, framed_input)
+            && m_may_resend)
+    {
+        reapProcess();
+        m_may_resend = false;
+        startProcess();
+        try_write_to_pipe(process().write_fd, framed_input);
+    }
+}
+
+bool PersistentWorkerHandler::processExited()
+{
+    int status = 0;
+    pid_t pid = waitpid(process().pid, &status, WNOHANG);
+    if (pid == -1)
+    {
+        std::string error_msg("waitpid of ");
+        error_msg += s_simulator.str();
+        error_msg += " failed, errno = ";
+        error_msg += get_waitpid_errno();
+        std::runtime_error e(error_msg);
+        throw e;
+    }
+
+    // Process is still running
+    if (pid == 0)
+        return false;
+
+    // Close pipes and mark simulator process as gone
+    close_check(process().write_fd);
+    close_check(process().read_fd);
+    process() = Process();
+
+    return true;
+}
+
+void PersistentWorkerHandler::reapProcess()
+{
+    // Wait on simulator process
+    int status = 0;
+    if (waitpid(process().pid, &status, 0) == -1)
+    {
+        std::string error_msg("waitpid of ");
+        error_msg += s_simulator.str();
+        error_msg += " failed, errno = ";
+        error_msg += get_waitpid_errno();
+        std::runtime_error e(error_msg);
+        throw e;
+    }
+
+    // Determine error code.  A simulator process that exits without replying
+    // is always an error.
+    if (WIFEXITED(status))
+        m_error_code = WEXITSTATUS(status) ? WEXITSTATUS(status) : 1;
+    else if (WIFSIGNALED(status))
+        m_error_code = 128 + WTERMSIG(status);
+    else
+        m_error_code = 1;
+
+    // Discard partial output
+    m_output_buffer.clear();
+
+    // Close pipes
+    close_check(process().write_fd);
+    close_check(process().read_fd);
+
+    // Mark simulator process as gone
+    process() = Process();
+}
+
+bool PersistentWorkerHandler::parseOutput()
+{
+    // Find end of header
+    std::size_t header_end = m_raw_output.find('\n');
+    if (header_end == std::string::npos)
+        return false;
+
+    // Parse header
+    std::size_t length = 0;
+    int error_code = 0;
+    if (sscanf(m_raw_output.c_str(), "%zu %d", &length, &error_code) != 2)
+    {
+        std::string error_msg("invalid output header from persistent "
+                "simulator: ");
+        error_msg += m_raw_output.substr(0, header_end);
+        std::runtime_error e(error_msg);
+        throw e;
+    }
+
+    // Check if output string has been received completely
+    if (m_raw_output.size() < header_end + 1 + length)
+        return false;
+
+    // Output must not exceed the announced length
+    if (m_raw_output.size() > header_end + 1 + length)
+    {
+        std::runtime_error e("persistent simulator wrote more output than "
+                "announced in its output header");
+        throw e;
+    }
+
+    // Record output string and error code
+    m_output_buffer.assign(m_raw_output, header_end + 1, length);
+    m_error_code = error_code;
+
+    return true;
+}
+
+PersistentWorkerHandler::Process& PersistentWorkerHandler::process() const
+{
+    return s_processes[m_slot];
+}
+
+void PersistentWorkerHandler::stopProcess(int slot)
+{
+    Process& process = s_processes[slot];
+
+    // Close stdin of simulator process if it is still open
+    if (process.write_fd != -1)
+        close_check(process.write_fd);
+
+    // Terminate simulator process if it has not exited yet, without waiting
+    // for it to exit.  Its exit status is irrelevant since it is not running
+    // a simulation task.
+    terminate_process_async(process.pid, s_simulator, ignore_error);
+
+    // Close read pipe
+    close_check(process.read_fd);
+
+    // Mark simulator process as gone
+    process = Process();
+}
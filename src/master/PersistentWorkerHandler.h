@@ -0,0 +1,159 @@
+#ifndef PERSISTENTWORKERHANDLER_H
+#define PERSISTENTWORKERHANDLER_H
+
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "AbstractWorkerHandler.h"
+
+/** A class for representing persistent Workers.
+ *
+ * Persistent Workers are standard simulators that are started once with a
+ * `fork()`--`exec()` pattern and then handle a stream of simulation tasks on
+ * the same stdin and stdout.  This removes process creation from the cost of
+ * every simulation task, which matters when the simulator has a large
+ * start-up cost, for example an interpreter.
+ *
+ * Since the stdin of a persistent Worker is never closed between tasks, the
+ * inputs and outputs are framed by a length prefix.  Pakman writes the input
+ * string to the stdin of the simulator as
+ * ```
+ * <length of input string>\n<input string>
+ * ```
+ * and the simulator replies by writing
+ * ```
+ * <length of output string> <error code>\n<output string>
+ * ```
+ * to its stdout, after which it should flush its stdout and wait for the next
+ * input.  When Pakman closes the stdin of the simulator, the simulator should
+ * exit.
+ *
+ * As with the MPIWorkerHandler, each simulation task is represented by a new
+ * instance of PersistentWorkerHandler, while the simulator process survives
+ * across instances.  If the simulator process exits before replying, the
+ * simulation task finishes with the exit status of the simulator as its
+ * error code (or 128 plus the signal number if the simulator was killed by a
+ * signal), and a new simulator process is started for the next task.
+ *
+ * A simulator process may also exit after replying to a task, for example
+ * because it handles a limited number of tasks.  If the simulator process has
+ * exited before the next task was sent, or exits without replying to a task
+ * after it had replied to earlier tasks, the simulator process is restarted
+ * and the task is sent again, once, since the task has most likely not run.
+ * When a
+ * PersistentWorkerHandler is destroyed before its simulation task has
+ * finished, the simulator process is terminated and will likewise be
+ * restarted for the next task.  Only when terminateStatic() is called will the
+ * last simulator process be shut down.
+ *
+ * Since a Manager can run several Workers concurrently, every Worker slot of
+ * the Manager has its own simulator process.
+ */
+
+class PersistentWorkerHandler : public AbstractWorkerHandler
+{
+
+    public:
+
+        /** Construct from simulator string and input string.
+         *
+         * If there is no running simulator process, the constructor starts
+         * one.  The framed input string is then written to the stdin of the
+         * simulator process.
+         *
+         * @param simulator  command to run simulation.
+         * @param input_string  input string to simulator.
+         * @param slot  Worker slot whose simulator process runs the
+         * simulation.
+         */
+        PersistentWorkerHandler(const Command& simulator,
+                const std::string& input_string, int slot = 0);
+
+        /** Destructor.
+         *
+         * If the simulation task has not finished, the destructor terminates
+         * the simulator process.
+         */
+        virtual ~PersistentWorkerHandler() override;
+
+        /** @return whether Worker has finished.
+         *
+         * Poll read pipe for any outstanding output and check whether the
+         * framed output has been received completely.
+         */
+        virtual bool isDone() override;
+
+        /** Register read pipe with EventWaiter.
+         *
+         * @param waiter  EventWaiter to register read pipe with.
+         */
+        virtual void registerEvents(EventWaiter& waiter) const override;
+
+        /** Shut down the simulator processes if there are any.
+         *
+         * The stdin of the simulator processes is closed, after which the
+         * simulator processes are terminated if they have not exited yet.
+         */
+        static void terminateStatic();
+
+    private:
+
+        // Simulator process
+        struct Process
+        {
+            pid_t pid = 0;
+            int write_fd = -1;
+            int read_fd = -1;
+
+            // Number of tasks that the process has replied to
+            int num_replies = 0;
+        };
+
+        // Start simulator process
+        void startProcess();
+
+        // Send framed input to simulator process, restarting the simulator
+        // process if it has exited
+        void sendInput();
+
+        // Return whether simulator process has exited, in which case it is
+        // reaped and its pipes are closed
+        bool processExited();
+
+        // Reap simulator process that exited prematurely
+        void reapProcess();
+
+        // Parse framed output
+        bool parseOutput();
+
+        // Simulator process of this Worker slot
+        Process& process() const;
+
+        // Close pipes and terminate simulator process of Worker slot
+        static void stopProcess(int slot);
+
+        // Simulator processes, indexed by Worker slot
+        // The processes are static so that they survive across multiple
+        // instances of PersistentWorkerHandler
+        static std::vector<Process> s_processes;
+
+        // Command of simulator processes
+        static Command s_simulator;
+
+        // Worker slot
+        const int m_slot;
+
+        // Raw output received from simulator process
+        std::string m_raw_output;
+
+        // Whether the task may be sent again if the simulator process exits
+        // without replying
+        bool m_may_resend = false;
+
+        // Flag for receiving result
+        bool m_result_received = false;
+};
+
+#endif // PERSISTENTWORKERHANDLER_H
@@ -1,18 +1,26 @@
 #include <string>
+#include <chrono>
 #include <memory>
 #include <utility>
 
 #include <assert.h>
 
+#include "core/common.h"
+#include "core/Tracer.h"
 #include "system/system_call.h"
 #include "controller/AbstractController.h"
 
+#include "PersistentWorkerHandler.h"
+#include "EventWaiter.h"
+
 #include "SerialMaster.h"
 
 // Construct from pointer to program terminated flag
 SerialMaster::SerialMaster(const Command& simulator,
-        bool *p_program_terminated) : AbstractMaster(p_program_terminated),
-    m_simulator(simulator)
+        bool *p_program_terminated, bool persistent_simulator) :
+    AbstractMaster(p_program_terminated),
+    m_simulator(simulator),
+    m_persistent_simulator(persistent_simulator)
 {
 }
 
@@ -57,10 +65,24 @@ bool SerialMaster::needMorePendingTasks() const
     return m_pending_tasks.size() < 1;
 }
 
+// Returns number of Workers
+int SerialMaster::numWorkers() const
+{
+    return 1;
+}
+
 // Push pending task
-void SerialMaster::pushPendingTask(const std::string& input_string)
+task_id_t SerialMaster::pushPendingTask(std::string input_string)
 {
-    m_pending_tasks.push(input_string);
+    task_id_t task_id = nextTaskId();
+    m_pending_tasks.emplace(std::move(input_string), task_id);
+    Tracer::record(Tracer::task_event, 'b', task_id);
+
+    // Tasks found in the cache stay in the pending queue to preserve their
+    // order, but are not given to a Worker
+    lookupCache(m_pending_tasks.back());
+
+    return task_id;
 }
 
 // Returns whether finished tasks queue is empty
@@ -78,14 +100,30 @@ TaskHandler& SerialMaster::frontFinishedTask()
 // Pop finished task
 void SerialMaster::popFinishedTask()
 {
+    Tracer::record(Tracer::task_event, 'e',
+            m_finished_tasks.front().getTaskId());
     m_finished_tasks.pop();
 }
 
 // Flush finished and pending tasks
 void SerialMaster::flush()
 {
-    while (!m_finished_tasks.empty()) m_finished_tasks.pop();
-    while (!m_pending_tasks.empty()) m_pending_tasks.pop();
+    Tracer::Span span(Tracer::flush_event);
+    span.setValue(m_finished_tasks.size() + m_pending_tasks.size());
+
+    while (!m_finished_tasks.empty())
+    {
+        Tracer::record(Tracer::task_event, 'e',
+                m_finished_tasks.front().getTaskId());
+        m_finished_tasks.pop();
+    }
+
+    while (!m_pending_tasks.empty())
+    {
+        Tracer::record(Tracer::task_event, 'e',
+                m_pending_tasks.front().getTaskId());
+        m_pending_tasks.pop();
+    }
 }
 
 // Terminate Master
@@ -95,25 +133,65 @@ void SerialMaster::terminate()
     return;
 }
 
+// Register events
+void SerialMaster::registerEvents(EventWaiter& waiter) const
+{
+    // Run pending tasks and deliver finished tasks without waiting
+    if (!m_pending_tasks.empty() || !m_finished_tasks.empty())
+        waiter.setReady();
+
+    // Wait for Controller
+    if (auto p_controller = m_p_controller.lock())
+        p_controller->registerEvents(waiter);
+}
+
 // Processes a task from pending queue if there is one and places it in
 // the finished queue when done.
 void SerialMaster::processTask()
 {
+    // Move tasks that were found in the cache to the finished queue
+    while (!m_pending_tasks.empty() && !m_pending_tasks.front().isPending())
+    {
+        m_finished_tasks.push(std::move(m_pending_tasks.front()));
+        m_pending_tasks.pop();
+    }
+
     // Return immediately if there are no pending tasks
     if (m_pending_tasks.empty())
         return;
 
     // Else, pop a pending task, process it and push it to the finished queue
     TaskHandler& current_task = m_pending_tasks.front();
+    Tracer::record(Tracer::dispatch_event, 'n', current_task.getTaskId());
 
-    // Process current task and get output string and error code
-    std::string output_string;
-    int error_code;
-    std::tie(output_string, error_code) =
-        system_call_error_code(m_simulator, current_task.getInputString());
+    if (m_persistent_simulator)
+    {
+        // Process current task on persistent simulator.  If the program was
+        // terminated in the meantime, leave the task in the pending queue.
+        if (!processPersistentTask(current_task))
+            return;
+    }
+    else
+    {
+        // Process current task and get output string and error code
+        auto start = std::chrono::steady_clock::now();
+        std::string output_string;
+        int error_code;
+        std::tie(output_string, error_code) =
+            system_call_error_code(m_simulator,
+                    current_task.getInputString());
+        std::chrono::duration<double> wall_time =
+            std::chrono::steady_clock::now() - start;
+        Tracer::recordSpan(Tracer::simulate_event, 1,
+                Tracer::timestamp(start), current_task.getTaskId());
+
+        // Record output string, error code and wall time
+        current_task.recordOutputAndErrorCode(std::move(output_string),
+                error_code, wall_time.count());
+    }
 
-    // Record output string and error code
-    current_task.recordOutputAndErrorCode(output_string, error_code);
+    // Add result to cache
+    insertCache(current_task);
 
     // Move task to finished queue
     m_finished_tasks.push(std::move(m_pending_tasks.front()));
@@ -121,3 +199,34 @@ void SerialMaster::processTask()
     // Pop pending queue
     m_pending_tasks.pop();
 }
+
+// Runs a task on the persistent simulator and returns whether the task has
+// finished
+bool SerialMaster::processPersistentTask(TaskHandler& task)
+{
+    // Send task to persistent simulator
+    auto start = std::chrono::steady_clock::now();
+    PersistentWorkerHandler worker_handler(m_simulator,
+            task.getInputString());
+
+    // Wait until task has finished or program is terminated
+    EventWaiter waiter(std::chrono::microseconds(0), g_main_timeout);
+    while (!worker_handler.isDone())
+    {
+        if (programTerminated())
+            return false;
+
+        worker_handler.registerEvents(waiter);
+        waiter.wait();
+    }
+
+    // Record output string, error code and wall time
+    std::chrono::duration<double> wall_time =
+        std::chrono::steady_clock::now() - start;
+    Tracer::recordSpan(Tracer::simulate_event, 1, Tracer::timestamp(start),
+            task.getTaskId());
+    task.recordOutputAndErrorCode(worker_handler.getOutput(),
+            worker_handler.getErrorCode(), wall_time.count());
+
+    return true;
+}
@@ -10,11 +10,14 @@
 
 class LongOptions;
 class Arguments;
+class EventWaiter;
 
 /** A Master class for performing simulation tasks serially.
  *
  * The SerialMaster class performs simulation tasks serially by spawning child
- * processes with `fork()`--`exec()` to run simulations.
+ * processes with `fork()`--`exec()` to run simulations.  Alternatively, all
+ * simulation tasks can be sent to a single persistent simulator process (see
+ * PersistentWorkerHandler).
  *
  * For instructions on how to use Pakman with the serial master, execute the
  * following command
@@ -32,8 +35,11 @@ class SerialMaster : public AbstractMaster
          * @param simulator  command to run simulation.
          * @param p_program_terminated  pointer to boolean flag that is set
          * when the execution of Pakman is terminated by the user.
+         * @param persistent_simulator  whether the simulator is a persistent
+         * simulator.
          */
-        SerialMaster(const Command& simulator, bool *p_program_terminated);
+        SerialMaster(const Command& simulator, bool *p_program_terminated,
+                bool persistent_simulator = false);
 
         /** Default destructor does nothing. */
         virtual ~SerialMaster() override = default;
@@ -44,11 +50,17 @@ class SerialMaster : public AbstractMaster
         /** @return whether more pending tasks are needed. */
         virtual bool needMorePendingTasks() const override;
 
+        /** @return number of Workers that perform tasks at the same time. */
+        virtual int numWorkers() const override;
+
         /** Push a new pending task.
          *
          * @param input_string  input string to simulation job.
+         *
+         * @return identifier of the new task.
          */
-        virtual void pushPendingTask(const std::string& input_string) override;
+        virtual task_id_t pushPendingTask(std::string input_string)
+            override;
 
         /** @return whether finished tasks queue is empty. */
         virtual bool finishedTasksEmpty() const override;
@@ -65,6 +77,16 @@ class SerialMaster : public AbstractMaster
         /** Terminate SerialMaster. */
         virtual void terminate() override;
 
+        /** Register the events that the SerialMaster is waiting for.
+         *
+         * Since the SerialMaster runs simulations synchronously, it only waits
+         * when it has no tasks, in which case it waits for its Controller to
+         * make progress.
+         *
+         * @param waiter  EventWaiter to register events with.
+         */
+        void registerEvents(EventWaiter& waiter) const;
+
         /** @return help message string. */
         static std::string help();
 
@@ -84,7 +106,7 @@ class SerialMaster : public AbstractMaster
          */
         static void run(controller_t controller, const Arguments& args);
 
-        /** For SerialMaster, this function does nothing. */
+        /** Shut down persistent simulator if there is one. */
         static void cleanup();
 
     protected:
@@ -108,6 +130,11 @@ class SerialMaster : public AbstractMaster
         // the finished queue when done.
         void processTask();
 
+        // Runs a task on the persistent simulator and returns whether the task
+        // has finished.  If the program is terminated before the task has
+        // finished, false is returned.
+        bool processPersistentTask(TaskHandler& task);
+
         ///// Member variables /////
         // Initial state is normal
         state_t m_state = normal;
@@ -115,6 +142,9 @@ class SerialMaster : public AbstractMaster
         // Simulator command
         const Command m_simulator;
 
+        // Whether simulator is persistent
+        const bool m_persistent_simulator;
+
         // Finished tasks
         std::queue<TaskHandler> m_finished_tasks;
 
@@ -1,5 +1,6 @@
 #include <string>
 #include <memory>
+#include <chrono>
 
 #include <getopt.h>
 
@@ -7,10 +8,14 @@
 #include "core/Arguments.h"
 #include "core/LongOptions.h"
 #include "core/Command.h"
+#include "core/Tracer.h"
 #include "system/signal_handler.h"
 #include "system/debug.h"
+#include "system/system_call.h"
 #include "controller/AbstractController.h"
 
+#include "PersistentWorkerHandler.h"
+#include "EventWaiter.h"
 #include "SerialMaster.h"
 
 // Static help function
@@ -23,12 +28,32 @@ Description:
   When using a serial master, pakman executes simulations sequentially.  It is
   assumed that the simulator is a standard simulator, which means that it
   communicates with pakman through its stdin and stdout.
+
+  By default, a new simulator process is started for every simulation.  If the
+  optional argument --persistent-simulator is given, a single simulator process
+  is started instead, which runs all simulations one after the other.  Since
+  its stdin stays open between simulations, the input and output of every
+  simulation are prefixed with their length in bytes.  The input is sent as
+
+    <length of input>\n<input>
+
+  and the simulator must reply with
+
+    <length of output> <error code>\n<output>
+
+  and flush its stdout.  The simulator should exit when its stdin is closed.
+  This removes the cost of starting a process from every simulation, which
+  matters for simulators with a large start-up cost, such as interpreted
+  scripts.
+
+Serial master options:
+  -l, --persistent-simulator   simulator is a persistent simulator
 )";
 }
 
 void SerialMaster::addLongOptions(LongOptions& lopts)
 {
-    // No SerialMaster-specific options to add
+    lopts.add({"persistent-simulator", no_argument, nullptr, 'l'});
 }
 
 // Static run function
@@ -44,24 +69,50 @@ void SerialMaster::run(controller_t controller, const Arguments& args)
 
     auto p_master =
         std::make_shared<SerialMaster>(p_controller->getSimulator(),
-                &g_program_terminated);
+                &g_program_terminated,
+                args.isOptionalArgumentSet("persistent-simulator"));
 
     // Associate with each other
     p_master->assignController(p_controller);
     p_controller->assignMaster(p_master);
 
+    // Create EventWaiter for event loop
+    EventWaiter waiter(std::chrono::microseconds(0), g_main_timeout);
+
     // Start event loop
     while (p_master->isActive())
     {
         p_master->iterate();
+
+        // Wait for next event
+        if (p_master->isActive())
+        {
+            p_master->registerEvents(waiter);
+            waiter.wait();
+        }
     }
 
     // Destroy Master and Controller
     p_master.reset();
     p_controller.reset();
+
+    // Shut down persistent simulator
+    PersistentWorkerHandler::terminateStatic();
+
+    // Wait for terminated processes to exit
+    wait_terminating_processes();
+
+    // Write trace
+    if (Tracer::isEnabled())
+        Tracer::write(g_trace_file, {Tracer::events()});
 }
 
 // Static cleanup function
 void SerialMaster::cleanup()
 {
+    // Shut down persistent simulator
+    PersistentWorkerHandler::terminateStatic();
+
+    // Wait for terminated processes to exit
+    wait_terminating_processes();
 }
@@ -0,0 +1,275 @@
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "spdlog/spdlog.h"
+
+#include "SimulationCache.h"
+
+// Magic string at the start of every cache file
+static const char magic[] = "PAKCACH1";
+static const off_t magic_size = sizeof(magic) - 1;
+
+// FNV-1a parameters
+static const std::uint64_t fnv_offset_basis = 14695981039346656037ULL;
+static const std::uint64_t fnv_prime = 1099511628211ULL;
+
+// Continue FNV-1a hash with given bytes
+static std::uint64_t fnv1a(std::uint64_t state, const char *data,
+        std::size_t size)
+{
+    for (std::size_t i = 0; i < size; i++)
+    {
+        state ^= static_cast<unsigned char>(data[i]);
+        state *= fnv_prime;
+    }
+
+    return state;
+}
+
+// Throw runtime_error about failed system call on cache file
+static void throw_error(const std::string& system_call,
+        const std::string& filename, int error_number)
+{
+    std::string error_msg;
+    error_msg += system_call;
+    error_msg += " of cache file ";
+    error_msg += filename;
+    error_msg += " failed: ";
+    error_msg += strerror(error_number);
+    throw std::runtime_error(error_msg);
+}
+
+// Open cache file
+SimulationCache::SimulationCache(const std::string& filename,
+        const Command& simulator) :
+    m_filename(filename),
+    m_prefix(simulator.str() + '\0')
+{
+    m_prefix_hash = fnv1a(fnv_offset_basis, m_prefix.data(),
+            m_prefix.size());
+
+    m_fd = open(m_filename.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (m_fd == -1)
+        throw_error("open", m_filename, errno);
+
+    // Lock cache file, so that no other instance of Pakman appends to it
+    if (flock(m_fd, LOCK_EX | LOCK_NB) == -1)
+    {
+        int error_number = errno;
+        close(m_fd);
+
+        if (error_number == EWOULDBLOCK)
+        {
+            std::string error_msg;
+            error_msg += "Cache file ";
+            error_msg += m_filename;
+            error_msg += " is in use by another process";
+            throw std::runtime_error(error_msg);
+        }
+
+        throw_error("flock", m_filename, error_number);
+    }
+
+    struct stat file_stat;
+    if (fstat(m_fd, &file_stat) == -1)
+    {
+        int error_number = errno;
+        close(m_fd);
+        throw_error("fstat", m_filename, error_number);
+    }
+    m_file_size = file_stat.st_size;
+
+    try
+    {
+        // Write magic string to new cache file
+        if (m_file_size == 0)
+        {
+            if (write(m_fd, magic, magic_size) != magic_size)
+                throw_error("write", m_filename, errno);
+            m_file_size = magic_size;
+        }
+
+        // Map cache file and check magic string
+        map(m_file_size);
+        if (m_file_size < magic_size
+                || std::memcmp(m_map, magic, magic_size) != 0)
+        {
+            std::string error_msg;
+            error_msg += "File ";
+            error_msg += m_filename;
+            error_msg += " is not a Pakman cache file";
+            throw std::runtime_error(error_msg);
+        }
+
+        // Build index and discard partially written record at the end
+        off_t end = scan();
+        if (end < m_file_size)
+        {
+            spdlog::warn("Discarding incomplete record at the end of "
+                    "cache file {}", m_filename);
+
+            if (ftruncate(m_fd, end) == -1)
+                throw_error("ftruncate", m_filename, errno);
+            m_file_size = end;
+        }
+    }
+    catch (...)
+    {
+        if (m_map)
+            munmap(m_map, m_map_size);
+        close(m_fd);
+        throw;
+    }
+
+    spdlog::info("Opened cache file {} with {} simulations", m_filename,
+            m_index.size());
+}
+
+// Unmap and close cache file, which releases the lock
+SimulationCache::~SimulationCache()
+{
+    if (m_map)
+        munmap(m_map, m_map_size);
+    close(m_fd);
+}
+
+// Look up result of simulation
+bool SimulationCache::lookup(const std::string& input_string,
+        std::string& output_string, int& error_code)
+{
+    const std::size_t key_size = m_prefix.size() + input_string.size();
+
+    auto range = m_index.equal_range(hash(input_string));
+    for (auto it = range.first; it != range.second; it++)
+    {
+        const char *p_record = record(it->second);
+        RecordHeader header;
+        std::memcpy(&header, p_record, sizeof(header));
+
+        // Compare keys
+        const char *p_key = p_record + sizeof(header);
+        if (header.key_size != key_size
+                || std::memcmp(p_key, m_prefix.data(), m_prefix.size()) != 0
+                || std::memcmp(p_key + m_prefix.size(), input_string.data(),
+                    input_string.size()) != 0)
+            continue;
+
+        output_string.assign(p_key + key_size, header.output_size);
+        error_code = header.error_code;
+        return true;
+    }
+
+    return false;
+}
+
+// Append result of simulation to cache
+void SimulationCache::insert(const std::string& input_string,
+        const std::string& output_string, int error_code)
+{
+    RecordHeader header;
+    header.hash = hash(input_string);
+    header.key_size = m_prefix.size() + input_string.size();
+    header.output_size = output_string.size();
+    header.error_code = error_code;
+    header.reserved = 0;
+
+    // Assemble record, so that it is appended with a single write
+    std::string buffer;
+    buffer.reserve(sizeof(header) + header.key_size + header.output_size);
+    buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    buffer += m_prefix;
+    buffer += input_string;
+    buffer += output_string;
+
+    std::size_t written = 0;
+    while (written < buffer.size())
+    {
+        ssize_t count = write(m_fd, buffer.data() + written,
+                buffer.size() - written);
+
+        if (count == -1 && errno != EINTR)
+            throw_error("write", m_filename, errno);
+        else if (count > 0)
+            written += count;
+    }
+
+    m_index.emplace(header.hash, m_file_size);
+    m_file_size += buffer.size();
+}
+
+// Returns number of cached simulations
+std::size_t SimulationCache::size() const
+{
+    return m_index.size();
+}
+
+// Returns hash of key
+std::uint64_t SimulationCache::hash(const std::string& input_string) const
+{
+    return fnv1a(m_prefix_hash, input_string.data(), input_string.size());
+}
+
+// Returns pointer to record at offset.  Records appended after the cache
+// file was mapped may lie beyond the mapping, in which case the cache file is
+// mapped again
+const char *SimulationCache::record(off_t offset)
+{
+    if (m_map_size < m_file_size)
+        map(m_file_size);
+
+    return m_map + offset;
+}
+
+// Map at least size bytes of cache file into memory.  The mapping at least
+// doubles every time, so that appending records causes few remappings.  The
+// part of the mapping beyond the end of the cache file is never accessed
+void SimulationCache::map(off_t size)
+{
+    size = std::max(size, 2 * m_map_size);
+
+    void *p_map = mmap(nullptr, size, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (p_map == MAP_FAILED)
+        throw_error("mmap", m_filename, errno);
+
+    if (m_map)
+        munmap(m_map, m_map_size);
+
+    m_map = static_cast<char*>(p_map);
+    m_map_size = size;
+}
+
+// Scan records in mapping and build index
+off_t SimulationCache::scan()
+{
+    off_t offset = magic_size;
+    while (offset + static_cast<off_t>(sizeof(RecordHeader)) <= m_file_size)
+    {
+        RecordHeader header;
+        std::memcpy(&header, m_map + offset, sizeof(header));
+
+        off_t end = offset + sizeof(header) + header.key_size
+            + header.output_size;
+        if (end > m_file_size)
+            break;
+
+        // Check hash, so that a corrupted record is not trusted
+        const char *p_key = m_map + offset + sizeof(header);
+        if (fnv1a(fnv_offset_basis, p_key, header.key_size) != header.hash)
+            break;
+
+        m_index.emplace(header.hash, offset);
+        offset = end;
+    }
+
+    return offset;
+}
@@ -0,0 +1,133 @@
+#ifndef SIMULATIONCACHE_H
+#define SIMULATIONCACHE_H
+
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+#include <sys/types.h>
+
+#include "core/Command.h"
+
+/** A class for caching the results of simulations on disk.
+ *
+ * Many simulators are deterministic, so that running a simulator twice on
+ * the same input string yields the same output string.  Since parameter
+ * sweeps are often repeated and different sweeps often overlap, the
+ * SimulationCache remembers the output string and error code of every
+ * simulation, so that identical simulations need not be run again, not even
+ * in later runs of Pakman.
+ *
+ * The cache file is an append-only log of records, where every record holds
+ * the 64-bit FNV-1a hash of the simulator command and input string, the
+ * command and input string themselves, the error code and the output string.
+ * When the cache file is opened, it is mapped into memory and scanned once to
+ * build an index from hashes to record offsets, so that a lookup costs one
+ * hash table probe and one comparison of the input string.  New records are
+ * appended with a single write() and the mapping is extended lazily when a
+ * lookup hits a record beyond it.  A record that was only partially written
+ * because Pakman was killed is truncated when the cache file is opened.
+ *
+ * The cache file is locked while it is open, so that it can only be used by
+ * one instance of Pakman at a time.  Records are stored in host byte order,
+ * so the cache file should not be moved between machines of different
+ * endianness.
+ */
+
+class SimulationCache
+{
+    public:
+
+        /** Open cache file, creating it if it does not exist.
+         *
+         * @param filename  path to cache file.
+         * @param simulator  simulator command, which is part of every key.
+         */
+        SimulationCache(const std::string& filename,
+                const Command& simulator);
+
+        /** Destructor unmaps and closes cache file. */
+        ~SimulationCache();
+
+        /** SimulationCache is not copyable. */
+        SimulationCache(const SimulationCache&) = delete;
+
+        /** SimulationCache is not copy-assignable. */
+        SimulationCache& operator=(const SimulationCache&) = delete;
+
+        /** Look up result of simulation.
+         *
+         * @param input_string  input string to simulator.
+         * @param output_string  set to cached output string if found.
+         * @param error_code  set to cached error code if found.
+         *
+         * @return whether the simulation was found in the cache.
+         */
+        bool lookup(const std::string& input_string,
+                std::string& output_string, int& error_code);
+
+        /** Append result of simulation to cache.
+         *
+         * @param input_string  input string to simulator.
+         * @param output_string  output string of simulator.
+         * @param error_code  error code of simulator.
+         */
+        void insert(const std::string& input_string,
+                const std::string& output_string, int error_code);
+
+        /** @return number of cached simulations. */
+        std::size_t size() const;
+
+    private:
+
+        // Header of every record, followed by key and output string
+        struct RecordHeader
+        {
+            std::uint64_t hash;
+            std::uint32_t key_size;
+            std::uint32_t output_size;
+            std::int32_t error_code;
+            std::uint32_t reserved;
+        };
+
+        // Returns hash of key, which is the simulator command followed by a
+        // null character and the input string
+        std::uint64_t hash(const std::string& input_string) const;
+
+        // Returns pointer to record at offset, extending the mapping if
+        // necessary
+        const char *record(off_t offset);
+
+        // Map at least the given number of bytes of cache file into memory
+        void map(off_t size);
+
+        // Scan records in mapping and build index, returning the offset of
+        // the end of the last complete record
+        off_t scan();
+
+        // Path to cache file
+        std::string m_filename;
+
+        // Key prefix, which is the simulator command followed by a null
+        // character
+        std::string m_prefix;
+
+        // Hash state after hashing key prefix
+        std::uint64_t m_prefix_hash;
+
+        // File descriptor of cache file
+        int m_fd = -1;
+
+        // Mapping of cache file and its size
+        char *m_map = nullptr;
+        off_t m_map_size = 0;
+
+        // Size of cache file
+        off_t m_file_size = 0;
+
+        // Map from hash to record offset.  Keys with colliding hashes are
+        // told apart by comparing the keys in the records
+        std::unordered_multimap<std::uint64_t, off_t> m_index;
+};
+
+#endif // SIMULATIONCACHE_H
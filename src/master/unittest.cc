@@ -0,0 +1,339 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <stdexcept>
+#include <cstdint>
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "spdlog/spdlog.h"
+
+#include "core/Command.h"
+
+#include "SimulationCache.h"
+
+std::chrono::milliseconds g_main_timeout(1);
+std::chrono::milliseconds g_kill_timeout(100);
+const char *g_program_name = "master_test";
+bool g_ignore_errors = false;
+bool g_force_host_spawn = false;
+int g_worker_procs = 1;
+bool g_discard_child_stderr = false;
+bool g_program_terminated = false;
+std::string g_output_file;
+bool g_async_output = false;
+bool g_binary_output = false;
+std::string g_cache_file;
+std::string g_trace_file;
+
+// Size of magic string and of record header in cache file
+const off_t magic_size = 8;
+const off_t header_size = 24;
+
+// Returns name of new empty temporary file
+std::string make_temp_file()
+{
+    char filename[] = "/tmp/pakman-cache-test-XXXXXX";
+    int fd = mkstemp(filename);
+    assert(fd != -1);
+    close(fd);
+    return filename;
+}
+
+// Returns size of file
+off_t file_size(const std::string& filename)
+{
+    struct stat file_stat;
+    int rc = stat(filename.c_str(), &file_stat);
+    assert(rc == 0);
+    return file_stat.st_size;
+}
+
+// Returns size of record in cache file
+off_t record_size(const Command& simulator, const std::string& input_string,
+        const std::string& output_string)
+{
+    return header_size + simulator.str().size() + 1 + input_string.size()
+        + output_string.size();
+}
+
+// Append bytes to file
+void append_bytes(const std::string& filename, const std::string& bytes)
+{
+    int fd = open(filename.c_str(), O_WRONLY | O_APPEND);
+    assert(fd != -1);
+    ssize_t count = write(fd, bytes.data(), bytes.size());
+    assert(count == static_cast<ssize_t>(bytes.size()));
+    close(fd);
+}
+
+// Returns whether input string is found in cache with given output string
+// and error code
+bool cached(SimulationCache& cache, const std::string& input_string,
+        const std::string& expected_output, int expected_error_code)
+{
+    std::string output_string;
+    int error_code;
+    return cache.lookup(input_string, output_string, error_code)
+        && output_string == expected_output
+        && error_code == expected_error_code;
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::off);
+
+    const Command simulator("my-simulator --flag");
+
+    ///// Test of SimulationCache /////
+
+    // Cached results are found in the same and in later runs
+    {
+        std::string filename = make_temp_file();
+        {
+            SimulationCache cache(filename, simulator);
+            assert(cache.size() == 0);
+            assert(file_size(filename) == magic_size);
+
+            cache.insert("1 2\n", "accept\n", 0);
+            cache.insert("3 4\n", "reject\n", 0);
+            cache.insert("5 6\n", "", 1);
+            assert(cache.size() == 3);
+
+            assert(cached(cache, "1 2\n", "accept\n", 0));
+            assert(cached(cache, "3 4\n", "reject\n", 0));
+            assert(cached(cache, "5 6\n", "", 1));
+        }
+
+        SimulationCache cache(filename, simulator);
+        assert(cache.size() == 3);
+        assert(cached(cache, "1 2\n", "accept\n", 0));
+        assert(cached(cache, "3 4\n", "reject\n", 0));
+        assert(cached(cache, "5 6\n", "", 1));
+
+        unlink(filename.c_str());
+    }
+
+    // Keys that differ from the cached key are rejected, even when one is a
+    // prefix of the other or the simulator command differs
+    {
+        std::string filename = make_temp_file();
+        {
+            SimulationCache cache(filename, simulator);
+            cache.insert("1 2\n", "accept\n", 0);
+            cache.insert(std::string("a\0b", 3), "null\n", 0);
+
+            std::string output_string = "unchanged";
+            int error_code = 7;
+            assert(!cache.lookup("1 2", output_string, error_code));
+            assert(!cache.lookup("1 2\n\n", output_string, error_code));
+            assert(!cache.lookup("", output_string, error_code));
+            assert(!cache.lookup("a", output_string, error_code));
+            assert(!cache.lookup(std::string("a\0c", 3), output_string,
+                        error_code));
+            assert(output_string == "unchanged");
+            assert(error_code == 7);
+
+            assert(cached(cache, std::string("a\0b", 3), "null\n", 0));
+        }
+
+        // The simulator command is part of the key
+        {
+            SimulationCache cache(filename, Command("my-simulator"));
+            assert(cache.size() == 2);
+
+            std::string output_string;
+            int error_code;
+            assert(!cache.lookup("1 2\n", output_string, error_code));
+            assert(!cache.lookup("--flag 1 2\n", output_string, error_code));
+
+            cache.insert("1 2\n", "reject\n", 0);
+            assert(cached(cache, "1 2\n", "reject\n", 0));
+        }
+
+        // Results of different simulators are kept apart
+        SimulationCache cache(filename, simulator);
+        assert(cache.size() == 3);
+        assert(cached(cache, "1 2\n", "accept\n", 0));
+
+        unlink(filename.c_str());
+    }
+
+    // A record that was only partially written is truncated on reopening,
+    // whether the record header, the key or the output string is incomplete
+    for (off_t torn_size : {off_t(1), header_size - 1, header_size + 3,
+            record_size(simulator, "5 6\n", "torn\n") - 1})
+    {
+        std::string filename = make_temp_file();
+        {
+            SimulationCache cache(filename, simulator);
+            cache.insert("1 2\n", "accept\n", 0);
+            cache.insert("3 4\n", "reject\n", 0);
+        }
+        const off_t complete_size = file_size(filename);
+
+        // Write incomplete record by inserting it into another cache file and
+        // copying the first bytes of the record
+        std::string other_filename = make_temp_file();
+        {
+            SimulationCache other_cache(other_filename, simulator);
+            other_cache.insert("5 6\n", "torn\n", 0);
+        }
+        {
+            char buffer[256];
+            int fd = open(other_filename.c_str(), O_RDONLY);
+            assert(fd != -1);
+            ssize_t count = pread(fd, buffer, torn_size, magic_size);
+            assert(count == torn_size);
+            close(fd);
+            append_bytes(filename, std::string(buffer, torn_size));
+        }
+        unlink(other_filename.c_str());
+        assert(file_size(filename) == complete_size + torn_size);
+
+        {
+            SimulationCache cache(filename, simulator);
+            assert(file_size(filename) == complete_size);
+            assert(cache.size() == 2);
+            assert(cached(cache, "1 2\n", "accept\n", 0));
+            assert(cached(cache, "3 4\n", "reject\n", 0));
+
+            std::string output_string;
+            int error_code;
+            assert(!cache.lookup("5 6\n", output_string, error_code));
+
+            // Records appended after truncation are read back in later runs
+            cache.insert("5 6\n", "accept\n", 0);
+        }
+
+        SimulationCache cache(filename, simulator);
+        assert(cache.size() == 3);
+        assert(cached(cache, "5 6\n", "accept\n", 0));
+
+        unlink(filename.c_str());
+    }
+
+    // A record whose hash does not match its key is truncated on reopening
+    {
+        std::string filename = make_temp_file();
+        {
+            SimulationCache cache(filename, simulator);
+            cache.insert("1 2\n", "accept\n", 0);
+            cache.insert("3 4\n", "reject\n", 0);
+        }
+        const off_t complete_size = file_size(filename);
+
+        // Corrupt the first byte of the key of the last record
+        {
+            off_t offset = complete_size
+                - record_size(simulator, "3 4\n", "reject\n") + header_size;
+            int fd = open(filename.c_str(), O_WRONLY);
+            assert(fd != -1);
+            ssize_t count = pwrite(fd, "M", 1, offset);
+            assert(count == 1);
+            close(fd);
+        }
+
+        SimulationCache cache(filename, simulator);
+        assert(cache.size() == 1);
+        assert(file_size(filename) == complete_size
+                - record_size(simulator, "3 4\n", "reject\n"));
+        assert(cached(cache, "1 2\n", "accept\n", 0));
+
+        unlink(filename.c_str());
+    }
+
+    // Records appended beyond the mapping are found, both right after they
+    // are appended and after many more records have been appended, so that
+    // the cache file is mapped again several times
+    {
+        std::string filename = make_temp_file();
+        const int num_records = 2000;
+        const std::string padding(500, 'x');
+        {
+            SimulationCache cache(filename, simulator);
+            for (int i = 0; i < num_records; i++)
+            {
+                std::string input_string = std::to_string(i) + '\n';
+                std::string output_string = padding + std::to_string(i);
+                cache.insert(input_string, output_string, i % 3);
+
+                assert(cached(cache, input_string, output_string, i % 3));
+                assert(cached(cache, "0\n", padding + "0", 0));
+            }
+
+            for (int i = 0; i < num_records; i++)
+                assert(cached(cache, std::to_string(i) + '\n',
+                            padding + std::to_string(i), i % 3));
+        }
+
+        // The cache file grows beyond the initial mapping in a later run
+        {
+            SimulationCache cache(filename, simulator);
+            assert(cache.size() == num_records);
+            for (int i = num_records; i < 2 * num_records; i++)
+            {
+                std::string input_string = std::to_string(i) + '\n';
+                cache.insert(input_string, padding + std::to_string(i), 0);
+                assert(cached(cache, input_string,
+                            padding + std::to_string(i), 0));
+            }
+        }
+
+        SimulationCache cache(filename, simulator);
+        assert(cache.size() == 2 * num_records);
+        for (int i = 0; i < 2 * num_records; i++)
+            assert(cached(cache, std::to_string(i) + '\n',
+                        padding + std::to_string(i),
+                        i < num_records ? i % 3 : 0));
+
+        unlink(filename.c_str());
+    }
+
+    // A cache file cannot be opened twice at the same time
+    {
+        std::string filename = make_temp_file();
+        SimulationCache cache(filename, simulator);
+
+        try
+        {
+            SimulationCache other_cache(filename, simulator);
+            assert(false);
+        }
+        catch (const std::runtime_error& e)
+        {
+            assert(std::string(e.what()) == "Cache file " + filename
+                    + " is in use by another process");
+        }
+
+        unlink(filename.c_str());
+    }
+
+    // A file that is not a cache file is rejected and left untouched
+    {
+        std::string filename = make_temp_file();
+        append_bytes(filename, "p,q\n1,2\n");
+
+        try
+        {
+            SimulationCache cache(filename, simulator);
+            assert(false);
+        }
+        catch (const std::runtime_error& e)
+        {
+            assert(std::string(e.what()) == "File " + filename
+                    + " is not a Pakman cache file");
+        }
+        assert(file_size(filename) == 8);
+
+        unlink(filename.c_str());
+    }
+
+    std::cout << "All tests passed!\n";
+
+    return 0;
+}
@@ -9,7 +9,6 @@ const int MASTER_MSG_TAG = 0;
 const int MASTER_SIGNAL_TAG = 1;
 const int MANAGER_MSG_TAG = 2;
 const int MANAGER_SIGNAL_TAG = 3;
-const int MANAGER_ERROR_CODE_TAG = 4;
 const int WORKER_MSG_TAG = 5;
 const int WORKER_ERROR_CODE_TAG = 6;
 
@@ -26,5 +25,7 @@ const int WORKER_FLUSHED_SIGNAL = 0;
 ///// Manager to Worker signals /////
 // Terminate worker
 const int TERMINATE_WORKER_SIGNAL = 0;
+// Cancel ongoing simulation
+const int CANCEL_WORKER_SIGNAL = 1;
 
 #endif // MPI_COMMON_H
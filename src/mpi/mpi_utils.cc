@@ -1,4 +1,8 @@
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
 
 #include <string.h>
 
@@ -56,3 +60,161 @@ int receive_integer(MPI_Comm comm, int source, int tag)
     // Return integer
     return integer;
 }
+
+std::vector<char> receive_packed(MPI_Comm comm, int source, int tag)
+{
+    // Probe to get status
+    MPI_Status status;
+    MPI_Probe(source, tag, comm, &status);
+
+    // Receive packed buffer
+    int count = 0;
+    MPI_Get_count(&status, MPI_PACKED, &count);
+    std::vector<char> buffer(count);
+    MPI_Recv(buffer.data(), count, MPI_PACKED, source, tag, comm,
+            MPI_STATUS_IGNORE);
+
+    return buffer;
+}
+
+// Gather byte buffers of all processes on root process.  Returns buffers
+// indexed by rank on root process and no buffers on other processes.  Since
+// MPI counts and displacements are int, the buffers are gathered in rounds
+// of chunks that are small enough for the chunks of all processes together
+// to fit in an int, so that buffers of any size can be gathered
+std::vector<std::vector<char>> gather_bytes(MPI_Comm comm, int root,
+        const std::vector<char>& bytes)
+{
+    int rank = 0, size = 0;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    // Gather sizes of buffers, and find largest size on all processes
+    std::uint64_t count = bytes.size();
+    std::vector<std::uint64_t> counts(rank == root ? size : 0);
+    MPI_Gather(&count, 1, MPI_UINT64_T, counts.data(), 1, MPI_UINT64_T, root,
+            comm);
+
+    std::uint64_t max_count = 0;
+    MPI_Allreduce(&count, &max_count, 1, MPI_UINT64_T, MPI_MAX, comm);
+
+    // Allocate buffers on root process
+    std::vector<std::vector<char>> buffers(counts.size());
+    for (std::size_t i = 0; i < counts.size(); i++)
+        buffers[i].reserve(counts[i]);
+
+    // Gather buffers in rounds of chunks
+    const std::uint64_t chunk_size = std::numeric_limits<int>::max() / size;
+    std::vector<int> chunk_counts(counts.size());
+    std::vector<int> displacements(counts.size());
+    std::vector<char> gathered;
+    for (std::uint64_t offset = 0; offset < max_count; offset += chunk_size)
+    {
+        // Compute chunk sizes and displacements of this round
+        int total = 0;
+        for (std::size_t i = 0; i < counts.size(); i++)
+        {
+            chunk_counts[i] = offset < counts[i] ?
+                std::min(chunk_size, counts[i] - offset) : 0;
+            displacements[i] = total;
+            total += chunk_counts[i];
+        }
+
+        int chunk_count = offset < count ?
+            std::min(chunk_size, count - offset) : 0;
+        gathered.resize(total);
+        MPI_Gatherv(bytes.data() + (offset < count ? offset : 0),
+                chunk_count, MPI_BYTE, gathered.data(), chunk_counts.data(),
+                displacements.data(), MPI_BYTE, root, comm);
+
+        // Append chunks to buffers
+        for (std::size_t i = 0; i < counts.size(); i++)
+            buffers[i].insert(buffers[i].end(),
+                    gathered.begin() + displacements[i],
+                    gathered.begin() + displacements[i] + chunk_counts[i]);
+    }
+
+    return buffers;
+}
+
+// Append data to buffer using MPI_Pack
+static void pack(MPI_Comm comm, const void *data, int count,
+        MPI_Datatype datatype, std::vector<char>& buffer)
+{
+    // Make room for packed data
+    int size = 0;
+    MPI_Pack_size(count, datatype, comm, &size);
+    int position = buffer.size();
+    buffer.resize(position + size);
+
+    // Pack data and shrink buffer to actual size
+    MPI_Pack(data, count, datatype, buffer.data(), buffer.size(), &position,
+            comm);
+    buffer.resize(position);
+}
+
+// Extract data from buffer using MPI_Unpack
+static void unpack(MPI_Comm comm, const std::vector<char>& buffer,
+        int& position, void *data, int count, MPI_Datatype datatype)
+{
+    MPI_Unpack(buffer.data(), buffer.size(), &position, data, count,
+            datatype, comm);
+}
+
+void pack_integer(MPI_Comm comm, int integer, std::vector<char>& buffer)
+{
+    pack(comm, &integer, 1, MPI_INT, buffer);
+}
+
+void pack_double(MPI_Comm comm, double number, std::vector<char>& buffer)
+{
+    pack(comm, &number, 1, MPI_DOUBLE, buffer);
+}
+
+void pack_task_id(MPI_Comm comm, task_id_t task_id,
+        std::vector<char>& buffer)
+{
+    pack(comm, &task_id, 1, MPI_UNSIGNED_LONG, buffer);
+}
+
+void pack_string(MPI_Comm comm, const std::string& str,
+        std::vector<char>& buffer)
+{
+    // Pack length followed by characters
+    pack_integer(comm, str.size(), buffer);
+    pack(comm, str.data(), str.size(), MPI_CHAR, buffer);
+}
+
+int unpack_integer(MPI_Comm comm, const std::vector<char>& buffer,
+        int& position)
+{
+    int integer = 0;
+    unpack(comm, buffer, position, &integer, 1, MPI_INT);
+    return integer;
+}
+
+double unpack_double(MPI_Comm comm, const std::vector<char>& buffer,
+        int& position)
+{
+    double number = 0.0;
+    unpack(comm, buffer, position, &number, 1, MPI_DOUBLE);
+    return number;
+}
+
+task_id_t unpack_task_id(MPI_Comm comm, const std::vector<char>& buffer,
+        int& position)
+{
+    task_id_t task_id = 0;
+    unpack(comm, buffer, position, &task_id, 1, MPI_UNSIGNED_LONG);
+    return task_id;
+}
+
+std::string unpack_string(MPI_Comm comm, const std::vector<char>& buffer,
+        int& position)
+{
+    // Unpack length followed by characters
+    int length = unpack_integer(comm, buffer, position);
+    std::string str(length, '\0');
+    unpack(comm, buffer, position, &str[0], length, MPI_CHAR);
+    return str;
+}
@@ -2,8 +2,12 @@
 #define MPI_UTILS_H
 
 #include <string>
+#include <vector>
+
 #include <mpi.h>
 
+#include "core/TaskHandler.h"
+
 int get_mpi_comm_world_size();
 int get_mpi_comm_world_rank();
 
@@ -12,5 +16,25 @@ bool iprobe_wrapper(int source, int tag, MPI_Comm comm,
 
 std::string receive_string(MPI_Comm comm, int source, int tag);
 int receive_integer(MPI_Comm comm, int source, int tag);
+std::vector<char> receive_packed(MPI_Comm comm, int source, int tag);
+
+std::vector<std::vector<char>> gather_bytes(MPI_Comm comm, int root,
+        const std::vector<char>& bytes);
+
+void pack_integer(MPI_Comm comm, int integer, std::vector<char>& buffer);
+void pack_double(MPI_Comm comm, double number, std::vector<char>& buffer);
+void pack_task_id(MPI_Comm comm, task_id_t task_id,
+        std::vector<char>& buffer);
+void pack_string(MPI_Comm comm, const std::string& str,
+        std::vector<char>& buffer);
+
+int unpack_integer(MPI_Comm comm, const std::vector<char>& buffer,
+        int& position);
+double unpack_double(MPI_Comm comm, const std::vector<char>& buffer,
+        int& position);
+task_id_t unpack_task_id(MPI_Comm comm, const std::vector<char>& buffer,
+        int& position);
+std::string unpack_string(MPI_Comm comm, const std::vector<char>& buffer,
+        int& position);
 
 #endif // MPI_UTILS_H
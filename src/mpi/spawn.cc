@@ -15,18 +15,17 @@
 // Global MPI_Info
 extern MPI_Info g_info;
 
-MPI_Comm spawn(const Command& cmd, MPI_Info info)
+MPI_Comm spawn(const Command& cmd, MPI_Info info, int maxprocs)
 {
     // Get argv from command
     char **argv = cmd.argv();
 
-    // Spawn single process and return intercomm
+    // Spawn maxprocs processes and return intercomm
     // The argument list to Spawn is shifted by one
     // compared to the exec argument list
-    const int maxprocs = 1;
     const int root = 0;
 
-    spdlog::debug("Spawning {}...", argv[0]);
+    spdlog::debug("Spawning {} with {} processes...", argv[0], maxprocs);
 
     MPI_Comm spawn_intercomm;
     MPI_Comm_spawn(argv[0], argv + 1, maxprocs, info, root,
@@ -52,8 +51,8 @@ MPI_Comm spawn_worker(const Command& cmd)
         MPI_Info_set(info, "host", buf.nodename);
     }
 
-    // Spawn Worker
-    MPI_Comm child_comm = spawn(cmd, info);
+    // Spawn Worker with g_worker_procs processes
+    MPI_Comm child_comm = spawn(cmd, info, g_worker_procs);
 
     // Free MPI_Info object
     MPI_Info_free(&info);
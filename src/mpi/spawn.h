@@ -5,7 +5,8 @@
 
 class Command;
 
-MPI_Comm spawn(const Command& cmd, MPI_Info info = MPI_INFO_NULL);
+MPI_Comm spawn(const Command& cmd, MPI_Info info = MPI_INFO_NULL,
+        int maxprocs = 1);
 MPI_Comm spawn_worker(const Command& cmd);
 
 #endif // SPAWN_H
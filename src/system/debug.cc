@@ -3,11 +3,11 @@
 #include <string.h>
 #include <signal.h>
 #include <execinfo.h>
+#include <unistd.h>
 
 #include "debug.h"
 
 const int NUM_LEVELS = 20;
-const int STDERR_FILENO = 2;
 
 void print_stacktrace()
 {
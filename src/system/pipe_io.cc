@@ -3,13 +3,14 @@
 #include <unistd.h>
 #include <poll.h>
 #include <errno.h>
+#include <signal.h>
 
 #include "pipe_io.h"
 
 const int READ_END = 0;
 const int WRITE_END = 1;
 
-const int BUFFER_SIZE = 256;
+const int BUFFER_SIZE = 4096;
 
 void read_from_pipe(const int pipefd[], std::string& output)
 {
@@ -50,44 +51,56 @@ void check_poll(struct pollfd *fds, nfds_t nfds, int timeout)
 }
 
 /*
- * If read from pipe is finished, return true, else false
+ * If read from pipe is finished, return true, else false.  Only the data that
+ * is available without blocking is read, so that this function can be called
+ * on a pipe whose write end stays open between messages.  Reading stops once
+ * at least max_count bytes have been read, so that a fast writer cannot make
+ * the output grow without bound.
  */
-bool poll_read_from_pipe(const int pipe_read_fd, std::string& output)
+bool poll_read_from_pipe(const int pipe_read_fd, std::string& output,
+        std::size_t max_count)
 {
     // Polling struct
     struct pollfd fds;
     fds.fd = pipe_read_fd;
     fds.events = POLLIN;
 
-    // Initialize buffers and output
+    // Initialize buffers
     ssize_t count;
     char buffer[BUFFER_SIZE];
+    std::size_t total = 0;
 
-    // Poll
-    check_poll(&fds, 1, 0);
-
-    // Check if data is available or pipe was closed
-    if ((fds.revents & POLLIN) || (fds.revents & POLLHUP))
+    while (total < max_count)
     {
+        // Poll
+        fds.revents = 0;
+        check_poll(&fds, 1, 0);
 
-        // Even if pipe was closed, there may still be data to read
-        while ((count = read(pipe_read_fd, buffer, BUFFER_SIZE)) > 0)
-        {
+        // If no data is available and pipe was not closed, return false
+        if (!(fds.revents & POLLIN) && !(fds.revents & POLLHUP))
+            return false;
 
-            if (count == -1)
-            {
-                perror("read failed");
-                throw;
-            }
+        // Read once, which does not block since poll reported the pipe ready.
+        // Even if pipe was closed, there may still be data to read.
+        count = read(pipe_read_fd, buffer, BUFFER_SIZE);
+
+        if (count == -1)
+        {
+            // Allow interrupts
+            if (errno == EINTR) continue;
 
-            output.append(buffer, count);
+            std::runtime_error e("read from pipe failed");
+            throw e;
         }
 
-        // If pipe was closed, return true
-        if (fds.revents & POLLHUP) return true;
+        // If end of file was reached, pipe was closed so return true
+        if (count == 0) return true;
+
+        output.append(buffer, count);
+        total += count;
     }
 
-    // Pipe was not closed so return false
+    // Stopped after reading max_count bytes
     return false;
 }
 
@@ -110,3 +123,48 @@ void write_to_pipe(const int pipe_write_fd, const std::string& input)
         throw e;
     }
 }
+
+bool try_write_to_pipe(const int pipe_write_fd, const std::string& input)
+{
+    // Ignore SIGPIPE while writing, so that a reader that has exited results
+    // in EPIPE instead of terminating the program
+    struct sigaction ignore_action, old_action;
+    ignore_action.sa_handler = SIG_IGN;
+    sigemptyset(&ignore_action.sa_mask);
+    ignore_action.sa_flags = 0;
+    sigaction(SIGPIPE, &ignore_action, &old_action);
+
+    // Write until input has been written completely
+    const char *data = input.data();
+    std::size_t remaining = input.size();
+    bool success = true;
+    while (remaining > 0)
+    {
+        ssize_t count = write(pipe_write_fd, data, remaining);
+
+        if (count == -1)
+        {
+            // Allow interrupts
+            if (errno == EINTR) continue;
+
+            // Read end was closed
+            if (errno == EPIPE)
+            {
+                success = false;
+                break;
+            }
+
+            sigaction(SIGPIPE, &old_action, nullptr);
+            std::runtime_error e("write to pipe failed");
+            throw e;
+        }
+
+        data += count;
+        remaining -= count;
+    }
+
+    // Restore SIGPIPE action
+    sigaction(SIGPIPE, &old_action, nullptr);
+
+    return success;
+}
@@ -7,9 +7,11 @@
 void read_from_pipe(const int pipe_read_fd, std::string& output);
 void read_from_pipe(const int pipefd[], std::string& output);
 void check_poll(struct pollfd *fds, nfds_t nfds, int timeout);
-bool poll_read_from_pipe(const int pipe_read_fd, std::string& output);
+bool poll_read_from_pipe(const int pipe_read_fd, std::string& output,
+        std::size_t max_count = std::string::npos);
 
 void write_to_pipe(const int pipe_write_fd, const std::string& input);
 void write_to_pipe(const int pipefd[], const std::string& input);
+bool try_write_to_pipe(const int pipe_write_fd, const std::string& input);
 
 #endif // PIPE_IO_H
@@ -1,10 +1,14 @@
 #include <string>
 #include <vector>
+#include <list>
+#include <chrono>
+#include <thread>
 #include <stdexcept>
 #include <utility>
 #include <tuple>
 
 #include <unistd.h>
+#include <signal.h>
 #include <sys/wait.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -16,12 +20,24 @@
 
 #include "core/common.h"
 #include "core/utils.h"
+#include "core/Tracer.h"
 #include "pipe_io.h"
 #include "system_call.h"
 
 const int READ_END = 0;
 const int WRITE_END = 1;
 
+// Processes that have been sent SIGTERM but have not yet been waited for
+struct TerminatingProcess
+{
+    pid_t pid;
+    Command cmd;
+    std::chrono::steady_clock::time_point deadline;
+    bool killed;
+};
+
+static std::list<TerminatingProcess> s_terminating_processes;
+
 std::string get_waitpid_errno()
 {
     if (errno == ECHILD)
@@ -150,6 +166,112 @@ void close_check(int fd)
     }
 }
 
+void set_cloexec(int fd)
+{
+    int flags = fcntl(fd, F_GETFD);
+
+    if ( (flags == -1) || (fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1) )
+    {
+        std::runtime_error e("fcntl failed");
+        throw e;
+    }
+}
+
+void terminate_process(pid_t pid, const Command& cmd,
+        child_err_opt_t child_err_opt)
+{
+    // If process has finished, return immediately
+    if ( waitpid_success(pid, WNOHANG, cmd, child_err_opt) )
+        return;
+
+    // Send SIGTERM to process
+    if ( kill(pid, SIGTERM) )
+    {
+        std::runtime_error e("an error occurred while trying to terminate "
+                             "child process");
+        throw e;
+    }
+
+    // Sleep for g_kill_timeout
+    std::this_thread::sleep_for(g_kill_timeout);
+
+    // If process has finished, return
+    if ( waitpid_success(pid, WNOHANG, cmd, ignore_error) )
+        return;
+
+    // Send SIGKILL to process
+    if ( kill(pid, SIGKILL) )
+    {
+        std::runtime_error e("an error occurred while trying to kill "
+                             "child process");
+        throw e;
+    }
+
+    waitpid_success(pid, 0, cmd, ignore_error);
+}
+
+void terminate_process_async(pid_t pid, const Command& cmd,
+        child_err_opt_t child_err_opt)
+{
+    // If process has finished, return immediately
+    if ( waitpid_success(pid, WNOHANG, cmd, child_err_opt) )
+        return;
+
+    // Send SIGTERM to process
+    if ( kill(pid, SIGTERM) )
+    {
+        std::runtime_error e("an error occurred while trying to terminate "
+                             "child process");
+        throw e;
+    }
+
+    // Keep track of process until it has exited, it will be sent SIGKILL by
+    // reap_terminating_processes() if it is still running after
+    // g_kill_timeout
+    s_terminating_processes.push_back({pid, cmd,
+            std::chrono::steady_clock::now() + g_kill_timeout, false});
+}
+
+int reap_terminating_processes()
+{
+    auto now = std::chrono::steady_clock::now();
+
+    auto it = s_terminating_processes.begin();
+    while (it != s_terminating_processes.end())
+    {
+        // If process has finished, stop tracking it
+        if ( waitpid_success(it->pid, WNOHANG, it->cmd, ignore_error) )
+        {
+            it = s_terminating_processes.erase(it);
+            continue;
+        }
+
+        // Send SIGKILL to process if it has outlived g_kill_timeout
+        if ( !it->killed && (now >= it->deadline) )
+        {
+            if ( kill(it->pid, SIGKILL) )
+            {
+                std::runtime_error e("an error occurred while trying to kill "
+                                     "child process");
+                throw e;
+            }
+
+            it->killed = true;
+        }
+
+        it++;
+    }
+
+    return s_terminating_processes.size();
+}
+
+void wait_terminating_processes()
+{
+    // Reap processes until all of them have exited
+    while (reap_terminating_processes() > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
 std::string system_call(const Command& cmd)
 {
     // Check if cmd is executable
@@ -164,6 +286,7 @@ std::string system_call(const Command& cmd)
     }
 
     spdlog::debug("cmd: {}", cmd.str());
+    Tracer::Span span(Tracer::system_call_event);
 
     // Initialize output
     std::string output;
@@ -257,6 +380,7 @@ std::string system_call(const Command& cmd, const std::string& input)
 
     spdlog::debug("cmd: {}", cmd.str());
     spdlog::debug("input: {}", input);
+    Tracer::Span span(Tracer::system_call_event);
 
     // Initialize output
     std::string output;
@@ -469,6 +593,15 @@ std::tuple<pid_t, int, int> system_call_non_blocking_read_write(
         throw e;
     }
 
+    // Close pipes on exec, so that child processes started later do not
+    // inherit them.  Otherwise, a long-lived child would keep the read end of
+    // another child's stdin open.  Redirected stdin and stdout are not
+    // affected, since dup2 clears the close-on-exec flag.
+    set_cloexec(send_pipefd[READ_END]);
+    set_cloexec(send_pipefd[WRITE_END]);
+    set_cloexec(recv_pipefd[READ_END]);
+    set_cloexec(recv_pipefd[WRITE_END]);
+
     // Fork and record child pid
     child_pid = fork();
 
@@ -20,6 +20,15 @@ bool waitpid_success(pid_t pid, int& error_code, int options = 0, const
 
 void dup2_check(int oldfd, int newfd);
 void close_check(int fd);
+void set_cloexec(int fd);
+
+void terminate_process(pid_t pid, const Command& cmd,
+        child_err_opt_t child_err_opt = throw_error);
+
+void terminate_process_async(pid_t pid, const Command& cmd,
+        child_err_opt_t child_err_opt = throw_error);
+int reap_terminating_processes();
+void wait_terminating_processes();
 
 std::string system_call(const Command& cmd);
 std::string system_call(const Command& cmd, const std::string& input);
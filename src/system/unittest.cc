@@ -1,4 +1,5 @@
 #include <iostream>
+#include <chrono>
 
 #include <assert.h>
 
@@ -12,6 +13,7 @@
 #include "system_call.h"
 
 bool g_discard_child_stderr = false;
+std::chrono::milliseconds g_kill_timeout(100);
 
 void signal_handler(int signal)
 {
@@ -106,6 +108,54 @@ int main()
         assert(waitpid_success(child_pid, error_code, options, Command("dummy_cmd")));
     }
 
+    ///// Test of terminate_process_async() /////
+
+    // Fork child that ignores SIGTERM, and that signals through a pipe when
+    // it is ready
+    int ready_pipe[2];
+    if (pipe(ready_pipe) == -1)
+    {
+        std::cout << "pipe() returned error." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    child_pid = fork();
+    if (child_pid == -1)
+    {
+        std::cout << "fork() returned error." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (child_pid == 0) // I am the child
+    {
+        signal(SIGTERM, SIG_IGN);
+        close(ready_pipe[0]);
+        close(ready_pipe[1]);
+        while (true)
+            pause();
+    }
+    else // I am the parent
+    {
+        // Wait until child is ready
+        char c;
+        close(ready_pipe[1]);
+        while (read(ready_pipe[0], &c, 1) == -1 && errno == EINTR);
+        close(ready_pipe[0]);
+
+        // Terminating the child should return immediately
+        auto start = std::chrono::steady_clock::now();
+        terminate_process_async(child_pid, Command("dummy_cmd"));
+        assert(std::chrono::steady_clock::now() - start < g_kill_timeout);
+
+        // Child is still running, so it should be tracked
+        assert(reap_terminating_processes() == 1);
+
+        // Waiting should kill the child after g_kill_timeout
+        wait_terminating_processes();
+        assert(std::chrono::steady_clock::now() - start >= g_kill_timeout);
+        assert(reap_terminating_processes() == 0);
+    }
+
     std::cout << "All tests passed!\n";
 
     return 0;
@@ -0,0 +1,20 @@
+#!/bin/bash
+set -euo pipefail
+
+# Read epsilon
+read epsilon
+
+# Read parameter
+read parameter
+
+# If there is another line, throw error
+if read dummy
+then
+    echo "$0 accepts only two lines of input"
+    exit 1
+fi
+
+# Accept if sum of numeric values is below epsilon
+echo $parameter | awk -v epsilon=$epsilon \
+    '{ sum = 0; for (i = 1; i <= NF; i++) sum += $i;
+       if (sum < epsilon) print "accept"; else print "reject" }'
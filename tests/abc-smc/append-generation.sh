@@ -0,0 +1,19 @@
+#!/bin/bash
+set -euo pipefail
+
+# Read t
+read t
+
+# Read parameter
+read parameter
+
+# If there is another line, throw error
+if read dummy
+then
+    echo "$0 accepts only two lines of input"
+    exit 1
+fi
+
+# Append generation to parameter, so that the output records which parameter
+# of the previous population was sampled
+echo "$parameter$t"
@@ -0,0 +1,20 @@
+#!/bin/bash
+set -euo pipefail
+
+# Process arguments
+if [ $# -ne 1 ]
+then
+    echo "Usage: $0 NUMBER_FILE" 1>&2
+    echo "Reads n and prints the next n numbers after the number in NUMBER_FILE" 1>&2
+    exit 1
+fi
+
+number_file="$1"
+
+# Read number of parameters to sample
+read n
+
+# Print next n numbers and store last one
+current_number=$(cat $number_file)
+seq $((current_number + 1)) $((current_number + n))
+echo $((current_number + n)) > $number_file
@@ -0,0 +1,14 @@
+#!/bin/bash
+set -euo pipefail
+
+# Read t
+read t
+
+# Read perturbed parameter
+read perturbed_prmtr
+
+# Print 1 for every parameter from previous population
+while read parameter
+do
+    echo 1
+done
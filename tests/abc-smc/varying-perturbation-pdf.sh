@@ -0,0 +1,13 @@
+#!/bin/bash
+set -euo pipefail
+
+# Read t
+read t
+
+# Read perturbed parameter
+read new_p
+
+# Output probability density of perturbed parameter and every parameter j in
+# population, which matches that of
+# tests/standard-simulator/batch-perturbation-pdf.sh
+awk -v new_p=$new_p '{ print 1 + (new_p + 2 * $1 + NR - 1) % 7 }'
@@ -0,0 +1,43 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+int main(int argc, char *argv[])
+{
+    /* Print help */
+    if (argc < 2 || argc > 3
+            || strcmp(argv[1], "--help") == 0
+            || strcmp(argv[1], "-h") == 0)
+    {
+        printf("Usage: %s NUM_TASKS [EXIT_DELAY_MS]\n", argv[0]);
+        printf("Accept NUM_TASKS framed inputs, then wait EXIT_DELAY_MS "
+                "milliseconds and exit.\n");
+        return argc == 2 ? 0 : 2;
+    }
+
+    /* Process number of tasks and exit delay */
+    int num_tasks = atoi(argv[1]);
+    int exit_delay_ms = argc == 3 ? atoi(argv[2]) : 0;
+
+    /* Handle framed inputs until num_tasks tasks have been handled or stdin
+     * is closed */
+    size_t input_length;
+    for (int task = 0; task < num_tasks
+            && scanf("%zu", &input_length) == 1; task++)
+    {
+        /* Read and discard newline and input string */
+        getchar();
+        for (size_t i = 0; i < input_length; i++)
+            if (getchar() == EOF)
+                return 2;
+
+        /* Print framed output string to stdout */
+        printf("2 0\n1\n");
+        fflush(stdout);
+    }
+
+    /* Exit with nonzero exit status without reading the next task */
+    usleep(exit_delay_ms * 1000);
+    return 3;
+}
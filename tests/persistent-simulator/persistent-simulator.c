@@ -0,0 +1,66 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char *argv[])
+{
+    /* Default output string and error code correspond to simulator that always
+     * accepts and exits without error */
+    char *output_string = "1\n";
+    int error_code = 0;
+
+    /* Print help */
+    if (argc == 2 &&
+            ( strcmp(argv[1], "--help") == 0
+              || strcmp(argv[1], "-h") == 0 ) )
+    {
+        printf("Usage: %s [OUTPUT_STRING] [ERROR_CODE]\n", argv[0]);
+        return 0;
+    }
+
+    /* Process given output string */
+    if (argc >= 2)
+    {
+        output_string = argv[1];
+
+        /* If output string does not terminate on newline, add one */
+        size_t len = strlen(output_string);
+        if (len == 0 || output_string[len - 1] != '\n')
+        {
+            output_string = (char *) malloc((len + 2) * sizeof(char));
+            strcpy(output_string, argv[1]);
+            output_string[len] = '\n';
+            output_string[len + 1] = '\0';
+        }
+    }
+
+    /* Process given error code */
+    if (argc >= 3)
+        error_code = atoi(argv[2]);
+
+    /* Throw error if more than two arguments are given */
+    if (argc > 3)
+    {
+        fprintf(stderr, "Error: too many arguments given. Try %s --help.",
+                argv[0]);
+        return 2;
+    }
+
+    /* Handle framed inputs until stdin is closed */
+    size_t input_length;
+    while (scanf("%zu", &input_length) == 1)
+    {
+        /* Read and discard newline and input string */
+        getchar();
+        for (size_t i = 0; i < input_length; i++)
+            if (getchar() == EOF)
+                return 2;
+
+        /* Print framed output string to stdout */
+        printf("%zu %d\n%s", strlen(output_string), error_code,
+                output_string);
+        fflush(stdout);
+    }
+
+    return 0;
+}
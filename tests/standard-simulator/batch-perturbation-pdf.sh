@@ -0,0 +1,20 @@
+#!/bin/bash
+set -euo pipefail
+
+# Read generation t, number of perturbed parameters m, the m perturbed
+# parameters and the parameters in population.  Output probability density of
+# perturbed parameter i and parameter j in population, which varies with i and
+# j so that the weights reveal whether the densities are assigned to the right
+# pairs.  The density matches that of tests/abc-smc/varying-perturbation-pdf.sh
+awk 'NR == 2 { m = $1 }
+    NR > 2 && NR <= m + 2 { new_p[NR - 3] = $1 }
+    NR > m + 2 { old_p[n++] = $1 }
+    END {
+        for (i = 0; i < m; i++)
+        {
+            row = ""
+            for (j = 0; j < n; j++)
+                row = row (j > 0 ? " " : "") (1 + (new_p[i] + 2 * old_p[j] + j) % 7)
+            print row
+        }
+    }'
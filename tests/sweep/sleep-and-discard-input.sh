@@ -0,0 +1,6 @@
+#!/bin/bash
+set -euo pipefail
+
+# Discard parameter and take a while to simulate
+cat > /dev/null
+sleep 0.02
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include <libgen.h>
+
+#include "interface/BinaryResultReader.h"
+
+/** @file pakman-results.cc
+ *
+ * When Pakman is run with `--output-format=binary`, its output is written in
+ * a binary columnar format that can be loaded without parsing, but that
+ * cannot be inspected with a text editor or loaded by tools that expect CSV.
+ *
+ * This program reads a file in the binary columnar format and prints all of
+ * its columns to stdout in CSV format, with one row per result.  Floating
+ * point values are printed with enough precision to be parsed back exactly.
+ */
+
+// Program name
+const char *g_program_name;
+
+// Help functions
+void help();
+
+int main(int argc, char *argv[])
+{
+    // Set program_name
+    g_program_name = basename(argv[0]);
+
+    // Check arguments
+    if ((argc != 2)
+            || (std::string(argv[1]).compare("-h") == 0)
+            || (std::string(argv[1]).compare("--help") == 0))
+    {
+        help();
+
+        if ((argc == 2) &&
+               ((std::string(argv[1]).compare("-h") == 0)
+            || (std::string(argv[1]).compare("--help") == 0)))
+            return 0;
+        else
+            return 2;
+    }
+
+    try
+    {
+        // Open binary result file
+        BinaryResultReader reader(argv[1]);
+        const std::vector<BinaryResultReader::Column>& columns =
+            reader.getColumns();
+
+        // Print header
+        for (std::size_t j = 0; j < columns.size(); j++)
+        {
+            if (j > 0)
+                std::cout << ',';
+            std::cout << columns[j].name;
+        }
+        std::cout << '\n';
+
+        // Print rows block by block
+        std::cout.precision(17);
+        for (std::size_t block = 0; block < reader.getNumBlocks(); block++)
+        {
+            const std::size_t num_rows = reader.getNumRows(block);
+
+            // Get pointers to columns of block
+            std::vector<const double*> float64_columns(columns.size());
+            std::vector<const std::int64_t*> int64_columns(columns.size());
+            for (std::size_t j = 0; j < columns.size(); j++)
+            {
+                if (columns[j].type == BinaryResultWriter::float64_column)
+                    float64_columns[j] = reader.getFloat64Column(block, j);
+                else
+                    int64_columns[j] = reader.getInt64Column(block, j);
+            }
+
+            for (std::size_t i = 0; i < num_rows; i++)
+            {
+                for (std::size_t j = 0; j < columns.size(); j++)
+                {
+                    if (j > 0)
+                        std::cout << ',';
+
+                    if (columns[j].type == BinaryResultWriter::float64_column)
+                        std::cout << float64_columns[j][i];
+                    else
+                        std::cout << int64_columns[j][i];
+                }
+                std::cout << '\n';
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << g_program_name << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/** Print out help message to stdout. */
+void help()
+{
+    std::string help_string;
+    help_string += "Usage: ";
+    help_string += g_program_name;
+    help_string += " <binary result file>";
+    help_string += "\n";
+
+    help_string +=
+R"(
+Read results written by Pakman with --output-format=binary and print them
+to stdout in CSV format.
+
+The columns are the parameters, followed by weight, generation, wall_time
+and error_code.
+)";
+
+    std::cout << help_string;
+}
@@ -32,6 +32,7 @@ const char *g_program_name;
 // Global variables
 std::chrono::milliseconds g_main_timeout(1);
 bool g_force_host_spawn = false;
+int g_worker_procs = 1;
 MPI_Info g_info;
 
 // Help functions